@@ -0,0 +1,57 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtBenchmarkAlloc.h
+ * \brief Allocation counters
+ * \author Hákon Hjaltalín
+ *
+ * This file contains the allocation counters of the benchmarks, reported
+ * when the project is configured with NT_BUILD_ALLOC_TRACKING.
+ */
+
+#include "benchmark/benchmark.h"
+#include "newton/newton.h"
+
+namespace newton
+{
+
+/**
+ * \class NtAllocationScope
+ * \brief Allocations per iteration
+ *
+ * Reports the allocations and bytes allocated while a benchmark runs as
+ * the "allocs" and "alloc_bytes" counters, averaged over iterations, and
+ * the most bytes live at once above those at the start as "peak_bytes".
+ */
+class NtAllocationScope
+{
+public:
+    explicit NtAllocationScope(benchmark::State& state)
+        : m_state{ state }
+    {
+    }
+
+    ~NtAllocationScope()
+    {
+        if (!NtIsAllocTrackingEnabled())
+            return;
+
+        NtAllocStats stats = m_scope.stats();
+        m_state.counters["allocs"] = benchmark::Counter(static_cast<double>(stats.count),
+            benchmark::Counter::kAvgIterations);
+        m_state.counters["alloc_bytes"] = benchmark::Counter(static_cast<double>(stats.bytes),
+            benchmark::Counter::kAvgIterations);
+        m_state.counters["peak_bytes"] = benchmark::Counter(static_cast<double>(stats.peak));
+    }
+
+private:
+    benchmark::State& m_state;
+    NtAllocScope m_scope;
+};
+
+}
@@ -0,0 +1,300 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "NtBenchmarkCorpus.h"
+using namespace newton;
+
+#include <cstdio>
+#include <random>
+
+/**
+ * \class NtCorpusWriter
+ * \brief Corpus text builder
+ */
+class NtCorpusWriter
+{
+public:
+    explicit NtCorpusWriter(uint32_t seed)
+        : m_random{ seed }
+    {
+    }
+
+    int integer(int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(m_random); }
+    double real(double lo, double hi) { return std::uniform_real_distribution<double>(lo, hi)(m_random); }
+    bool chance(double p) { return real(0.0, 1.0) < p; }
+
+    void raw(const char* str) { m_out += str; }
+
+    void key(const char* name)
+    {
+        m_out += '"';
+        m_out += name;
+        m_out += "\":";
+    }
+
+    void number(long long value) { m_out += std::to_string(value); }
+
+    void real(double value, int digits)
+    {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.*f", digits, value);
+        m_out += buf;
+    }
+
+    void word(int minLen, int maxLen)
+    {
+        static const char letters[] = "abcdefghijklmnopqrstuvwxyz";
+        int len = integer(minLen, maxLen);
+
+        for (int i = 0; i < len; ++i)
+            m_out += letters[integer(0, 25)];
+    }
+
+    void text(int words)
+    {
+        static const char* const extras[] = {
+            "\\n", "\\\"", "\\u00e9", "\xc3\xa9t\xc3\xa9", "\xe6\x97\xa5\xe6\x9c\xac",
+            "\xf0\x9f\x98\x80", "\\ud83d\\ude80", "#newton", "@user", "http:\\/\\/t.co\\/x"
+        };
+
+        m_out += '"';
+
+        for (int i = 0; i < words; ++i) {
+            if (i)
+                m_out += ' ';
+
+            if (chance(0.1))
+                m_out += extras[integer(0, 9)];
+            else
+                word(1, 10);
+        }
+
+        m_out += '"';
+    }
+
+    std::string take() { return std::move(m_out); }
+
+private:
+    std::mt19937 m_random;
+    std::string m_out;
+};
+
+static void NtWriteTwitterUser(NtCorpusWriter& w, int id)
+{
+    w.raw("{");
+    w.key("id"); w.number(100000000LL + id * 7919LL); w.raw(",");
+    w.key("id_str"); w.raw("\""); w.number(100000000LL + id * 7919LL); w.raw("\",");
+    w.key("name"); w.text(2); w.raw(",");
+    w.key("screen_name"); w.raw("\""); w.word(4, 12); w.raw("\",");
+    w.key("location"); w.text(w.integer(0, 3)); w.raw(",");
+    w.key("description"); w.text(w.integer(0, 20)); w.raw(",");
+    w.key("url"); w.raw(w.chance(0.5) ? "null" : "\"http:\\/\\/t.co\\/abcdef\""); w.raw(",");
+    w.key("protected"); w.raw("false,");
+    w.key("followers_count"); w.number(w.integer(0, 500000)); w.raw(",");
+    w.key("friends_count"); w.number(w.integer(0, 5000)); w.raw(",");
+    w.key("listed_count"); w.number(w.integer(0, 100)); w.raw(",");
+    w.key("created_at"); w.raw("\"Sun Aug 31 00:29:15 +0000 2014\",");
+    w.key("favourites_count"); w.number(w.integer(0, 20000)); w.raw(",");
+    w.key("utc_offset"); w.raw(w.chance(0.5) ? "null" : "32400"); w.raw(",");
+    w.key("verified"); w.raw(w.chance(0.05) ? "true" : "false"); w.raw(",");
+    w.key("statuses_count"); w.number(w.integer(0, 100000)); w.raw(",");
+    w.key("lang"); w.raw("\"ja\",");
+    w.key("profile_background_color"); w.raw("\"C0DEED\",");
+    w.key("profile_image_url"); w.raw("\"http:\\/\\/pbs.twimg.com\\/profile_images\\/1\\/a_normal.jpeg\",");
+    w.key("default_profile"); w.raw("true,");
+    w.key("following"); w.raw("false,");
+    w.key("notifications"); w.raw("false");
+    w.raw("}");
+}
+
+static std::string NtGenerateTwitter()
+{
+    NtCorpusWriter w(1);
+    w.raw("{");
+    w.key("statuses");
+    w.raw("[");
+
+    for (int i = 0; i < 100; ++i) {
+        if (i)
+            w.raw(",");
+
+        w.raw("{");
+        w.key("metadata"); w.raw("{\"result_type\":\"recent\",\"iso_language_code\":\"ja\"},");
+        w.key("created_at"); w.raw("\"Sun Aug 31 00:29:15 +0000 2014\",");
+        w.key("id"); w.number(505874924095815681LL + i); w.raw(",");
+        w.key("id_str"); w.raw("\""); w.number(505874924095815681LL + i); w.raw("\",");
+        w.key("text"); w.text(w.integer(5, 25)); w.raw(",");
+        w.key("source"); w.raw("\"<a href=\\\"http:\\/\\/twitter.com\\\" rel=\\\"nofollow\\\">Twitter<\\/a>\",");
+        w.key("truncated"); w.raw("false,");
+        w.key("in_reply_to_status_id"); w.raw(w.chance(0.3) ? "505874728897085440" : "null"); w.raw(",");
+        w.key("user"); NtWriteTwitterUser(w, i); w.raw(",");
+        w.key("geo"); w.raw("null,");
+        w.key("coordinates"); w.raw("null,");
+        w.key("retweet_count"); w.number(w.integer(0, 1000)); w.raw(",");
+        w.key("favorite_count"); w.number(w.integer(0, 1000)); w.raw(",");
+        w.key("entities"); w.raw("{");
+        w.key("hashtags"); w.raw("[");
+
+        for (int h = w.integer(0, 3); h > 0; --h) {
+            w.raw("{\"text\":\""); w.word(3, 10); w.raw("\",\"indices\":[");
+            w.number(w.integer(0, 50)); w.raw(","); w.number(w.integer(50, 100)); w.raw("]}");
+
+            if (h > 1)
+                w.raw(",");
+        }
+
+        w.raw("],");
+        w.key("symbols"); w.raw("[],");
+        w.key("urls"); w.raw("[],");
+        w.key("user_mentions"); w.raw("[]");
+        w.raw("},");
+        w.key("favorited"); w.raw("false,");
+        w.key("retweeted"); w.raw("false,");
+        w.key("lang"); w.raw("\"ja\"");
+        w.raw("}");
+    }
+
+    w.raw("],");
+    w.key("search_metadata");
+    w.raw("{\"completed_in\":0.087,\"max_id\":505874924095815681,\"query\":\"%E4%B8%80\",\"count\":100,\"since_id\":0}");
+    w.raw("}");
+    return w.take();
+}
+
+static std::string NtGenerateCanada()
+{
+    NtCorpusWriter w(2);
+    w.raw("{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\",");
+    w.raw("\"properties\":{\"name\":\"Canada\"},\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[");
+
+    for (int ring = 0; ring < 480; ++ring) {
+        if (ring)
+            w.raw(",");
+
+        w.raw("[");
+        double lon = w.real(-141.0, -52.0);
+        double lat = w.real(42.0, 83.0);
+
+        for (int i = 0, n = w.integer(20, 200); i < n; ++i) {
+            if (i)
+                w.raw(",");
+
+            lon += w.real(-0.01, 0.01);
+            lat += w.real(-0.01, 0.01);
+            w.raw("[");
+            w.real(lon, 15);
+            w.raw(",");
+            w.real(lat, 15);
+            w.raw("]");
+        }
+
+        w.raw("]");
+    }
+
+    w.raw("]}}]}");
+    return w.take();
+}
+
+static std::string NtGenerateCitmCatalog()
+{
+    NtCorpusWriter w(3);
+    w.raw("{");
+
+    w.key("areaNames"); w.raw("{");
+
+    for (int i = 0; i < 17; ++i) {
+        if (i)
+            w.raw(",");
+
+        w.raw("\""); w.number(205705993 + i); w.raw("\":"); w.text(2);
+    }
+
+    w.raw("},");
+    w.key("audienceSubCategoryNames"); w.raw("{\"337100890\":\"Abonn\xc3\xa9\"},");
+    w.key("blockNames"); w.raw("{},");
+    w.key("events"); w.raw("{");
+
+    for (int i = 0; i < 184; ++i) {
+        long long id = 138586341 + i * 17;
+
+        if (i)
+            w.raw(",");
+
+        w.raw("\""); w.number(id); w.raw("\":{");
+        w.key("description"); w.raw("null,");
+        w.key("id"); w.number(id); w.raw(",");
+        w.key("logo"); w.raw(w.chance(0.5) ? "\"\\/images\\/UE0AAAAACEKo6QAAAAVDSVRN\"" : "null"); w.raw(",");
+        w.key("name"); w.text(w.integer(1, 5)); w.raw(",");
+        w.key("subTopicIds"); w.raw("[337184269,337184283],");
+        w.key("subjectCode"); w.raw("null,");
+        w.key("subtitle"); w.raw("null,");
+        w.key("topicIds"); w.raw("[324846099,107888604]");
+        w.raw("}");
+    }
+
+    w.raw("},");
+    w.key("performances"); w.raw("[");
+
+    for (int i = 0; i < 243; ++i) {
+        if (i)
+            w.raw(",");
+
+        w.raw("{");
+        w.key("eventId"); w.number(138586341 + w.integer(0, 183) * 17); w.raw(",");
+        w.key("id"); w.number(339887544 + i); w.raw(",");
+        w.key("logo"); w.raw("null,");
+        w.key("name"); w.raw("null,");
+        w.key("prices"); w.raw("[");
+
+        for (int p = 0, n = w.integer(1, 4); p < n; ++p) {
+            if (p)
+                w.raw(",");
+
+            w.raw("{\"amount\":"); w.number(w.integer(10, 200) * 1000);
+            w.raw(",\"audienceSubCategoryId\":337100890,\"seatCategoryId\":"); w.number(338937295 + p); w.raw("}");
+        }
+
+        w.raw("],");
+        w.key("seatCategories"); w.raw("[");
+
+        for (int s = 0, n = w.integer(1, 4); s < n; ++s) {
+            if (s)
+                w.raw(",");
+
+            w.raw("{\"areas\":[{\"areaId\":205705999,\"blockIds\":[]},{\"areaId\":205705998,\"blockIds\":[]}],");
+            w.raw("\"seatCategoryId\":"); w.number(338937295 + s); w.raw("}");
+        }
+
+        w.raw("],");
+        w.key("seatMapImage"); w.raw("null,");
+        w.key("start"); w.number(1372701600000LL + i * 86400000LL); w.raw(",");
+        w.key("venueCode"); w.raw("\"PLEYEL_PLEYEL\"");
+        w.raw("}");
+    }
+
+    w.raw("],");
+    w.key("seatCategoryNames"); w.raw("{\"338937295\":\"1\xc3\xa8re cat\xc3\xa9gorie\",\"338937296\":\"2\xc3\xa8me cat\xc3\xa9gorie\"},");
+    w.key("subTopicNames"); w.raw("{\"337184262\":\"Musique amplifi\xc3\xa9" "e\",\"337184263\":\"Musique baroque\"},");
+    w.key("topicNames"); w.raw("{\"107888604\":\"Activit\xc3\xa9\",\"324846098\":\"Type de public\"},");
+    w.key("venueNames"); w.raw("{\"PLEYEL_PLEYEL\":\"Salle Pleyel\"}");
+    w.raw("}");
+    return w.take();
+}
+
+const std::string& newton::NtBenchmarkCorpus(NtCorpus corpus)
+{
+    static const std::string twitter = NtGenerateTwitter();
+    static const std::string canada = NtGenerateCanada();
+    static const std::string citm = NtGenerateCitmCatalog();
+
+    switch (corpus) {
+    case NtCorpus::CANADA:
+        return canada;
+    case NtCorpus::CITM_CATALOG:
+        return citm;
+    default:
+        return twitter;
+    }
+}
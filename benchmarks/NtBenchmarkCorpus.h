@@ -0,0 +1,46 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtBenchmarkCorpus.h
+ * \brief Benchmark corpus
+ * \author Hákon Hjaltalín
+ *
+ * This file contains generators for the JSON documents the benchmarks run
+ * on. They follow the shape of the usual twitter.json, canada.json and
+ * citm_catalog.json files, so no data has to be downloaded.
+ */
+
+#include <string>
+
+namespace newton
+{
+
+/**
+ * \enum NtCorpus
+ * \brief Benchmark document
+ */
+enum class NtCorpus
+{
+    TWITTER,        ///< Status objects with nested users, short strings and unicode
+    CANADA,         ///< GeoJSON polygons, almost only floating point numbers
+    CITM_CATALOG    ///< Event catalog with wide objects keyed by integer ids
+};
+
+/**
+ * \fn NtBenchmarkCorpus
+ * \brief Get benchmark document
+ *
+ * Get a benchmark document. Documents are generated from a fixed seed on
+ * first use, so every run measures the same text.
+ *
+ * \param corpus Document to get
+ * \return JSON text
+ */
+const std::string& NtBenchmarkCorpus(NtCorpus corpus);
+
+}
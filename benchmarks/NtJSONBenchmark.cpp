@@ -0,0 +1,257 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "benchmark/benchmark.h"
+#include "newton/newton.h"
+#include "NtBenchmarkAlloc.h"
+#include "NtBenchmarkCorpus.h"
+using namespace newton;
+
+static void NtDeleteTree(NtJSONElement* element)
+{
+    if (element->type() == NtJSONElement::Type::OBJECT) {
+        for (auto& member : *static_cast<NtJSONObject*>(element))
+            NtDeleteTree(member.second);
+    } else if (element->type() == NtJSONElement::Type::ARRAY) {
+        for (auto* child : *static_cast<NtJSONArray*>(element))
+            NtDeleteTree(child);
+    }
+
+    delete element;
+}
+
+static void NtSumTree(const NtJSONElement* element, double& sum, size_t& count)
+{
+    ++count;
+
+    switch (element->type()) {
+    case NtJSONElement::Type::OBJECT:
+        for (auto& member : *static_cast<const NtJSONObject*>(element))
+            NtSumTree(member.second, sum, count);
+        break;
+    case NtJSONElement::Type::ARRAY:
+        for (auto* child : *static_cast<const NtJSONArray*>(element))
+            NtSumTree(child, sum, count);
+        break;
+    case NtJSONElement::Type::NUMBER:
+        sum += static_cast<const NtJSONNumber*>(element)->value();
+        break;
+    default:
+        break;
+    }
+}
+
+static void NtSumValue(const NtJSONValue& value, double& sum, size_t& count)
+{
+    ++count;
+
+    if (value.isObject() || value.isArray()) {
+        for (auto it = value.begin(); it != value.end(); ++it)
+            NtSumValue(*it, sum, count);
+    } else if (value.isNumber()) {
+        sum += value.asNumber();
+    }
+}
+
+// Parsing
+
+static void NtBenchParseTree(benchmark::State& state, NtCorpus corpus)
+{
+    const std::string& text = NtBenchmarkCorpus(corpus);
+    NtAllocationScope allocs(state);
+
+    for (auto _ : state) {
+        NtJSONObject* root = NtParseJSON(text);
+        benchmark::DoNotOptimize(root);
+        NtDeleteTree(root);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+
+static void NtBenchParseDocument(benchmark::State& state, NtCorpus corpus)
+{
+    const std::string& text = NtBenchmarkCorpus(corpus);
+    NtJSONDocument doc;
+    doc.parse(text);
+    NtAllocationScope allocs(state);
+
+    for (auto _ : state) {
+        doc.parse(text);
+        benchmark::DoNotOptimize(doc.nodeCount());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+    state.SetLabel(NtJSONDocument::indexerKernel());
+}
+
+static void NtBenchParseReader(benchmark::State& state, NtCorpus corpus)
+{
+    const std::string& text = NtBenchmarkCorpus(corpus);
+    NtJSONHandler handler;
+    NtJSONReader reader(&handler);
+    NtAllocationScope allocs(state);
+
+    for (auto _ : state) {
+        reader.reset();
+        reader.feed(text);
+        reader.finish();
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+
+// Access
+
+static void NtBenchWalkTree(benchmark::State& state, NtCorpus corpus)
+{
+    NtJSONObject* root = NtParseJSON(NtBenchmarkCorpus(corpus));
+    size_t count = 0;
+
+    for (auto _ : state) {
+        double sum = 0.0;
+        count = 0;
+        NtSumTree(root, sum, count);
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+    NtDeleteTree(root);
+}
+
+static void NtBenchWalkDocument(benchmark::State& state, NtCorpus corpus)
+{
+    NtJSONDocument doc;
+    doc.parse(NtBenchmarkCorpus(corpus));
+    size_t count = 0;
+
+    for (auto _ : state) {
+        double sum = 0.0;
+        count = 0;
+        NtSumValue(doc.root(), sum, count);
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+}
+
+static void NtBenchLookupTree(benchmark::State& state)
+{
+    NtJSONObject* root = NtParseJSON(NtBenchmarkCorpus(NtCorpus::TWITTER));
+    NtJSONArray* statuses = static_cast<NtJSONArray*>(root->get("statuses"));
+
+    for (auto _ : state) {
+        size_t len = 0;
+
+        for (auto* status : *statuses) {
+            NtJSONObject* user = static_cast<NtJSONObject*>(static_cast<NtJSONObject*>(status)->get("user"));
+            len += static_cast<NtJSONString*>(user->get("screen_name"))->value().size();
+        }
+
+        benchmark::DoNotOptimize(len);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * statuses->count()));
+    NtDeleteTree(root);
+}
+
+static void NtBenchLookupDocument(benchmark::State& state)
+{
+    NtJSONDocument doc;
+    doc.parse(NtBenchmarkCorpus(NtCorpus::TWITTER));
+    NtJSONValue statuses = doc.root()["statuses"];
+
+    for (auto _ : state) {
+        size_t len = 0;
+
+        for (auto it = statuses.begin(); it != statuses.end(); ++it)
+            len += (*it)["user"]["screen_name"].asString().size();
+
+        benchmark::DoNotOptimize(len);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * statuses.count()));
+}
+
+static void NtBenchLookupCursor(benchmark::State& state)
+{
+    const std::string& text = NtBenchmarkCorpus(NtCorpus::TWITTER);
+    NtAllocationScope allocs(state);
+
+    for (auto _ : state) {
+        NtJSONCursor root(text);
+        benchmark::DoNotOptimize(root["search_metadata"]["count"].asInt64());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+
+// Serialization
+
+static void NtBenchSerializeTree(benchmark::State& state, NtCorpus corpus)
+{
+    NtJSONObject* root = NtParseJSON(NtBenchmarkCorpus(corpus));
+    size_t len = 0;
+    NtAllocationScope allocs(state);
+
+    for (auto _ : state) {
+        std::string out = NtSerializeJSON(root);
+        len = out.size();
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * len));
+    NtDeleteTree(root);
+}
+
+static void NtBenchSerializeDocument(benchmark::State& state, NtCorpus corpus)
+{
+    NtJSONDocument doc;
+    doc.parse(NtBenchmarkCorpus(corpus));
+    NtJSONWriter writer;
+    size_t len = 0;
+    NtAllocationScope allocs(state);
+
+    for (auto _ : state) {
+        writer.reset();
+        writer.write(doc.root());
+        len = writer.buffer().size();
+        benchmark::DoNotOptimize(writer.buffer().data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * len));
+}
+
+static void NtBenchSerializePretty(benchmark::State& state, NtCorpus corpus)
+{
+    NtJSONDocument doc;
+    doc.parse(NtBenchmarkCorpus(corpus));
+    size_t len = 0;
+
+    for (auto _ : state) {
+        std::string out = NtSerializeJSON(doc.root(), true);
+        len = out.size();
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * len));
+}
+
+#define NT_BENCHMARK_CORPUS(fn)                                                \
+    BENCHMARK_CAPTURE(fn, twitter, NtCorpus::TWITTER);                         \
+    BENCHMARK_CAPTURE(fn, canada, NtCorpus::CANADA);                           \
+    BENCHMARK_CAPTURE(fn, citm_catalog, NtCorpus::CITM_CATALOG)
+
+NT_BENCHMARK_CORPUS(NtBenchParseTree);
+NT_BENCHMARK_CORPUS(NtBenchParseDocument);
+NT_BENCHMARK_CORPUS(NtBenchParseReader);
+NT_BENCHMARK_CORPUS(NtBenchWalkTree);
+NT_BENCHMARK_CORPUS(NtBenchWalkDocument);
+BENCHMARK(NtBenchLookupTree);
+BENCHMARK(NtBenchLookupDocument);
+BENCHMARK(NtBenchLookupCursor);
+NT_BENCHMARK_CORPUS(NtBenchSerializeTree);
+NT_BENCHMARK_CORPUS(NtBenchSerializeDocument);
+NT_BENCHMARK_CORPUS(NtBenchSerializePretty);
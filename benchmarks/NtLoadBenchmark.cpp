@@ -0,0 +1,308 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+#include "NtLoadGenerator.h"
+using namespace newton;
+
+#include <cstdio>
+#include <iostream>
+#include <optional>
+#include <thread>
+
+static const char* NtUsage =
+    "Usage: newton-bench [options]\n"
+    "\n"
+    "Start an HTTP server on loopback and measure it under load.\n"
+    "\n"
+    "Options:\n"
+    "  --threads N        Client threads (default 2)\n"
+    "  --connections N    Connections over all threads (default 64)\n"
+    "  --pipeline N       Requests in flight per connection (default 1)\n"
+    "  --duration S       Measured seconds (default 10)\n"
+    "  --warmup S         Seconds before measuring (default 1)\n"
+    "  --mix SPEC         Weighted requests, e.g. hello=8,json=1,echo=1 (default hello)\n"
+    "                     Requests: hello, json, msgpack, echo, offload, metrics\n"
+    "  --offload N        Offload threads, zero for hardware concurrency (default 0)\n"
+    "  --port N           Server port (default 8089)\n"
+    "  --json             Print the results as JSON\n";
+
+static const char* NtBenchDocument =
+    "{\"id\":1126497392364797952,\"user\":{\"id\":3340413,\"screen_name\":\"newton\","
+    "\"name\":\"Newton Framework\",\"followers_count\":1542,\"verified\":false},"
+    "\"text\":\"Measuring the request path end to end\",\"lang\":\"en\","
+    "\"entities\":{\"hashtags\":[\"http\",\"json\"],\"urls\":[]},\"retweet_count\":12,"
+    "\"favorite_count\":48,\"coordinates\":[64.1466,-21.9426]}";
+
+/**
+ * \class NtBenchJSONRoute
+ * \brief Document route
+ *
+ * Route answering with a fixed document in the negotiated format.
+ */
+class NtBenchJSONRoute : public NtRoute
+{
+public:
+    explicit NtBenchJSONRoute(const std::string& path)
+        : NtRoute(path)
+    {
+        m_doc.parse(NtBenchDocument);
+    }
+
+    NtHTTPResponse* handleRequest(NtHTTPRequest* req) override
+    {
+        NtHTTPResponse* resp = new NtHTTPResponse("HTTP/1.1 200 OK");
+        resp->setJSONBody(m_doc.root(), req->responseFormat());
+        return resp;
+    }
+
+private:
+    NtJSONDocument m_doc;
+};
+
+/**
+ * \class NtBenchEchoRoute
+ * \brief Echo route
+ *
+ * Route parsing the request body and encoding it again.
+ */
+class NtBenchEchoRoute : public NtRoute
+{
+public:
+    explicit NtBenchEchoRoute(const std::string& path)
+        : NtRoute(path)
+    {
+    }
+
+    NtHTTPResponse* handleRequest(NtHTTPRequest* req) override
+    {
+        NtJSONDocument doc;
+
+        try {
+            req->parseBody(doc);
+        } catch (const NtSyntaxError&) {
+            NtHTTPResponse* resp = new NtHTTPResponse("HTTP/1.1 400 Bad Request");
+            resp->addHeader(new NtHTTPHeader("Content-Length", "0"));
+            return resp;
+        }
+
+        NtHTTPResponse* resp = new NtHTTPResponse("HTTP/1.1 200 OK");
+        resp->setJSONBody(doc.root(), req->responseFormat());
+        return resp;
+    }
+};
+
+/**
+ * \struct NtBenchSummary
+ * \brief Results printed with --json
+ */
+struct NtBenchSummary
+{
+    int64_t threads{ 0 };
+    int64_t connections{ 0 };
+    int64_t pipeline{ 0 };
+    int64_t requests{ 0 };
+    int64_t errors{ 0 };
+    int64_t reconnects{ 0 };
+    double seconds{ 0.0 };
+    double requestsPerSecond{ 0.0 };
+    double p50Us{ 0.0 };
+    double p99Us{ 0.0 };
+    double p999Us{ 0.0 };
+    double maxUs{ 0.0 };
+    double cpuPerRequestUs{ 0.0 };
+    double serverCpuPerRequestUs{ 0.0 };
+    double clientCpuPerRequestUs{ 0.0 };
+    std::optional<double> allocsPerRequest;
+    std::optional<double> allocBytesPerRequest;
+};
+
+NT_JSON_BIND(NtBenchSummary,
+    NT_JSON_FIELD(threads),
+    NT_JSON_FIELD(connections),
+    NT_JSON_FIELD(pipeline),
+    NT_JSON_FIELD(requests),
+    NT_JSON_FIELD(errors),
+    NT_JSON_FIELD(reconnects),
+    NT_JSON_FIELD(seconds),
+    NT_JSON_NAMED_FIELD("requests_per_second", requestsPerSecond),
+    NT_JSON_NAMED_FIELD("p50_us", p50Us),
+    NT_JSON_NAMED_FIELD("p99_us", p99Us),
+    NT_JSON_NAMED_FIELD("p999_us", p999Us),
+    NT_JSON_NAMED_FIELD("max_us", maxUs),
+    NT_JSON_NAMED_FIELD("cpu_per_request_us", cpuPerRequestUs),
+    NT_JSON_NAMED_FIELD("server_cpu_per_request_us", serverCpuPerRequestUs),
+    NT_JSON_NAMED_FIELD("client_cpu_per_request_us", clientCpuPerRequestUs),
+    NT_JSON_NAMED_FIELD("allocs_per_request", allocsPerRequest),
+    NT_JSON_NAMED_FIELD("alloc_bytes_per_request", allocBytesPerRequest))
+
+static std::string NtBenchRequest(const std::string& name)
+{
+    static const char* body = "{\"name\":\"newton\",\"tags\":[\"http\",\"json\"],\"count\":3}";
+
+    if (name == "hello")
+        return "GET / HTTP/1.1\r\nHost: localhost\r\nUser-Agent: newton-bench\r\nAccept: */*\r\n\r\n";
+
+    if (name == "json")
+        return "GET /json HTTP/1.1\r\nHost: localhost\r\nUser-Agent: newton-bench\r\nAccept: application/json\r\n\r\n";
+
+    if (name == "msgpack") {
+        return "GET /json HTTP/1.1\r\nHost: localhost\r\nUser-Agent: newton-bench\r\n"
+            "Accept: application/msgpack\r\n\r\n";
+    }
+
+    if (name == "echo") {
+        return "POST /echo HTTP/1.1\r\nHost: localhost\r\nUser-Agent: newton-bench\r\nAccept: application/json\r\n"
+            "Content-Type: application/json\r\nContent-Length: " + std::to_string(strlen(body)) + "\r\n\r\n" + body;
+    }
+
+    if (name == "offload")
+        return "GET /offload HTTP/1.1\r\nHost: localhost\r\nUser-Agent: newton-bench\r\nAccept: */*\r\n\r\n";
+
+    if (name == "metrics")
+        return "GET /metrics HTTP/1.1\r\nHost: localhost\r\nUser-Agent: newton-bench\r\nAccept: */*\r\n\r\n";
+
+    throw NtRuntimeException("Unknown request " + name + " in mix.");
+}
+
+/**
+ * Parse a mix like "hello=8,json=1" into weighted requests.
+ */
+static std::vector<NtLoadRequest> NtParseMix(const std::string& spec)
+{
+    std::vector<NtLoadRequest> ret;
+    size_t pos = 0;
+
+    while (pos <= spec.size()) {
+        size_t end = std::min(spec.find(',', pos), spec.size());
+        std::string item = spec.substr(pos, end - pos);
+        size_t eq = item.find('=');
+        std::string name = item.substr(0, eq);
+        unsigned int weight = eq == std::string::npos ? 1 : static_cast<unsigned int>(std::stoul(item.substr(eq + 1)));
+
+        if (!name.empty() && weight)
+            ret.push_back({ name, NtBenchRequest(name), weight });
+
+        pos = end + 1;
+    }
+
+    return ret;
+}
+
+static size_t NtArgument(NtCommandLine& cmd, const std::string& name, size_t defaultValue)
+{
+    std::string value = cmd.argument(name);
+    return value.empty() ? defaultValue : std::stoul(value);
+}
+
+int main(int argc, char** argv)
+{
+    NtCommandLine cmd(argc, argv);
+
+    if (!cmd.argument("--help").empty() || !cmd.argument("-h").empty()) {
+        std::cout << NtUsage;
+        return 0;
+    }
+
+    NtLoadOptions options;
+    bool isJSON = !cmd.argument("--json").empty();
+
+    try {
+        options.threads = NtArgument(cmd, "--threads", options.threads);
+        options.connections = NtArgument(cmd, "--connections", options.connections);
+        options.pipeline = NtArgument(cmd, "--pipeline", options.pipeline);
+        options.port = static_cast<int>(NtArgument(cmd, "--port", options.port));
+        options.warmup = std::chrono::seconds(NtArgument(cmd, "--warmup", 1));
+        options.duration = std::chrono::seconds(NtArgument(cmd, "--duration", 10));
+
+        std::string mix = cmd.argument("--mix");
+        options.mix = NtParseMix(mix.empty() ? "hello" : mix);
+    } catch (const std::exception& e) {
+        std::cerr << "newton-bench: " << e.what() << "\n\n" << NtUsage;
+        return 1;
+    }
+
+    // The reactor thread is detached and cannot be joined, so the server
+    // and its routes are left to outlive main.
+    NtVirtualHost* host = new NtVirtualHost("localhost");
+    NtRoute* offload = new NtRoute("/offload");
+    NtMetricsRoute* metrics = new NtMetricsRoute("/metrics");
+    offload->setOffload();
+    host->addRoute(new NtRoute("/"));
+    host->addRoute(new NtBenchJSONRoute("/json"));
+    host->addRoute(new NtBenchEchoRoute("/echo"));
+    host->addRoute(offload);
+    host->addRoute(metrics);
+
+    NtHTTPServer* server = new NtHTTPServer();
+    server->addHost(host);
+    metrics->addServer(server);
+    server->setOffloadThreads(NtArgument(cmd, "--offload", 0));
+
+    if (!server->initTCPServer(options.host.c_str(), options.port)) {
+        std::cerr << "newton-bench: could not start server on port " << options.port << "." << std::endl;
+        return 1;
+    }
+
+    NtLoadReport report;
+
+    try {
+        NtLoadGenerator generator(options);
+        report = generator.run();
+    } catch (const NtException& e) {
+        std::cerr << "newton-bench: " << e.what() << std::endl;
+        return 1;
+    }
+
+    double requests = static_cast<double>(std::max<uint64_t>(report.requests, 1));
+
+    NtBenchSummary summary;
+    summary.threads = static_cast<int64_t>(std::min(options.threads, options.connections));
+    summary.connections = static_cast<int64_t>(options.connections);
+    summary.pipeline = static_cast<int64_t>(options.pipeline);
+    summary.requests = static_cast<int64_t>(report.requests);
+    summary.errors = static_cast<int64_t>(report.errors);
+    summary.reconnects = static_cast<int64_t>(report.reconnects);
+    summary.seconds = report.seconds;
+    summary.requestsPerSecond = report.requests / report.seconds;
+    summary.p50Us = report.latency.percentile(50.0) / 1e3;
+    summary.p99Us = report.latency.percentile(99.0) / 1e3;
+    summary.p999Us = report.latency.percentile(99.9) / 1e3;
+    summary.maxUs = report.latency.max() / 1e3;
+    summary.cpuPerRequestUs = report.cpuSeconds * 1e6 / requests;
+    summary.clientCpuPerRequestUs = report.clientCpuSeconds * 1e6 / requests;
+    summary.serverCpuPerRequestUs = summary.cpuPerRequestUs - summary.clientCpuPerRequestUs;
+
+    if (NtIsAllocTrackingEnabled()) {
+        summary.allocsPerRequest = report.allocations / requests;
+        summary.allocBytesPerRequest = report.allocBytes / requests;
+    }
+
+    if (isJSON) {
+        std::cout << NtSerializeJSON(summary, true) << std::endl;
+        return 0;
+    }
+
+    printf("newton-bench: %lld threads, %lld connections, pipeline %lld, %.2f s\n",
+        static_cast<long long>(summary.threads), static_cast<long long>(summary.connections),
+        static_cast<long long>(summary.pipeline), summary.seconds);
+    printf("  requests      %llu (%llu errors, %llu reconnects)\n",
+        static_cast<unsigned long long>(report.requests), static_cast<unsigned long long>(report.errors),
+        static_cast<unsigned long long>(report.reconnects));
+    printf("  throughput    %.1f req/s\n", summary.requestsPerSecond);
+    printf("  transfer      %.2f MB/s in, %.2f MB/s out\n", report.bytesIn / report.seconds / 1e6,
+        report.bytesOut / report.seconds / 1e6);
+    printf("  latency       p50 %.1f us, p99 %.1f us, p999 %.1f us, max %.1f us\n",
+        summary.p50Us, summary.p99Us, summary.p999Us, summary.maxUs);
+    printf("  cpu/request   %.2f us (server %.2f us, client %.2f us)\n",
+        summary.cpuPerRequestUs, summary.serverCpuPerRequestUs, summary.clientCpuPerRequestUs);
+
+    if (summary.allocsPerRequest) {
+        printf("  allocs/req    %.2f (%.1f bytes)\n", *summary.allocsPerRequest,
+            *summary.allocBytesPerRequest);
+    }
+
+    return report.errors ? 2 : 0;
+}
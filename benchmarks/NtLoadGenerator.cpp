@@ -0,0 +1,406 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+#include "NtLoadGenerator.h"
+using namespace newton;
+
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <deque>
+#include <random>
+#include <thread>
+
+static double NtThreadCPUSeconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double NtProcessCPUSeconds()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec
+        + usage.ru_stime.tv_usec / 1e6;
+}
+
+/**
+ * Open a blocking connection to the server, or return -1.
+ */
+static int NtConnect(const sockaddr_in& addr)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (fd < 0)
+        return -1;
+
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    int opt = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+    return fd;
+}
+
+size_t NtLatencyHistogram::bucketIndex(uint64_t ns)
+{
+    if (ns < (2u << ms_subBits))
+        return static_cast<size_t>(ns);
+
+    unsigned int shift = 63 - __builtin_clzll(ns) - ms_subBits;
+    return (static_cast<size_t>(shift) << ms_subBits) + static_cast<size_t>(ns >> shift);
+}
+
+uint64_t NtLatencyHistogram::bucketValue(size_t index)
+{
+    if (index < (2u << ms_subBits))
+        return index;
+
+    unsigned int shift = static_cast<unsigned int>(index >> ms_subBits) - 1;
+    uint64_t mantissa = index - (static_cast<size_t>(shift) << ms_subBits);
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void NtLatencyHistogram::record(uint64_t ns)
+{
+    ++m_buckets[bucketIndex(ns)];
+    ++m_count;
+    m_max = std::max(m_max, ns);
+}
+
+void NtLatencyHistogram::merge(const NtLatencyHistogram& other)
+{
+    for (size_t i = 0; i < ms_bucketCount; ++i)
+        m_buckets[i] += other.m_buckets[i];
+
+    m_count += other.m_count;
+    m_max = std::max(m_max, other.m_max);
+}
+
+uint64_t NtLatencyHistogram::percentile(double percent) const
+{
+    if (!m_count)
+        return 0;
+
+    uint64_t target = static_cast<uint64_t>(std::ceil(percent / 100.0 * m_count));
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i < ms_bucketCount; ++i) {
+        seen += m_buckets[i];
+
+        if (seen >= std::max<uint64_t>(target, 1))
+            return std::min(bucketValue(i), m_max);
+    }
+
+    return m_max;
+}
+
+/**
+ * \struct NtLoadConnection
+ * \brief Client connection state
+ */
+struct NtLoadConnection
+{
+    int fd{ -1 };
+    bool isWriting{ false };
+    std::string output;
+    size_t outputPos{ 0 };
+    std::string input;
+    std::deque<std::chrono::steady_clock::time_point> inflight;
+};
+
+NtLoadGenerator::NtLoadGenerator(NtLoadOptions options)
+    : m_options{ std::move(options) }
+{
+    unsigned int total = 0;
+
+    for (auto& req : m_options.mix) {
+        total += req.weight;
+        m_cumulativeWeights.push_back(total);
+    }
+
+    if (!total)
+        throw NtRuntimeException("The request mix is empty.");
+
+    m_options.threads = std::max<size_t>(1, std::min(m_options.threads, m_options.connections));
+    m_options.pipeline = std::max<size_t>(1, m_options.pipeline);
+}
+
+NtLoadReport NtLoadGenerator::run()
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr(m_options.host.c_str());
+    addr.sin_port = htons(m_options.port);
+
+    int probe = NtConnect(addr);
+
+    if (probe < 0) {
+        throw NtRuntimeException("Could not connect to " + m_options.host + ":" + std::to_string(m_options.port)
+            + ": " + strerror(errno) + ".");
+    }
+
+    close(probe);
+
+    size_t threads = m_options.threads;
+    std::vector<NtLoadReport> reports(threads);
+    std::vector<std::thread> workers;
+
+    m_phase = Phase::WARMUP;
+
+    for (size_t i = 0; i < threads; ++i) {
+        size_t count = m_options.connections / threads + (i < m_options.connections % threads ? 1 : 0);
+        workers.emplace_back(&NtLoadGenerator::worker, this, i, count, std::ref(reports[i]));
+    }
+
+    std::this_thread::sleep_for(m_options.warmup);
+
+    double cpuStart = NtProcessCPUSeconds();
+    auto start = std::chrono::steady_clock::now();
+    NtAllocScope allocs;
+    m_phase = Phase::MEASURE;
+
+    std::this_thread::sleep_for(m_options.duration);
+
+    m_phase = Phase::STOP;
+    NtAllocStats allocStats = allocs.stats();
+    auto end = std::chrono::steady_clock::now();
+    double cpuEnd = NtProcessCPUSeconds();
+
+    for (auto& w : workers)
+        w.join();
+
+    NtLoadReport ret;
+    ret.seconds = std::chrono::duration<double>(end - start).count();
+    ret.cpuSeconds = cpuEnd - cpuStart;
+    ret.allocations = allocStats.count;
+    ret.allocBytes = allocStats.bytes;
+
+    for (auto& r : reports) {
+        ret.requests += r.requests;
+        ret.errors += r.errors;
+        ret.reconnects += r.reconnects;
+        ret.bytesIn += r.bytesIn;
+        ret.bytesOut += r.bytesOut;
+        ret.clientCpuSeconds += r.clientCpuSeconds;
+        ret.latency.merge(r.latency);
+    }
+
+    return ret;
+}
+
+void NtLoadGenerator::worker(size_t index, size_t count, NtLoadReport& report)
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr(m_options.host.c_str());
+    addr.sin_port = htons(m_options.port);
+
+    int epFd = epoll_create1(0);
+    std::vector<NtLoadConnection> conns(count);
+    std::mt19937 rng(static_cast<uint32_t>(index + 1));
+    std::uniform_int_distribution<unsigned int> pick(0, m_cumulativeWeights.back() - 1);
+    bool isMeasuring = false;
+    double cpuStart = 0.0;
+
+    auto flush = [&](NtLoadConnection& c) {
+        while (c.outputPos < c.output.size()) {
+            ssize_t sent = send(c.fd, c.output.data() + c.outputPos, c.output.size() - c.outputPos, MSG_NOSIGNAL);
+
+            if (sent > 0) {
+                c.outputPos += sent;
+
+                if (isMeasuring)
+                    report.bytesOut += sent;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            } else if (errno != EINTR) {
+                return false;
+            }
+        }
+
+        bool isPending = c.outputPos < c.output.size();
+
+        if (!isPending) {
+            c.output.clear();
+            c.outputPos = 0;
+        }
+
+        if (isPending != c.isWriting) {
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.ptr = &c;
+
+            if (isPending)
+                ev.events |= EPOLLOUT;
+
+            epoll_ctl(epFd, EPOLL_CTL_MOD, c.fd, &ev);
+            c.isWriting = isPending;
+        }
+
+        return true;
+    };
+
+    // Keep the pipeline full. The clock starts when a request is queued, so
+    // time spent waiting for the socket to drain counts as latency.
+    auto fill = [&](NtLoadConnection& c) {
+        while (c.inflight.size() < m_options.pipeline) {
+            unsigned int ticket = pick(rng);
+            size_t i = std::upper_bound(m_cumulativeWeights.begin(), m_cumulativeWeights.end(), ticket)
+                - m_cumulativeWeights.begin();
+            c.output += m_options.mix[i].text;
+            c.inflight.push_back(std::chrono::steady_clock::now());
+        }
+
+        return flush(c);
+    };
+
+    auto open = [&](NtLoadConnection& c) {
+        c.fd = NtConnect(addr);
+
+        if (c.fd < 0)
+            return false;
+
+        fcntl(c.fd, F_SETFL, fcntl(c.fd, F_GETFL, 0) | O_NONBLOCK);
+
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = &c;
+        epoll_ctl(epFd, EPOLL_CTL_ADD, c.fd, &ev);
+        c.isWriting = false;
+
+        return fill(c);
+    };
+
+    auto drop = [&](NtLoadConnection& c) {
+        if (isMeasuring)
+            report.errors += c.inflight.size();
+
+        epoll_ctl(epFd, EPOLL_CTL_DEL, c.fd, nullptr);
+        close(c.fd);
+        c.fd = -1;
+        c.output.clear();
+        c.outputPos = 0;
+        c.input.clear();
+        c.inflight.clear();
+    };
+
+    auto receive = [&](NtLoadConnection& c) {
+        char buf[65536];
+        ssize_t len = recv(c.fd, buf, sizeof(buf), 0);
+
+        if (len == 0)
+            return false;
+
+        if (len < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+
+        if (isMeasuring)
+            report.bytesIn += len;
+
+        c.input.append(buf, len);
+        size_t pos = 0;
+
+        while (true) {
+            size_t msgLen = 0;
+
+            try {
+                msgLen = NtHTTPMessageLength(c.input.data() + pos, c.input.size() - pos);
+            } catch (const NtSyntaxError&) {
+                return false;
+            }
+
+            if (!msgLen)
+                break;
+
+            if (c.inflight.empty())
+                return false;
+
+            auto now = std::chrono::steady_clock::now();
+            auto sentAt = c.inflight.front();
+            c.inflight.pop_front();
+
+            // Status codes follow "HTTP/1.1 " in the status line.
+            int status = msgLen > 12 ? atoi(c.input.data() + pos + 9) : 0;
+
+            if (isMeasuring) {
+                if (status >= 200 && status < 400) {
+                    ++report.requests;
+                    report.latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(now - sentAt).count());
+                } else {
+                    ++report.errors;
+                }
+            }
+
+            pos += msgLen;
+        }
+
+        c.input.erase(0, pos);
+        return fill(c);
+    };
+
+    for (auto& c : conns)
+        open(c);
+
+    std::vector<epoll_event> events(256);
+
+    while (true) {
+        Phase phase = m_phase.load();
+
+        if (phase == Phase::STOP)
+            break;
+
+        if (phase == Phase::MEASURE && !isMeasuring) {
+            isMeasuring = true;
+            cpuStart = NtThreadCPUSeconds();
+        }
+
+        int eventCnt = epoll_wait(epFd, events.data(), static_cast<int>(events.size()), 10);
+
+        for (int i = 0; i < eventCnt; ++i) {
+            NtLoadConnection& c = *static_cast<NtLoadConnection*>(events[i].data.ptr);
+            bool isOk = !(events[i].events & (EPOLLERR | EPOLLHUP));
+
+            if (isOk && (events[i].events & (EPOLLIN | EPOLLRDHUP)))
+                isOk = receive(c);
+
+            if (isOk && (events[i].events & EPOLLOUT))
+                isOk = flush(c);
+
+            if (!isOk && c.fd >= 0)
+                drop(c);
+        }
+
+        for (auto& c : conns) {
+            if (c.fd >= 0)
+                continue;
+
+            if (open(c)) {
+                if (isMeasuring)
+                    ++report.reconnects;
+            } else if (c.fd >= 0) {
+                drop(c);
+            }
+        }
+    }
+
+    if (isMeasuring)
+        report.clientCpuSeconds = NtThreadCPUSeconds() - cpuStart;
+
+    for (auto& c : conns) {
+        if (c.fd >= 0)
+            close(c.fd);
+    }
+
+    close(epFd);
+}
@@ -0,0 +1,194 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtLoadGenerator.h
+ * \brief HTTP load generator
+ * \author Hákon Hjaltalín
+ *
+ * This file contains the HTTP/1.1 client newton-bench drives a server
+ * with. Every thread runs its own epoll loop over a share of the
+ * connections and keeps each connection's pipeline full.
+ */
+
+#include "newton/base/NtDefs.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace newton
+{
+
+/**
+ * \class NtLatencyHistogram
+ * \brief Latency histogram
+ *
+ * Log-linear histogram of nanosecond latencies. Every power of two is split
+ * into 32 buckets, so percentiles are within about 3% of the recorded
+ * values while the memory used stays fixed however long a run is.
+ */
+class NtLatencyHistogram
+{
+public:
+    /**
+     * \brief Constructor
+     *
+     * Construct an empty histogram.
+     */
+    NtLatencyHistogram()
+        : m_buckets(ms_bucketCount, 0)
+    {
+    }
+
+    /**
+     * \brief Record latency
+     *
+     * \param ns Latency in nanoseconds
+     */
+    void record(uint64_t ns);
+
+    /**
+     * \brief Merge histogram
+     *
+     * Add the samples of another histogram to this one.
+     *
+     * \param other Histogram to merge
+     */
+    void merge(const NtLatencyHistogram& other);
+
+    /**
+     * \brief Get percentile
+     *
+     * \param percent Percentile between 0 and 100
+     * \return Latency in nanoseconds, zero if nothing was recorded
+     */
+    uint64_t percentile(double percent) const;
+
+    /**
+     * \brief Get sample count
+     *
+     * \return Number of recorded latencies
+     */
+    uint64_t count() const { return m_count; }
+
+    /**
+     * \brief Get maximum
+     *
+     * \return Largest recorded latency in nanoseconds
+     */
+    uint64_t max() const { return m_max; }
+
+private:
+    static constexpr unsigned int ms_subBits = 5;
+    static constexpr size_t ms_bucketCount = (64 - ms_subBits + 1) << ms_subBits;
+
+    static size_t bucketIndex(uint64_t ns);
+    static uint64_t bucketValue(size_t index);
+
+private:
+    std::vector<uint64_t> m_buckets;
+    uint64_t m_count{ 0 };
+    uint64_t m_max{ 0 };
+};
+
+/**
+ * \struct NtLoadRequest
+ * \brief Request in a load mix
+ */
+struct NtLoadRequest
+{
+    std::string name;       ///< Name in the mix specification
+    std::string text;       ///< Encoded request
+    unsigned int weight;    ///< Relative frequency
+};
+
+/**
+ * \struct NtLoadOptions
+ * \brief Load generator options
+ */
+struct NtLoadOptions
+{
+    std::string host{ "127.0.0.1" };                ///< Server address
+    int port{ 8089 };                               ///< Server port
+    size_t threads{ 2 };                            ///< Client threads
+    size_t connections{ 64 };                       ///< Connections over all threads
+    size_t pipeline{ 1 };                           ///< Requests in flight per connection
+    std::chrono::milliseconds warmup{ 1000 };       ///< Time before measuring
+    std::chrono::milliseconds duration{ 10000 };    ///< Measured time
+    std::vector<NtLoadRequest> mix;                 ///< Requests to send
+};
+
+/**
+ * \struct NtLoadReport
+ * \brief Load generator results
+ *
+ * Counts cover the measured period only.
+ */
+struct NtLoadReport
+{
+    uint64_t requests{ 0 };         ///< Responses received
+    uint64_t errors{ 0 };           ///< Error responses and requests lost to closed connections
+    uint64_t reconnects{ 0 };       ///< Connections reopened after being closed
+    uint64_t bytesIn{ 0 };          ///< Response bytes received
+    uint64_t bytesOut{ 0 };         ///< Request bytes sent
+    double seconds{ 0.0 };          ///< Measured wall time
+    double cpuSeconds{ 0.0 };       ///< Process CPU time
+    double clientCpuSeconds{ 0.0 }; ///< CPU time of the client threads
+    uint64_t allocations{ 0 };      ///< Heap allocations by all threads, if tracked
+    uint64_t allocBytes{ 0 };       ///< Bytes allocated by all threads, if tracked
+    NtLatencyHistogram latency;     ///< Response latencies
+};
+
+/**
+ * \class NtLoadGenerator
+ * \brief HTTP load generator
+ *
+ * Multi-threaded HTTP/1.1 client sending a weighted mix of requests over
+ * persistent connections for a fixed time.
+ */
+class NtLoadGenerator
+{
+public:
+    /**
+     * \brief Constructor
+     *
+     * \param options Load options
+     */
+    explicit NtLoadGenerator(NtLoadOptions options);
+
+    NT_DISABLE_COPY(NtLoadGenerator)
+
+    /**
+     * \brief Run load
+     *
+     * Connect to the server, warm up, and send requests for the configured
+     * duration.
+     *
+     * \return Results of the measured period
+     */
+    NtLoadReport run();
+
+private:
+    enum class Phase
+    {
+        WARMUP,
+        MEASURE,
+        STOP
+    };
+
+    void worker(size_t index, size_t connections, NtLoadReport& report);
+
+private:
+    NtLoadOptions m_options;
+    std::vector<unsigned int> m_cumulativeWeights;
+    std::atomic<Phase> m_phase{ Phase::WARMUP };
+};
+
+}
@@ -3,4 +3,5 @@ option(NT_BUILD_TESTS           "Build the unit tests."
 option(NT_BUILD_DOCS            "Build the Doxygen documentation."                      OFF)
 option(NT_BUILD_EXAMPLES        "Build the example projects."                           OFF)
 option(NT_BUILD_BENCHMARKS      "Build the performance benchmarks."                     OFF)
+option(NT_BUILD_ALLOC_TRACKING  "Count heap allocations in tests and benchmarks."       OFF)
 option(NT_WARNINGS_AS_ERRORS    "Treat compiler warnings as errors."                    OFF)
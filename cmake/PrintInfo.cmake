@@ -14,6 +14,7 @@ message(STATUS "NT_BUILD_TESTS:             ${NT_BUILD_TESTS}")
 message(STATUS "NT_BUILD_DOCS:              ${NT_BUILD_DOCS}")
 message(STATUS "NT_BUILD_EXAMPLES:          ${NT_BUILD_EXAMPLES}")
 message(STATUS "NT_BUILD_BENCHMARKS:        ${NT_BUILD_BENCHMARKS}")
+message(STATUS "NT_BUILD_ALLOC_TRACKING:    ${NT_BUILD_ALLOC_TRACKING}")
 message(STATUS "NT_WARNINGS_AS_ERRORS:      ${NT_WARNINGS_AS_ERRORS}")
 if (DEFINED BUILD_SHARED_LIBS)
     message(STATUS "BUILD_SHARED_LIBS:          ${BUILD_SHARED_LIBS}")
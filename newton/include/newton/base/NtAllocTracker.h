@@ -0,0 +1,116 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtAllocTracker.h
+ * \brief Heap allocation tracking
+ * \author Hákon Hjaltalín
+ *
+ * This file contains the counters behind allocation tracking. They are
+ * fed by replacements of the global operator new and delete, which are
+ * only linked into the tests and benchmarks when the project is configured
+ * with NT_BUILD_ALLOC_TRACKING. Otherwise tracking is disabled and every
+ * count stays zero.
+ */
+
+#include "newton/base/NtDefs.h"
+
+namespace newton
+{
+
+/**
+ * \struct NtAllocStats
+ * \brief Allocation counts
+ */
+struct NtAllocStats
+{
+    uint64_t count{ 0 };    ///< Calls to operator new
+    uint64_t bytes{ 0 };    ///< Bytes requested from operator new
+    uint64_t peak{ 0 };     ///< Highest number of bytes live at once
+};
+
+/**
+ * \fn NtIsAllocTrackingEnabled
+ * \brief Check if allocations are tracked
+ *
+ * \return True if the operator new replacements are linked in
+ */
+bool NtIsAllocTrackingEnabled();
+
+/**
+ * \fn NtEnableAllocTracking
+ * \brief Enable allocation tracking
+ *
+ * Called by the operator new replacements when they are loaded.
+ */
+void NtEnableAllocTracking();
+
+/**
+ * \fn NtTrackAllocation
+ * \brief Count an allocation
+ *
+ * \param size Size of the allocation in bytes
+ */
+void NtTrackAllocation(size_t size);
+
+/**
+ * \fn NtTrackDeallocation
+ * \brief Count a deallocation
+ *
+ * \param size Size of the allocation in bytes
+ */
+void NtTrackDeallocation(size_t size);
+
+/**
+ * \fn NtAllocationStats
+ * \brief Get allocation counts
+ *
+ * Get the allocations made by all threads since the program started.
+ *
+ * \return Allocation counts
+ */
+NtAllocStats NtAllocationStats();
+
+/**
+ * \class NtAllocScope
+ * \brief Allocations in a scope
+ *
+ * Counts the allocations made by all threads since the scope was started.
+ * Starting a scope resets the shared high-water mark, so only the peak of
+ * the most recently started scope is meaningful.
+ */
+class NT_EXPORT NtAllocScope
+{
+public:
+    /**
+     * \brief Constructor
+     *
+     * Start counting.
+     */
+    NtAllocScope() { reset(); }
+
+    /**
+     * \brief Reset scope
+     *
+     * Start counting again from the current allocations.
+     */
+    void reset();
+
+    /**
+     * \brief Get allocation counts
+     *
+     * \return Allocations since the scope was started, with the peak given
+     *         in bytes above those live at the start
+     */
+    NtAllocStats stats() const;
+
+private:
+    NtAllocStats m_start;
+    uint64_t m_live{ 0 };
+};
+
+}
@@ -0,0 +1,179 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtArena.h
+ * \brief Bump allocator
+ * \author Hákon Hjaltalín
+ *
+ * This file contains a bump allocator for data that is freed all at once.
+ */
+
+#include "newton/base/NtDefs.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace newton
+{
+
+/**
+ * \class NtArena
+ * \brief Bump allocator
+ *
+ * Memory arena handing out memory from large blocks by bumping a pointer.
+ * Individual allocations are never freed; all memory is released at once
+ * when the arena is cleared or destroyed.
+ */
+class NT_EXPORT NtArena
+{
+public:
+    /**
+     * \brief Constructor
+     *
+     * Default constructor.
+     *
+     * \param blockSize Size of each memory block
+     */
+    explicit NtArena(size_t blockSize = 64 * 1024)
+        : m_blockSize{ blockSize }
+    {
+    }
+
+    NtArena(NtArena&&) = default;
+    NtArena& operator=(NtArena&&) = default;
+
+    NT_DISABLE_COPY(NtArena)
+
+    /**
+     * \brief Allocate memory
+     *
+     * Allocate memory from the arena.
+     *
+     * \param size Number of bytes
+     * \param align Alignment, must be a power of two
+     * \return Allocated memory
+     */
+    void* allocate(size_t size, size_t align = alignof(max_align_t))
+    {
+        size_t offset = (m_used + align - 1) & ~(align - 1);
+
+        if (m_blocks.empty() || offset + size > m_capacity) {
+            size_t capacity = size + align > m_blockSize ? size + align : m_blockSize;
+            m_blocks.push_back(std::unique_ptr<char[]>(new char[capacity]));
+            m_capacity = capacity;
+            m_used = 0;
+            m_reserved += capacity;
+
+            uintptr_t base = reinterpret_cast<uintptr_t>(m_blocks.back().get());
+            offset = ((base + align - 1) & ~(align - 1)) - base;
+        }
+
+        m_used = offset + size;
+        return m_blocks.back().get() + offset;
+    }
+
+    /**
+     * \brief Copy string
+     *
+     * Copy a string into the arena.
+     *
+     * \param data String data
+     * \param len String length
+     * \return Pointer to the copy
+     */
+    const char* copy(const char* data, size_t len)
+    {
+        char* ret = static_cast<char*>(allocate(len, 1));
+
+        if (len)
+            memcpy(ret, data, len);
+
+        return ret;
+    }
+
+    /**
+     * \brief Shrink allocation
+     *
+     * Give back the unused tail of the most recent allocation, for callers
+     * that allocate an upper bound before knowing the final size.
+     *
+     * \param ptr Most recent allocation
+     * \param size Bytes to keep
+     */
+    void shrink(void* ptr, size_t size)
+    {
+        m_used = static_cast<size_t>(static_cast<char*>(ptr) - m_blocks.back().get()) + size;
+    }
+
+    /**
+     * \brief Set block size
+     *
+     * Set the size of blocks allocated from now on.
+     *
+     * \param blockSize Size of each memory block
+     */
+    void setBlockSize(size_t blockSize) { m_blockSize = blockSize; }
+
+    /**
+     * \brief Get block size
+     *
+     * \return Size of each memory block
+     */
+    size_t blockSize() const { return m_blockSize; }
+
+    /**
+     * \brief Clear arena
+     *
+     * Release all memory.
+     */
+    void clear()
+    {
+        m_blocks.clear();
+        m_capacity = 0;
+        m_used = 0;
+        m_reserved = 0;
+    }
+
+    /**
+     * \brief Get reserved size
+     *
+     * Get the total number of bytes held by the arena.
+     *
+     * \return Reserved bytes
+     */
+    size_t reserved() const { return m_reserved; }
+
+private:
+    /**
+     * Memory blocks
+     */
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+
+    /**
+     * Default block size
+     */
+    size_t m_blockSize;
+
+    /**
+     * Capacity of current block
+     */
+    size_t m_capacity{ 0 };
+
+    /**
+     * Bytes used in current block
+     */
+    size_t m_used{ 0 };
+
+    /**
+     * Total bytes reserved
+     */
+    size_t m_reserved{ 0 };
+};
+
+}
@@ -0,0 +1,136 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtMPSCQueue.h
+ * \brief Lock-free MPSC queue
+ * \author Hákon Hjaltalín
+ *
+ * This file contains a lock-free multi-producer single-consumer queue.
+ */
+
+#include "newton/base/NtDefs.h"
+
+#include <atomic>
+#include <utility>
+
+namespace newton
+{
+
+/**
+ * \class NtMPSCQueue
+ * \brief Multi-producer single-consumer queue
+ *
+ * Unbounded intrusive linked queue after Dmitry Vyukov's design. Any number
+ * of threads may push concurrently without locks; only one thread may pop.
+ * A push that is still in progress may be invisible to the consumer for a
+ * short moment, so producers must signal the consumer after pushing.
+ *
+ * \tparam T Type of value, must be default constructible
+ */
+template <typename T>
+class NtMPSCQueue
+{
+public:
+    /**
+     * \brief Constructor
+     *
+     * Default constructor.
+     */
+    NtMPSCQueue()
+        : m_head{ &m_stub }, m_tail{ &m_stub }
+    {
+    }
+
+    NT_DISABLE_COPY(NtMPSCQueue)
+    NT_DISABLE_MOVE(NtMPSCQueue)
+
+    /**
+     * \brief Destructor
+     *
+     * Discards all remaining values.
+     */
+    ~NtMPSCQueue()
+    {
+        T value;
+        while (pop(value))
+            ;
+
+        if (m_tail != &m_stub)
+            delete m_tail;
+    }
+
+    /**
+     * \brief Push value
+     *
+     * Push a value to the queue. May be called from any thread.
+     *
+     * \param value Value to push
+     */
+    void push(T value)
+    {
+        Node* node = new Node();
+        node->value = std::move(value);
+
+        Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * \brief Pop value
+     *
+     * Pop the oldest value from the queue. Must only be called from the
+     * consumer thread.
+     *
+     * \param value Output value
+     * \return True if a value was popped
+     */
+    bool pop(T& value)
+    {
+        Node* tail = m_tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+
+        if (!next)
+            return false;
+
+        value = std::move(next->value);
+        m_tail = next;
+
+        if (tail != &m_stub)
+            delete tail;
+
+        return true;
+    }
+
+private:
+    /**
+     * \struct Node
+     * \brief Queue node
+     */
+    struct Node
+    {
+        std::atomic<Node*> next{ nullptr };
+        T value{};
+    };
+
+    /**
+     * Initial dummy node
+     */
+    Node m_stub;
+
+    /**
+     * Producer end
+     */
+    alignas(64) std::atomic<Node*> m_head;
+
+    /**
+     * Consumer end
+     */
+    alignas(64) Node* m_tail;
+};
+
+}
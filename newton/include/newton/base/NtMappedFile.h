@@ -0,0 +1,131 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtMappedFile.h
+ * \brief Read-only memory-mapped file
+ * \author Hákon Hjaltalín
+ *
+ * This file contains a class mapping a whole file into memory.
+ */
+
+#include "newton/base/NtDefs.h"
+
+#include <string_view>
+
+namespace newton
+{
+
+/**
+ * \class NtMappedFile
+ * \brief Read-only memory-mapped file
+ *
+ * Maps a whole file read-only into memory and unmaps it on destruction.
+ * Pages are read by the kernel on first access and shared with the page
+ * cache, so nothing is copied. The mapping is advised for sequential
+ * access.
+ */
+class NT_EXPORT NtMappedFile
+{
+public:
+    /**
+     * \brief Constructor
+     *
+     * Construct an empty file.
+     */
+    NtMappedFile() { }
+
+    /**
+     * \brief Constructor
+     *
+     * Map a file. Throws NtRuntimeException if it cannot be mapped.
+     *
+     * \param path File path
+     */
+    explicit NtMappedFile(const char* path) { open(path); }
+
+    NtMappedFile(NtMappedFile&& other) noexcept;
+    NtMappedFile& operator=(NtMappedFile&& other) noexcept;
+
+    NT_DISABLE_COPY(NtMappedFile)
+
+    /**
+     * \brief Destructor
+     */
+    ~NtMappedFile() { close(); }
+
+    /**
+     * \brief Open file
+     *
+     * Map a file, closing the current one. Throws NtRuntimeException if it
+     * cannot be mapped.
+     *
+     * \param path File path
+     */
+    void open(const char* path);
+
+    /**
+     * \brief Close file
+     *
+     * Unmap the file.
+     */
+    void close();
+
+    /**
+     * \brief Is open
+     *
+     * Check whether a file is mapped.
+     *
+     * \return True if open
+     */
+    bool isOpen() const { return m_isOpen; }
+
+    /**
+     * \brief Get data
+     *
+     * Get the file contents, nullptr for an empty file.
+     *
+     * \return File data
+     */
+    const char* data() const { return m_data; }
+
+    /**
+     * \brief Get size
+     *
+     * Get the file size.
+     *
+     * \return Size in bytes
+     */
+    size_t size() const { return m_size; }
+
+    /**
+     * \brief Get view
+     *
+     * Get the file contents as a string view.
+     *
+     * \return File contents
+     */
+    std::string_view view() const { return std::string_view(m_data, m_size); }
+
+private:
+    /**
+     * Mapped data
+     */
+    const char* m_data{ nullptr };
+
+    /**
+     * File size
+     */
+    size_t m_size{ 0 };
+
+    /**
+     * Is a file mapped
+     */
+    bool m_isOpen{ false };
+};
+
+}
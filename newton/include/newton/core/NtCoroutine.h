@@ -0,0 +1,185 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtCoroutine.h
+ * \brief Coroutine request handlers
+ * \author Hákon Hjaltalín
+ *
+ * This file contains an adapter for writing route handlers as C++20
+ * coroutines. It is only available when compiling with coroutine support;
+ * the library itself is built as C++17 and uses the callback interface in
+ * NtRoute.h.
+ */
+
+#include "newton/core/NtRoute.h"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <utility>
+
+#define NT_HAS_COROUTINES
+
+namespace newton
+{
+
+/**
+ * \class NtHTTPTask
+ * \brief Coroutine request task
+ *
+ * Return type for coroutine request handlers. The handler body starts when
+ * the task is started and reports the value passed to co_return through
+ * the completion callback.
+ */
+class NtHTTPTask
+{
+public:
+    /**
+     * \struct promise_type
+     * \brief Coroutine promise
+     */
+    struct promise_type
+    {
+        NtHTTPResponse* response{ nullptr };
+        NtResponseCallback done;
+
+        NtHTTPTask get_return_object()
+        {
+            return NtHTTPTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        auto final_suspend() noexcept
+        {
+            struct NtFinalAwaiter
+            {
+                bool await_ready() noexcept { return false; }
+
+                void await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                {
+                    NtResponseCallback done = std::move(handle.promise().done);
+                    NtHTTPResponse* response = handle.promise().response;
+                    handle.destroy();
+
+                    if (done)
+                        done(response);
+                }
+
+                void await_resume() noexcept { }
+            };
+
+            return NtFinalAwaiter{};
+        }
+
+        void return_value(NtHTTPResponse* resp) { response = resp; }
+
+        void unhandled_exception() { response = nullptr; }
+    };
+
+    /**
+     * \brief Constructor
+     *
+     * Constructor from coroutine handle.
+     *
+     * \param handle Coroutine handle
+     */
+    explicit NtHTTPTask(std::coroutine_handle<promise_type> handle)
+        : m_handle{ handle }
+    {
+    }
+
+    NtHTTPTask(NtHTTPTask&& other) noexcept
+        : m_handle{ std::exchange(other.m_handle, {}) }
+    {
+    }
+
+    NT_DISABLE_COPY(NtHTTPTask)
+
+    /**
+     * \brief Destructor
+     *
+     * Destroys the coroutine if it was never started.
+     */
+    ~NtHTTPTask()
+    {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    /**
+     * \brief Start task
+     *
+     * Run the coroutine until its first suspension point. The completion
+     * callback is invoked once the coroutine executes co_return.
+     *
+     * \param done Completion callback
+     */
+    void start(NtResponseCallback done)
+    {
+        std::coroutine_handle<promise_type> handle = std::exchange(m_handle, {});
+        handle.promise().done = std::move(done);
+        handle.resume();
+    }
+
+private:
+    /**
+     * Coroutine handle
+     */
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+/**
+ * \class NtCoroutineRoute
+ * \brief Coroutine route
+ *
+ * Base class for routes whose handler is written as a coroutine that
+ * co_returns its response.
+ */
+class NtCoroutineRoute : public NtRoute
+{
+public:
+    /**
+     * \brief Constructor
+     *
+     * Default constructor.
+     *
+     * \param path Route path
+     */
+    NtCoroutineRoute(const std::string& path = "/")
+        : NtRoute(path)
+    {
+    }
+
+    /**
+     * \brief Handle HTTP request as coroutine
+     *
+     * Coroutine handling an HTTP request.
+     *
+     * \param req HTTP request
+     * \return Coroutine task
+     */
+    virtual NtHTTPTask handleRequestCoroutine(NtHTTPRequest* req) = 0;
+
+    /**
+     * \brief Handle HTTP request asynchronously
+     *
+     * Start the coroutine handler and complete when it returns.
+     *
+     * \param req HTTP request
+     * \param done Completion callback
+     */
+    void handleRequestAsync(NtHTTPRequest* req, NtResponseCallback done) override
+    {
+        handleRequestCoroutine(req).start(std::move(done));
+    }
+};
+
+}
+
+#endif
@@ -15,6 +15,10 @@
 
 #include "newton/core/NtServer.h"
 #include "newton/core/NtVirtualHost.h"
+#include "newton/core/NtThreadPool.h"
+
+#include <map>
+#include <memory>
 
 namespace newton
 {
@@ -35,7 +39,9 @@ public:
      */
     NtHTTPServer()
         : m_defaultHost{ "localhost" }
-    { }
+    {
+        setRetryAfter(1);
+    }
 
     /**
      * \brief Handle request
@@ -56,7 +62,91 @@ public:
      */
     void addHost(NtVirtualHost* host) { m_hosts.insert({ host->host(), host }); }
 
+    /**
+     * \brief Set offload thread count
+     *
+     * Set the number of worker threads used for offloaded routes. The pool
+     * is started on the first offloaded request.
+     *
+     * \param count Number of threads, zero for hardware concurrency
+     */
+    void setOffloadThreads(size_t count) { m_offloadThreads = count; }
+
+    /**
+     * \brief Set maximum request size
+     *
+     * Set the number of unanswered bytes a client may send before it is
+     * disconnected, which bounds pipelined and partially received requests.
+     *
+     * \param size Maximum size in bytes
+     */
+    void setMaxRequestSize(size_t size) { m_maxRequestSize = size; }
+
+    /**
+     * \brief Set retry delay
+     *
+     * Set the Retry-After value sent with 503 responses while shedding load.
+     * The response is encoded once here so shedding costs no handler work.
+     * It closes the connection, since the rest of the client's input is
+     * never framed.
+     *
+     * \param seconds Retry delay in seconds
+     */
+    void setRetryAfter(unsigned int seconds)
+    {
+        m_overloadResponse = "HTTP/1.1 503 Service Unavailable\r\nRetry-After: ";
+        m_overloadResponse += std::to_string(seconds);
+        m_overloadResponse += "\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+    }
+
 protected:
+    /**
+     * \brief Find virtual host
+     *
+     * Find the virtual host addressed by a request's Host header.
+     *
+     * \param req HTTP request
+     * \return Virtual host or nullptr
+     */
+    NtVirtualHost* findHost(NtHTTPRequest* req);
+
+    /**
+     * \brief Process requests
+     *
+     * Dispatch the complete requests buffered for a client in order, until
+     * one of them is answered asynchronously.
+     *
+     * \param ctxPtr Server context
+     * \return True on success
+     */
+    bool processRequests(NtContext* ctxPtr);
+
+    /**
+     * \brief Dispatch request
+     *
+     * Route a parsed request to its virtual host, or to the offload pool.
+     *
+     * \param ctxPtr Server context
+     * \param req HTTP request
+     * \return True on success
+     */
+    bool dispatchRequest(NtContext* ctxPtr, NtHTTPRequest* req);
+
+    /**
+     * \brief Complete request
+     *
+     * Send the response for a request on the reactor thread and resume
+     * reading from the client. Stale completions for connections that
+     * have since been closed are discarded.
+     *
+     * \param ctxPtr Server context
+     * \param generation Context generation when the request was received
+     * \param req HTTP request
+     * \param resp HTTP response
+     * \return True on success
+     */
+    bool completeRequest(NtContext* ctxPtr, uint64_t generation, NtHTTPRequest* req, NtHTTPResponse* resp);
+
     /**
      * Default host value
      */
@@ -66,6 +156,26 @@ protected:
      * Map of virtual hosts
      */
     std::map<std::string, NtVirtualHost*> m_hosts;
+
+    /**
+     * Pre-encoded overload response
+     */
+    std::string m_overloadResponse;
+
+    /**
+     * Maximum buffered request size
+     */
+    size_t m_maxRequestSize{ 1024 * 1024 };
+
+    /**
+     * Offload thread count
+     */
+    size_t m_offloadThreads{ 0 };
+
+    /**
+     * Offload worker pool
+     */
+    std::unique_ptr<NtThreadPool> m_offloadPool;
 };
 
 }
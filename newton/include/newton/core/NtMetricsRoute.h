@@ -0,0 +1,75 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtMetricsRoute.h
+ * \brief Metrics route definitions
+ * \author Hákon Hjaltalín
+ *
+ * This file contains definitions for a route exposing server metrics.
+ */
+
+#include "newton/core/NtRoute.h"
+#include "newton/core/NtServer.h"
+
+#include <vector>
+
+namespace newton
+{
+
+/**
+ * \class NtMetricsRoute
+ * \brief Metrics route
+ *
+ * Route answering with the metrics of one or more servers in Prometheus
+ * text format. The counters of all servers are summed on every scrape, so
+ * an application running several reactors is reported as one.
+ */
+class NT_EXPORT NtMetricsRoute : public NtRoute
+{
+public:
+    /**
+     * \brief Constructor
+     *
+     * \param path Route path
+     */
+    NtMetricsRoute(const std::string& path = "/metrics")
+        : NtRoute(path)
+    {
+    }
+
+    /**
+     * \brief Add server
+     *
+     * Add a server to report on. Servers must outlive the route.
+     *
+     * \param server Server to add
+     */
+    void addServer(const NtServer* server) { m_servers.push_back(server); }
+
+    /**
+     * \brief Get metrics
+     *
+     * Read the metrics of all added servers.
+     *
+     * \return Merged metrics snapshot
+     */
+    NtServerMetrics metrics() const;
+
+    /**
+     * \brief Handle HTTP request
+     *
+     * \param req HTTP request
+     * \return Metrics response
+     */
+    virtual NtHTTPResponse* handleRequest(NtHTTPRequest* req) override;
+
+private:
+    std::vector<const NtServer*> m_servers;
+};
+
+}
@@ -16,9 +16,19 @@
 #include "newton/http/NtHTTPRequest.h"
 #include "newton/http/NtHTTPResponse.h"
 
+#include <functional>
+
 namespace newton
 {
 
+/**
+ * \brief Response callback
+ *
+ * Completion callback for asynchronous request handlers. It may be invoked
+ * from any thread, exactly once, with the response or nullptr on failure.
+ */
+using NtResponseCallback = std::function<void(NtHTTPResponse*)>;
+
 /**
  * \class NtRoute
  * \brief Server route class
@@ -36,7 +46,7 @@ public:
      * \param path Route path
      */
     NtRoute(const std::string& path = "/")
-        : m_path{ path }
+        : m_path{ path }, m_isOffload{ false }
     {
     }
 
@@ -50,6 +60,11 @@ public:
      */
     virtual bool matchPath(const std::string& path = "/");
 
+    /**
+     * \brief Virtual destructor
+     */
+    virtual ~NtRoute() { }
+
     /**
      * \brief Handle HTTP request
      *
@@ -58,13 +73,54 @@ public:
      * \param req HTTP request
      * \return HTTP response object
      */
-    NtHTTPResponse* handleRequest(NtHTTPRequest* req);
+    virtual NtHTTPResponse* handleRequest(NtHTTPRequest* req);
+
+    /**
+     * \brief Handle HTTP request asynchronously
+     *
+     * Handle an HTTP request and report the response through a callback.
+     * The connection stays suspended until the callback is invoked, so
+     * handlers that wait on other services do not stall the reactor. The
+     * default implementation completes synchronously with handleRequest().
+     *
+     * \param req HTTP request
+     * \param done Completion callback
+     */
+    virtual void handleRequestAsync(NtHTTPRequest* req, NtResponseCallback done)
+    {
+        done(handleRequest(req));
+    }
+
+    /**
+     * \brief Set offload
+     *
+     * Mark this route as offloaded. Requests for offloaded routes are
+     * handled on the server's worker pool instead of the reactor thread,
+     * which suits blocking and CPU-heavy handlers.
+     *
+     * \param offload True to offload
+     */
+    void setOffload(bool offload = true) { m_isOffload = offload; }
+
+    /**
+     * \brief Is offloaded
+     *
+     * Check whether this route runs on the worker pool.
+     *
+     * \return True if offloaded
+     */
+    bool isOffload() const { return m_isOffload; }
 
 protected:
     /**
      * Route path
      */
     std::string m_path;
+
+    /**
+     * Is offloaded
+     */
+    bool m_isOffload;
 };
 
 }
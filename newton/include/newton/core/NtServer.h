@@ -14,12 +14,18 @@
  */
 
 #include "newton/base/NtDefs.h"
+#include "newton/base/NtMPSCQueue.h"
+#include "newton/core/NtServerMetrics.h"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <string>
 #include <mutex>
 #include <thread>
 #include <queue>
+#include <functional>
+#include <vector>
 #include <iostream>
 
 namespace newton
@@ -58,6 +64,18 @@ struct NtPendingSent
     sockaddr_in udpRemoteAddr;
 };
 
+/**
+ * \struct NtPostedTask
+ * \brief Posted reactor task
+ *
+ * Task posted to the reactor along with the time it was posted.
+ */
+struct NtPostedTask
+{
+    std::function<void()> task;
+    std::chrono::steady_clock::time_point postedAt;
+};
+
 #ifdef NT_WINDOWS
 struct NtContext
 {
@@ -76,11 +94,16 @@ struct NtContext
     socket_t socket;
     int sockIdCopy{ -1 };
     std::mutex ctxLock;
-    char* recvBuffer;
+    char* recvBuffer{ nullptr };
     size_t dataLen{ 0 };
     size_t readLen{ 0 };
+    std::string pendingInput;
     bool isConnected{ false };
     bool isSentPending{ false };
+    bool isSuspended{ false };
+    bool isReadPaused{ false };
+    size_t pendingSendBytes{ 0 };
+    uint64_t generation{ 0 };
     std::deque<NtPendingSent> pendingSendDeque;
     sockaddr_in udpRemoteAddr;
 };
@@ -128,19 +151,191 @@ public:
      */
     bool setSocketNonBlocking(int fd);
 
+    /**
+     * \brief Post task to reactor
+     *
+     * Queue a task for execution on the reactor thread that owns the
+     * client connections. This function may be called from any thread.
+     * If the reactor cannot be woken this returns false, but a task queued
+     * while the server runs stays queued and runs on the reactor's next
+     * idle timeout at the latest.
+     *
+     * \param task Task to run
+     * \return True on success
+     */
+    bool post(std::function<void()> task);
+
+    /**
+     * \brief Check for reactor thread
+     *
+     * Check whether the calling thread is the server's reactor thread.
+     *
+     * \return True if called from the reactor thread
+     */
+    bool isReactorThread() const { return std::this_thread::get_id() == m_reactorThreadId; }
+
+    /**
+     * \brief Suspend client
+     *
+     * Stop reading from a client while a request is being handled
+     * asynchronously. Must be called on the reactor thread.
+     *
+     * \param ctxPtr Context pointer
+     * \return True on success
+     */
+    bool suspendClient(NtContext* ctxPtr);
+
+    /**
+     * \brief Resume client
+     *
+     * Resume reading from a previously suspended client. Must be called
+     * on the reactor thread.
+     *
+     * \param ctxPtr Context pointer
+     * \return True on success
+     */
+    bool resumeClient(NtContext* ctxPtr);
+
+    /**
+     * \brief Set send water marks
+     *
+     * Set the per-connection send queue limits. Once more than the high
+     * water mark is queued for a client, the server stops reading requests
+     * from it until the queue drains below the low water mark.
+     *
+     * \param highWaterMark High water mark in bytes
+     * \param lowWaterMark Low water mark in bytes
+     */
+    void setSendWaterMarks(size_t highWaterMark, size_t lowWaterMark)
+    {
+        m_sendHighWaterMark = highWaterMark;
+        m_sendLowWaterMark = lowWaterMark;
+    }
+
+    /**
+     * \brief Set global send water marks
+     *
+     * Set the limits for data queued across all connections. Above the high
+     * water mark every client that queues data or becomes readable is paused,
+     * with its request left unread, until the total drains below the low
+     * water mark.
+     *
+     * \param highWaterMark High water mark in bytes
+     * \param lowWaterMark Low water mark in bytes
+     */
+    void setGlobalSendWaterMarks(size_t highWaterMark, size_t lowWaterMark)
+    {
+        m_globalSendHighWaterMark = highWaterMark;
+        m_globalSendLowWaterMark = lowWaterMark;
+    }
+
+    /**
+     * \brief Is send blocked
+     *
+     * Check whether a client is under send backpressure. Streaming
+     * producers should stop calling sendData() while this returns true
+     * and continue from onWritable().
+     *
+     * \param ctxPtr Context pointer
+     * \return True if the client is paused
+     */
+    bool isSendBlocked(const NtContext* ctxPtr) const { return ctxPtr->isReadPaused; }
+
+    /**
+     * \brief Get queued send bytes
+     *
+     * Get the number of bytes queued for sending across all clients.
+     *
+     * \return Queued bytes
+     */
+    size_t pendingSendBytes() const { return m_globalPendingSendBytes; }
+
+    /**
+     * \brief Set admission thresholds
+     *
+     * Set the load levels at which the server sheds requests and rejects
+     * new connections. The load level is the larger of the reactor loop
+     * lag and the time tasks spend queued, both smoothed. A threshold of
+     * zero disables the respective check.
+     *
+     * \param shedThreshold Level above which requests are shed
+     * \param rejectThreshold Level above which connections are rejected
+     */
+    void setAdmissionThresholds(std::chrono::microseconds shedThreshold,
+            std::chrono::microseconds rejectThreshold)
+    {
+        m_shedThresholdUs = shedThreshold.count();
+        m_rejectThresholdUs = rejectThreshold.count();
+    }
+
+    /**
+     * \brief Get loop lag
+     *
+     * Get the smoothed time the reactor spends on one batch of events,
+     * which is how long a newly ready event waits to be seen.
+     *
+     * \return Loop lag
+     */
+    std::chrono::microseconds loopLag() const { return std::chrono::microseconds(m_loopLagUs.load()); }
+
+    /**
+     * \brief Get queue delay
+     *
+     * Get the smoothed time tasks spend queued before they run.
+     *
+     * \return Queue delay
+     */
+    std::chrono::microseconds queueDelay() const { return std::chrono::microseconds(m_queueDelayUs.load()); }
+
+    /**
+     * \brief Is shedding load
+     *
+     * Check whether requests should be answered without handler work.
+     *
+     * \return True if shedding
+     */
+    bool isShedding() const { return m_shedThresholdUs && loadLevel() > m_shedThresholdUs; }
+
+    /**
+     * \brief Is rejecting clients
+     *
+     * Check whether new connections are closed as soon as accepted.
+     *
+     * \return True if rejecting
+     */
+    bool isRejecting() const { return m_rejectThresholdUs && loadLevel() > m_rejectThresholdUs; }
+
+    /**
+     * \brief Get metrics
+     *
+     * Read the reactor's counters and the current gauges without locking.
+     * May be called from any thread.
+     *
+     * \return Metrics snapshot
+     */
+    NtServerMetrics metrics() const;
+
     /**
      * \brief On connect handler
      *
      * This function handles a new client connection.
      */
-    virtual void onConnect(NtContext* ctx) { }
+    virtual void onConnect(NtContext*) { }
 
     /**
      * \brief On disconnect handler
      *
      * This function handles a client disconnecting.
      */
-    virtual void onDisconnect(NtContext* ctx) { }
+    virtual void onDisconnect(NtContext*) { }
+
+    /**
+     * \brief On writable handler
+     *
+     * This function is called when a client paused by send backpressure
+     * has drained below the low water mark.
+     */
+    virtual void onWritable(NtContext*) { }
 
     /**
      * \brief On request handler
@@ -159,7 +354,8 @@ public:
      *
      * \param bindIP Host IP address
      * \param bindPort Host port number
-     * \param maxClients Maximum number of clients
+     * \param maxClients Maximum number of clients, the listener stops
+     *        accepting while this many are connected
      * \return True on success
      */
     bool initTCPServer(const char* bindIP, int bindPort, size_t maxClients = 100000);
@@ -170,6 +366,7 @@ protected:
 #else
     bool recvData(NtContext* ctxPtr);
     bool sendPendingData(NtContext* ctxPtr);
+    bool flushPendingData(NtContext* ctxPtr);
 #endif
 
 #if defined(NT_WINDOWS)
@@ -180,6 +377,86 @@ protected:
     bool controlEpoll(NtContext* ctrPtr, uint32_t events, int op);
 #endif
 
+    /**
+     * \brief Update client events
+     *
+     * Update the events watched for a client from its current state.
+     *
+     * \param ctxPtr Context pointer
+     * \return True on success
+     */
+    bool updateClientEvents(NtContext* ctxPtr);
+
+    /**
+     * \brief Track queued send data
+     *
+     * Account for data added to a client's send queue and pause reading
+     * from the client when a high water mark is exceeded.
+     *
+     * \param ctxPtr Context pointer
+     * \param len Number of bytes queued
+     */
+    void trackPendingSend(NtContext* ctxPtr, size_t len);
+
+    /**
+     * \brief Untrack queued send data
+     *
+     * Account for data removed from a client's send queue.
+     *
+     * \param ctxPtr Context pointer
+     * \param len Number of bytes removed
+     */
+    void untrackPendingSend(NtContext* ctxPtr, size_t len);
+
+    /**
+     * \brief Pause reading
+     *
+     * Stop reading from a client until relieveSendPressure() resumes it.
+     * The caller updates the client's events.
+     *
+     * \param ctxPtr Context pointer
+     */
+    void pauseReading(NtContext* ctxPtr);
+
+    /**
+     * \brief Relieve send pressure
+     *
+     * Resume paused clients once the queued data is below the low water
+     * marks. Must not be called with a context lock held.
+     *
+     * \param ctxPtr Context that has drained, or nullptr
+     */
+    void relieveSendPressure(NtContext* ctxPtr);
+
+    /**
+     * \brief Record queue delay
+     *
+     * Record the time a task spent queued before it started. May be called
+     * from any thread.
+     *
+     * \param delay Time spent queued
+     */
+    void recordQueueDelay(std::chrono::steady_clock::duration delay);
+
+    /**
+     * \brief Get load level
+     *
+     * Get the current load level in microseconds.
+     *
+     * \return Load level
+     */
+    uint64_t loadLevel() const { return std::max(m_loopLagUs.load(), m_queueDelayUs.load()); }
+
+    /**
+     * \brief Count event
+     *
+     * Add to one of the reactor's counters.
+     *
+     * \param counter Counter to add to
+     * \param value Value to add
+     */
+    void count(NtServerCounter counter, uint64_t value = 1) { m_counters.add(counter, value); }
+
     /**
      * \brief Terminate client
      *
@@ -267,6 +544,13 @@ private:
      */
     NtContext* popClientContextFromCache();
 
+    /**
+     * \brief Run posted tasks
+     *
+     * Drain the wakeup descriptor and run all tasks posted to the reactor.
+     */
+    void runPostedTasks();
+
 private:
     /**
      * Is connected
@@ -308,6 +592,16 @@ private:
      */
     size_t m_maxClients{ 0 };
 
+    /**
+     * Is the listener paused at the client limit
+     */
+    bool m_isListenPaused{ false };
+
+    /**
+     * Number of events handled per loop iteration
+     */
+    static constexpr int ms_eventBatchSize = 256;
+
     /**
      * Listen socket handle
      */
@@ -323,8 +617,93 @@ private:
      */
     std::mutex m_ctxCacheLock;
 
+    /**
+     * Per-connection send high water mark
+     */
+    size_t m_sendHighWaterMark{ 1024 * 1024 };
+
+    /**
+     * Per-connection send low water mark
+     */
+    size_t m_sendLowWaterMark{ 256 * 1024 };
+
+    /**
+     * Global send high water mark
+     */
+    size_t m_globalSendHighWaterMark{ 256 * 1024 * 1024 };
+
+    /**
+     * Global send low water mark
+     */
+    size_t m_globalSendLowWaterMark{ 128 * 1024 * 1024 };
+
+    /**
+     * Bytes queued across all clients
+     */
+    std::atomic<size_t> m_globalPendingSendBytes{ 0 };
+
+    /**
+     * Clients paused by send backpressure, with their generation
+     */
+    std::vector<std::pair<NtContext*, uint64_t>> m_pausedClients;
+
+    /**
+     * Paused clients lock
+     */
+    std::mutex m_pausedClientsLock;
+
+    /**
+     * Smoothed loop lag in microseconds
+     */
+    std::atomic<uint64_t> m_loopLagUs{ 0 };
+
+    /**
+     * Smoothed queue delay in microseconds
+     */
+    std::atomic<uint64_t> m_queueDelayUs{ 0 };
+
+    /**
+     * Shedding threshold in microseconds
+     */
+    uint64_t m_shedThresholdUs{ 0 };
+
+    /**
+     * Rejection threshold in microseconds
+     */
+    uint64_t m_rejectThresholdUs{ 0 };
+
+    /**
+     * Reactor counters
+     */
+    NtReactorCounters m_counters;
+
+    /**
+     * Reactor thread identifier
+     */
+    std::thread::id m_reactorThreadId;
+
+    /**
+     * Posted task queue
+     */
+    NtMPSCQueue<NtPostedTask> m_postedTasks;
+
+    /**
+     * Is a wakeup pending
+     */
+    std::atomic<bool> m_isWakePending{ false };
+
 #if defined(NT_APPLE) || defined(NT_UNIX)
     NtContext* m_listenContextPtr{ nullptr };
+
+    /**
+     * Wakeup context
+     */
+    NtContext* m_wakeContextPtr{ nullptr };
+
+    /**
+     * Wakeup write descriptor
+     */
+    int m_wakeWriteFd{ -1 };
 #endif
 };
 
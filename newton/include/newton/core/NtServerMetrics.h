@@ -0,0 +1,113 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtServerMetrics.h
+ * \brief Server metrics definitions
+ * \author Hákon Hjaltalín
+ *
+ * This file contains the counters a server keeps about its reactor and
+ * the snapshots they are read into.
+ */
+
+#include "newton/base/NtDefs.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace newton
+{
+
+/**
+ * \enum NtServerCounter
+ * \brief Server counter
+ *
+ * Events counted by a server's reactor.
+ */
+enum NtServerCounter
+{
+    NT_COUNTER_ACCEPTS = 0,         ///< Connections accepted
+    NT_COUNTER_REJECTS,             ///< Connections closed on accept under load
+    NT_COUNTER_REQUESTS,            ///< Requests received
+    NT_COUNTER_SHED_REQUESTS,       ///< Requests answered with 503 under load
+    NT_COUNTER_PARSE_ERRORS,        ///< Malformed, unframeable or oversized requests
+    NT_COUNTER_BYTES_IN,            ///< Bytes received
+    NT_COUNTER_BYTES_OUT,           ///< Bytes sent
+    NT_COUNTER_SEND_EAGAIN,         ///< Sends that would have blocked
+    NT_COUNTER_CONTEXT_CACHE_HITS,  ///< Client contexts reused from the cache
+    NT_COUNTER_CONTEXT_CACHE_MISSES,///< Client contexts allocated
+    NT_COUNTER_COUNT
+};
+
+/**
+ * \struct NtReactorCounters
+ * \brief Reactor counters
+ *
+ * Counters written by one reactor. They fill whole cache lines of their own
+ * so the reactor never shares a line with other writers, and are read with
+ * relaxed loads so scraping takes no lock.
+ */
+struct alignas(64) NtReactorCounters
+{
+    /**
+     * \brief Add to counter
+     *
+     * \param counter Counter to add to
+     * \param value Value to add
+     */
+    void add(NtServerCounter counter, uint64_t value = 1)
+    {
+        counters[counter].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Get counter
+     *
+     * \param counter Counter to read
+     * \return Counter value
+     */
+    uint64_t get(NtServerCounter counter) const { return counters[counter].load(std::memory_order_relaxed); }
+
+    std::atomic<uint64_t> counters[NT_COUNTER_COUNT]{};     ///< Counter values
+};
+
+/**
+ * \struct NtServerMetrics
+ * \brief Server metrics snapshot
+ *
+ * Counters and gauges read from one or more servers.
+ */
+struct NtServerMetrics
+{
+    uint64_t counters[NT_COUNTER_COUNT]{};  ///< Counter values
+    uint64_t connections{ 0 };              ///< Connected clients
+    uint64_t pendingSendBytes{ 0 };         ///< Bytes queued for sending
+    uint64_t loopLagUs{ 0 };                ///< Smoothed loop lag in microseconds
+    uint64_t queueDelayUs{ 0 };             ///< Smoothed queue delay in microseconds
+
+    /**
+     * \brief Merge snapshot
+     *
+     * Add the counters and gauges of another server to this snapshot. Loop
+     * lag and queue delay keep the worst of the two.
+     *
+     * \param other Snapshot to merge
+     */
+    void merge(const NtServerMetrics& other);
+
+    /**
+     * \brief Convert to Prometheus text
+     *
+     * Encode the snapshot in the Prometheus text exposition format.
+     *
+     * \return Metrics text
+     */
+    std::string toPrometheus() const;
+};
+
+}
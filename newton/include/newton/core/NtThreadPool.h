@@ -0,0 +1,148 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtThreadPool.h
+ * \brief Work-stealing thread pool
+ * \author Hákon Hjaltalín
+ *
+ * This file contains a thread pool used to offload blocking and CPU-heavy
+ * work from the server reactor.
+ */
+
+#include "newton/base/NtDefs.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace newton
+{
+
+/**
+ * \class NtThreadPool
+ * \brief Work-stealing thread pool
+ *
+ * Every worker owns a deque of tasks. Workers take their own work from the
+ * back of their deque and steal from the front of other workers' deques
+ * when they run dry. Tasks submitted from a worker go to its own deque,
+ * tasks submitted from other threads are spread round-robin.
+ */
+class NT_EXPORT NtThreadPool
+{
+public:
+    /**
+     * \brief Constructor
+     *
+     * Start the worker threads.
+     *
+     * \param threadCount Number of workers, zero for hardware concurrency
+     */
+    explicit NtThreadPool(size_t threadCount = 0);
+
+    NT_DISABLE_COPY(NtThreadPool)
+    NT_DISABLE_MOVE(NtThreadPool)
+
+    /**
+     * \brief Destructor
+     *
+     * Run all queued tasks and join the workers.
+     */
+    ~NtThreadPool();
+
+    /**
+     * \brief Submit task
+     *
+     * Queue a task for execution on one of the workers.
+     *
+     * \param task Task to run
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * \brief Get thread count
+     *
+     * Get the number of worker threads.
+     *
+     * \return Number of workers
+     */
+    size_t threadCount() const { return m_threads.size(); }
+
+private:
+    /**
+     * \struct NtWorkerQueue
+     * \brief Per-worker task deque
+     */
+    struct alignas(64) NtWorkerQueue
+    {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    /**
+     * \brief Worker loop
+     *
+     * Main loop for a worker thread.
+     *
+     * \param index Worker index
+     */
+    void workerLoop(size_t index);
+
+    /**
+     * \brief Pop task
+     *
+     * Take a task from the worker's own deque or steal one from another.
+     *
+     * \param index Worker index
+     * \param task Output task
+     * \return True if a task was found
+     */
+    bool popTask(size_t index, std::function<void()>& task);
+
+private:
+    /**
+     * Worker deques
+     */
+    std::vector<std::unique_ptr<NtWorkerQueue>> m_queues;
+
+    /**
+     * Worker threads
+     */
+    std::vector<std::thread> m_threads;
+
+    /**
+     * Sleep lock
+     */
+    std::mutex m_sleepLock;
+
+    /**
+     * Sleep condition
+     */
+    std::condition_variable m_sleepCond;
+
+    /**
+     * Number of queued tasks
+     */
+    std::atomic<size_t> m_pendingTasks{ 0 };
+
+    /**
+     * Round-robin queue index for external submissions
+     */
+    std::atomic<size_t> m_nextQueue{ 0 };
+
+    /**
+     * Is the pool running
+     */
+    std::atomic<bool> m_isRunning{ true };
+};
+
+}
@@ -67,6 +67,27 @@ public:
      */
     virtual NtHTTPResponse* handleRequest(NtHTTPRequest* req);
 
+    /**
+     * \brief Handle HTTP request asynchronously
+     *
+     * Dispatch an HTTP request to the matching route and report the
+     * response through a callback.
+     *
+     * \param req HTTP request
+     * \param done Completion callback
+     */
+    virtual void handleRequestAsync(NtHTTPRequest* req, NtResponseCallback done);
+
+    /**
+     * \brief Find route
+     *
+     * Find the route matching a request path.
+     *
+     * \param path Request path
+     * \return Matching route or nullptr
+     */
+    NtRoute* findRoute(const std::string& path);
+
     /**
      * \brief Get host name
      *
@@ -15,7 +15,10 @@
  */
 
 #include "newton/http/NtHTTPHeader.h"
+#include "newton/string/NtString.h"
 
+#include <algorithm>
+#include <string>
 #include <vector>
 
 namespace newton
@@ -67,14 +70,20 @@ public:
      * \param startLine HTTP start line for message
      */
     NtHTTPMessage(Type type, const std::string& startLine = "")
-        : m_type{ type }, m_startLine{ startLine }, m_headers{}, m_body{ nullptr }
+        : m_type{ type }, m_startLine{ startLine }, m_headers{}, m_body{}
     {
     }
 
+    NT_DISABLE_COPY(NtHTTPMessage)
+
     /**
      * \brief Virtual destructor
      */
-    virtual ~NtHTTPMessage() { }
+    virtual ~NtHTTPMessage()
+    {
+        for (auto* h : m_headers)
+            delete h;
+    }
 
     /**
      * \brief Set the start line
@@ -118,17 +127,18 @@ public:
     /**
      * \brief Remove header
      *
-     * Remove HTTP header by name.
+     * Remove HTTP header by name, ignoring case.
      *
      * \param name Header name to remove.
      */
     void removeHeader(const std::string& name)
     {
         auto it = std::find_if(m_headers.begin(), m_headers.end(), [&name](NtHTTPHeader*& hdr) {
-            return hdr->name() == name;
+            return NtEqualsIgnoreCase(hdr->name(), name);
         });
 
         if (it != m_headers.end()) {
+            delete *it;
             m_headers.erase(it);
         }
     }
@@ -136,7 +146,7 @@ public:
     /**
      * \brief Get header by name
      *
-     * Get HTTP header by name.
+     * Get HTTP header by name. Names are compared ignoring case.
      *
      * \param name Header name
      * \return HTTP header
@@ -144,7 +154,7 @@ public:
     NtHTTPHeader* getHeader(const std::string& name)
     {
         auto it = std::find_if(m_headers.begin(), m_headers.end(), [&name](NtHTTPHeader*& hdr) {
-            return hdr->name() == name;
+            return NtEqualsIgnoreCase(hdr->name(), name);
         });
 
         if (it != m_headers.end()) {
@@ -154,14 +164,31 @@ public:
         }
     }
 
+    /**
+     * \brief Get header by name
+     *
+     * Get HTTP header by name. Names are compared ignoring case.
+     *
+     * \param name Header name
+     * \return HTTP header
+     */
+    const NtHTTPHeader* getHeader(const std::string& name) const
+    {
+        auto it = std::find_if(m_headers.begin(), m_headers.end(), [&name](const NtHTTPHeader* hdr) {
+            return NtEqualsIgnoreCase(hdr->name(), name);
+        });
+
+        return it != m_headers.end() ? *it : nullptr;
+    }
+
     /**
      * \brief Set message body
      *
-     * Set the body of the HTTP message.
+     * Set the body of the HTTP message. The body may hold binary data.
      *
      * \param body Body to set
      */
-    void setBody(char* body = nullptr) { m_body = body; }
+    void setBody(std::string body = "") { m_body = std::move(body); }
 
     /**
      * \brief Get message body
@@ -170,7 +197,7 @@ public:
      *
      * \return Message body
      */
-    char* body() const { return m_body; }
+    const std::string& body() const { return m_body; }
     
     /**
      * \brief Get the type
@@ -201,11 +228,8 @@ public:
         }
 
         ret += "\r\n";
+        ret += m_body;
 
-        if (m_body) {
-            ret += m_body;
-        }
-        
         return ret;
     }
 
@@ -228,8 +252,25 @@ protected:
     /**
      * Message body
      */
-    char* m_body;
+    std::string m_body;
 };
 
+/**
+ * \fn NtHTTPMessageLength
+ * \brief Get length of an HTTP message
+ *
+ * Get the length of the first complete message in a buffer, including a
+ * body announced by Content-Length, so pipelined messages can be taken
+ * apart one at a time. Messages without Content-Length have no body.
+ * Throws NtSyntaxError for messages using Transfer-Encoding and for
+ * invalid or conflicting Content-Length headers, since their end cannot
+ * be found reliably.
+ *
+ * \param buf Data buffer
+ * \param len Length of data
+ * \return Message length, zero if the message is incomplete
+ */
+size_t NtHTTPMessageLength(const char* buf, size_t len);
+
 }
 
@@ -14,6 +14,7 @@
  */
 
 #include "newton/http/NtHTTPMessage.h"
+#include "newton/json/NtJSONFormat.h"
 
 namespace newton
 {
@@ -115,6 +116,44 @@ public:
      */
     NtHTTPVersion version() const { return m_version; }
 
+    /**
+     * \brief Get body format
+     *
+     * Get the format of the request body from its Content-Type header.
+     *
+     * \return Body format
+     */
+    NtJSONFormat bodyFormat() const;
+
+    /**
+     * \brief Parse body
+     *
+     * Decode the request body in its format into a document. Throws
+     * NtSyntaxError on an invalid body.
+     *
+     * \param doc Document to fill
+     */
+    void parseBody(NtJSONDocument& doc) const;
+
+    /**
+     * \brief Set response format
+     *
+     * Set the format responses to this request are encoded in.
+     *
+     * \param format Response format
+     */
+    void setResponseFormat(NtJSONFormat format) { m_responseFormat = format; }
+
+    /**
+     * \brief Get response format
+     *
+     * Get the format responses to this request are encoded in, negotiated
+     * from the Accept header by the server.
+     *
+     * \return Response format
+     */
+    NtJSONFormat responseFormat() const { return m_responseFormat; }
+
 protected:
     /**
      * Parse request line
@@ -136,6 +175,11 @@ protected:
      * HTTP version
      */
     NtHTTPVersion m_version;
+
+    /**
+     * Response format
+     */
+    NtJSONFormat m_responseFormat{ NtJSONFormat::JSON };
 };
 
 /**
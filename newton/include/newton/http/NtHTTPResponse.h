@@ -14,6 +14,7 @@
  */
 
 #include "newton/http/NtHTTPMessage.h"
+#include "newton/json/NtJSONFormat.h"
 
 namespace newton
 {
@@ -43,6 +44,31 @@ public:
      * \brief Virtual destructor
      */
     virtual ~NtHTTPResponse() { }
+
+    /**
+     * \brief Set JSON body
+     *
+     * Encode an element tree as the body and set the Content-Type and
+     * Content-Length headers.
+     *
+     * \param element Root element
+     * \param format Wire format
+     */
+    void setJSONBody(const NtJSONElement* element, NtJSONFormat format = NtJSONFormat::JSON);
+
+    /**
+     * \brief Set JSON body
+     *
+     * Encode a document value as the body and set the Content-Type and
+     * Content-Length headers.
+     *
+     * \param value Document value
+     * \param format Wire format
+     */
+    void setJSONBody(const NtJSONValue& value, NtJSONFormat format = NtJSONFormat::JSON);
+
+private:
+    void setContentHeaders(NtJSONFormat format);
 };
 
 }
@@ -0,0 +1,88 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtCBOR.h
+ * \brief CBOR encoding
+ * \author Hákon Hjaltalín
+ *
+ * This file contains an encoder and decoder for CBOR (RFC 8949), sharing the JSON
+ * element model.
+ */
+
+#include "newton/json/NtJSONReader.h"
+#include "newton/json/NtJSONDocument.h"
+
+#include <string>
+
+namespace newton
+{
+
+/**
+ * \fn NtEncodeCBOR
+ * \brief Encode element tree
+ *
+ * Encode an element tree as CBOR. Integers use the smallest
+ * representation that holds them and doubles are written as float 64.
+ *
+ * \param element Root element
+ * \return Encoded data
+ */
+std::string NtEncodeCBOR(const NtJSONElement* element);
+
+/**
+ * \fn NtEncodeCBOR
+ * \brief Encode document value
+ *
+ * Encode a document value as CBOR.
+ *
+ * \param value Document value
+ * \return Encoded data
+ */
+std::string NtEncodeCBOR(const NtJSONValue& value);
+
+/**
+ * \fn NtDecodeCBOR
+ * \brief Decode to handler
+ *
+ * Decode a single CBOR value and report it to a handler with the same
+ * events an NtJSONReader produces. Binary values are reported as base64url
+ * strings without padding. Throws NtSyntaxError on invalid or truncated
+ * data.
+ *
+ * \param data Data buffer
+ * \param len Length of data
+ * \param handler Event handler
+ * \return False if the handler stopped decoding
+ */
+bool NtDecodeCBOR(const char* data, size_t len, NtJSONHandler* handler);
+
+/**
+ * \fn NtParseCBOR
+ * \brief Parse element tree
+ *
+ * Decode CBOR data into an element tree owned by the caller.
+ *
+ * \param data Data buffer
+ * \param len Length of data
+ * \return Root element
+ */
+NtJSONElement* NtParseCBOR(const char* data, size_t len);
+
+/**
+ * \fn NtParseCBOR
+ * \brief Parse document
+ *
+ * Decode CBOR data into a document, replacing its contents.
+ *
+ * \param data Data buffer
+ * \param len Length of data
+ * \param doc Document to fill
+ */
+void NtParseCBOR(const char* data, size_t len, NtJSONDocument& doc);
+
+}
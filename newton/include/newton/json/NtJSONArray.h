@@ -103,6 +103,24 @@ public:
      */
     size_t count() const { return m_members.size(); }
 
+    /**
+     * \brief Begin iterator
+     *
+     * Get an iterator to the first element.
+     *
+     * \return Element iterator
+     */
+    auto begin() const { return m_members.begin(); }
+
+    /**
+     * \brief End iterator
+     *
+     * Get an iterator past the last element.
+     *
+     * \return Element iterator
+     */
+    auto end() const { return m_members.end(); }
+
 private:
     /**
      * Members
@@ -0,0 +1,327 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtJSONBinding.h
+ * \brief JSON struct binding
+ * \author Hákon Hjaltalín
+ *
+ * This file contains templates mapping C++ structs to JSON objects and
+ * back without building an element tree.
+ *
+ * A struct is bound by listing its fields next to it:
+ *
+ * \code
+ * struct NtUser
+ * {
+ *     int64_t id;
+ *     std::string name;
+ *     std::vector<std::string> roles;
+ *     std::optional<std::string> email;
+ * };
+ *
+ * NT_JSON_BIND(NtUser,
+ *     NT_JSON_FIELD(id),
+ *     NT_JSON_FIELD(name),
+ *     NT_JSON_NAMED_FIELD("user_roles", roles),
+ *     NT_JSON_FIELD(email))
+ * \endcode
+ *
+ * The binding must be declared in the struct's namespace.
+ */
+
+#include "newton/base/NtException.h"
+#include "newton/json/NtJSONCursor.h"
+#include "newton/json/NtJSONWriter.h"
+
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace newton
+{
+
+/**
+ * \struct NtJSONField
+ * \brief Bound struct field
+ *
+ * JSON member name and the struct member it maps to.
+ */
+template <typename T, typename M>
+struct NtJSONField
+{
+    std::string_view name;  ///< JSON member name
+    M T::* member;          ///< Struct member
+};
+
+/**
+ * \fn NtMakeJSONField
+ * \brief Make bound field
+ *
+ * Make a field binding. Used by NT_JSON_FIELD.
+ *
+ * \param name JSON member name
+ * \param member Struct member
+ * \return Field binding
+ */
+template <typename T, typename M>
+constexpr NtJSONField<T, M> NtMakeJSONField(std::string_view name, M T::* member)
+{
+    return NtJSONField<T, M>{ name, member };
+}
+
+/**
+ * Bind a struct member under its own name
+ */
+#define NT_JSON_FIELD(name) ::newton::NtMakeJSONField(#name, &NtBoundType::name)
+
+/**
+ * Bind a struct member under another JSON name
+ */
+#define NT_JSON_NAMED_FIELD(key, name) ::newton::NtMakeJSONField(key, &NtBoundType::name)
+
+/**
+ * Declare the JSON fields of a struct
+ */
+#define NT_JSON_BIND(Type, ...) \
+    inline constexpr auto NtJSONFields(const Type*) \
+    { \
+        using NtBoundType = Type; \
+        return std::make_tuple(__VA_ARGS__); \
+    }
+
+/**
+ * \struct NtIsJSONBound
+ * \brief Bound struct check
+ *
+ * True for types declared with NT_JSON_BIND.
+ */
+template <typename T, typename = void>
+struct NtIsJSONBound : std::false_type { };
+
+template <typename T>
+struct NtIsJSONBound<T, std::void_t<decltype(NtJSONFields(static_cast<const T*>(nullptr)))>> : std::true_type { };
+
+template <typename T>
+struct NtIsJSONVector : std::false_type { };
+
+template <typename T, typename A>
+struct NtIsJSONVector<std::vector<T, A>> : std::true_type { };
+
+template <typename T>
+struct NtIsJSONOptional : std::false_type { };
+
+template <typename T>
+struct NtIsJSONOptional<std::optional<T>> : std::true_type { };
+
+/**
+ * \fn NtReadJSON
+ * \brief Read bound value
+ *
+ * Read a value from a cursor into a bool, number, string, vector, optional
+ * or bound struct. Object members with unknown names are skipped and
+ * missing members keep their current value. Throws NtSyntaxError when a
+ * value has the wrong type, or when a number read into an integer has a
+ * fractional part or does not fit.
+ *
+ * \param value JSON value
+ * \param out Value to fill
+ */
+template <typename T>
+void NtReadJSON(const NtJSONCursor& value, T& out)
+{
+    if constexpr (std::is_same<T, bool>::value) {
+        if (!value.isBoolean())
+            throw NtSyntaxError("Expected JSON boolean.");
+
+        out = value.asBoolean();
+    } else if constexpr (std::is_integral<T>::value) {
+        if (!value.isNumber())
+            throw NtSyntaxError("Expected JSON number.");
+
+        if constexpr (std::is_signed<T>::value) {
+            int64_t n = 0;
+
+            if (!value.getInt64(n) || n < std::numeric_limits<T>::min() || n > std::numeric_limits<T>::max())
+                throw NtSyntaxError("JSON number is not an integer in range.");
+
+            out = static_cast<T>(n);
+        } else {
+            uint64_t n = 0;
+
+            if (!value.getUInt64(n) || n > std::numeric_limits<T>::max())
+                throw NtSyntaxError("JSON number is not an integer in range.");
+
+            out = static_cast<T>(n);
+        }
+    } else if constexpr (std::is_floating_point<T>::value) {
+        if (!value.isNumber())
+            throw NtSyntaxError("Expected JSON number.");
+
+        out = static_cast<T>(value.asNumber());
+    } else if constexpr (std::is_same<T, std::string>::value) {
+        if (!value.isString())
+            throw NtSyntaxError("Expected JSON string.");
+
+        out = value.asString();
+    } else if constexpr (NtIsJSONOptional<T>::value) {
+        if (value.isNull())
+            out.reset();
+        else
+            NtReadJSON(value, out.emplace());
+    } else if constexpr (NtIsJSONVector<T>::value) {
+        if (!value.isArray())
+            throw NtSyntaxError("Expected JSON array.");
+
+        out.clear();
+
+        // Elements are read into a temporary, as std::vector<bool> has no
+        // element to bind a reference to.
+        for (auto it = value.begin(); it != value.end(); ++it) {
+            typename T::value_type element{};
+            NtReadJSON(*it, element);
+            out.push_back(std::move(element));
+        }
+    } else {
+        NT_STATIC_ASSERT_MSG(NtIsJSONBound<T>::value, "Type has no JSON binding.");
+
+        if (!value.isObject())
+            throw NtSyntaxError("Expected JSON object.");
+
+        constexpr auto fields = NtJSONFields(static_cast<const T*>(nullptr));
+        std::string decoded;
+
+        for (auto it = value.begin(); it != value.end(); ++it) {
+            std::string_view key = it.rawKey();
+
+            if (it.isKeyEscaped()) {
+                decoded = it.key();
+                key = decoded;
+            }
+
+            // Names are compile-time constants, so each field is checked
+            // by length before any memcmp, in one unrolled fold.
+            std::apply([&](const auto&... field) {
+                ((key.size() == field.name.size() &&
+                    memcmp(key.data(), field.name.data(), key.size()) == 0 &&
+                    (NtReadJSON(*it, out.*(field.member)), true)) || ...);
+            }, fields);
+        }
+    }
+}
+
+/**
+ * \fn NtWriteJSON
+ * \brief Write bound value
+ *
+ * Write a bool, number, string, vector, optional or bound struct. Empty
+ * optional members are left out of their object.
+ *
+ * \param writer JSON writer
+ * \param value Value to write
+ */
+template <typename T>
+void NtWriteJSON(NtJSONWriter& writer, const T& value)
+{
+    if constexpr (std::is_same<T, bool>::value) {
+        writer.boolean(value);
+    } else if constexpr (std::is_integral<T>::value) {
+        if constexpr (std::is_signed<T>::value)
+            writer.integer(static_cast<int64_t>(value));
+        else
+            writer.uinteger(static_cast<uint64_t>(value));
+    } else if constexpr (std::is_floating_point<T>::value) {
+        writer.number(static_cast<double>(value));
+    } else if constexpr (std::is_convertible<const T&, std::string_view>::value) {
+        writer.string(value);
+    } else if constexpr (NtIsJSONOptional<T>::value) {
+        if (value)
+            NtWriteJSON(writer, *value);
+        else
+            writer.null();
+    } else if constexpr (NtIsJSONVector<T>::value) {
+        writer.startArray();
+
+        for (const auto& element : value)
+            NtWriteJSON(writer, element);
+
+        writer.endArray();
+    } else {
+        NT_STATIC_ASSERT_MSG(NtIsJSONBound<T>::value, "Type has no JSON binding.");
+
+        constexpr auto fields = NtJSONFields(static_cast<const T*>(nullptr));
+
+        writer.startObject();
+
+        std::apply([&](const auto&... field) {
+            ([&] {
+                const auto& member = value.*(field.member);
+
+                if constexpr (NtIsJSONOptional<std::decay_t<decltype(member)>>::value) {
+                    if (!member)
+                        return;
+                }
+
+                writer.key(field.name);
+                NtWriteJSON(writer, member);
+            }(), ...);
+        }, fields);
+
+        writer.endObject();
+    }
+}
+
+/**
+ * \fn NtDeserializeJSON
+ * \brief Deserialize bound struct
+ *
+ * Parse a JSON text straight into a bound struct. Throws NtSyntaxError
+ * if anything but whitespace follows the value.
+ *
+ * \param json JSON text
+ * \param out Struct to fill
+ */
+template <typename T, typename std::enable_if<NtIsJSONBound<T>::value, int>::type = 0>
+void NtDeserializeJSON(std::string_view json, T& out)
+{
+    NtJSONCursor root(json);
+
+    if (!root)
+        throw NtSyntaxError("Empty JSON text.");
+
+    NtReadJSON(root, out);
+
+    if (!root.isLast())
+        throw NtSyntaxError("Unexpected data after JSON value.");
+}
+
+/**
+ * \fn NtSerializeJSON
+ * \brief Serialize bound struct
+ *
+ * Serialize a bound struct to a string.
+ *
+ * \param value Struct to serialize
+ * \param isPretty Pretty print
+ * \return JSON text
+ */
+template <typename T, typename std::enable_if<NtIsJSONBound<T>::value, int>::type = 0>
+std::string NtSerializeJSON(const T& value, bool isPretty = false)
+{
+    NtJSONWriter writer;
+    writer.setPretty(isPretty);
+    NtWriteJSON(writer, value);
+    return writer.take();
+}
+
+}
@@ -0,0 +1,142 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtJSONBuilder.h
+ * \brief JSON builders
+ * \author Hákon Hjaltalín
+ *
+ * This file contains event handlers building element trees and documents.
+ */
+
+#include "newton/json/NtJSONReader.h"
+#include "newton/json/NtJSONDocument.h"
+
+#include <string>
+#include <vector>
+
+namespace newton
+{
+
+/**
+ * \class NtJSONTreeBuilder
+ * \brief Element tree builder
+ *
+ * Event handler building an element tree, so any event source such as an
+ * NtJSONReader or a binary decoder can produce NtJSONElement objects. The
+ * tree belongs to the caller once taken.
+ */
+class NT_EXPORT NtJSONTreeBuilder : public NtJSONHandler
+{
+public:
+    /**
+     * \brief Constructor
+     *
+     * Default constructor.
+     */
+    NtJSONTreeBuilder() { }
+
+    NT_DISABLE_COPY(NtJSONTreeBuilder)
+
+    /**
+     * \brief Destructor
+     *
+     * Delete a tree that was not taken.
+     */
+    ~NtJSONTreeBuilder();
+
+    bool startObject() override;
+    bool endObject() override;
+    bool startArray() override;
+    bool endArray() override;
+    bool key(std::string_view name) override;
+    bool string(std::string_view value) override;
+    bool number(double value) override;
+    bool integer(int64_t value) override;
+    bool uinteger(uint64_t value) override;
+    bool boolean(bool value) override;
+    bool null() override;
+
+    /**
+     * \brief Take root
+     *
+     * Take ownership of the built tree and reset the builder.
+     *
+     * \return Root element, nullptr if nothing was built
+     */
+    NtJSONElement* take();
+
+private:
+    void add(NtJSONElement* element);
+
+private:
+    /**
+     * Root element
+     */
+    NtJSONElement* m_root{ nullptr };
+
+    /**
+     * Open containers
+     */
+    std::vector<NtJSONElement*> m_stack;
+
+    /**
+     * Name of the next object member
+     */
+    std::string m_key;
+};
+
+/**
+ * \class NtJSONDocumentBuilder
+ * \brief Document builder
+ *
+ * Event handler appending nodes to an NtJSONDocument, so any event source
+ * can fill an arena document.
+ */
+class NT_EXPORT NtJSONDocumentBuilder : public NtJSONHandler
+{
+public:
+    /**
+     * \brief Constructor
+     *
+     * Construct a builder clearing and filling a document.
+     *
+     * \param doc Document to fill
+     */
+    explicit NtJSONDocumentBuilder(NtJSONDocument& doc);
+
+    NT_DISABLE_COPY(NtJSONDocumentBuilder)
+
+    bool startObject() override;
+    bool endObject() override;
+    bool startArray() override;
+    bool endArray() override;
+    bool key(std::string_view name) override;
+    bool string(std::string_view value) override;
+    bool number(double value) override;
+    bool integer(int64_t value) override;
+    bool uinteger(uint64_t value) override;
+    bool boolean(bool value) override;
+    bool null() override;
+
+private:
+    NtJSONNode& append(NtJSONElement::Type type);
+    bool endContainer();
+
+private:
+    /**
+     * Document
+     */
+    NtJSONDocument& m_doc;
+
+    /**
+     * Node indices and child counts of open containers
+     */
+    std::vector<std::pair<size_t, uint32_t>> m_stack;
+};
+
+}
@@ -0,0 +1,358 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtJSONCursor.h
+ * \brief On-demand JSON cursor
+ * \author Hákon Hjaltalín
+ *
+ * This file contains a cursor for reading values out of JSON text without
+ * parsing it up front.
+ */
+
+#include "newton/json/NtJSONElement.h"
+
+#include <string>
+#include <string_view>
+
+namespace newton
+{
+
+struct NtJSONNumberValue;
+
+/**
+ * \class NtJSONCursor
+ * \brief On-demand JSON cursor
+ *
+ * Lightweight position in a JSON text. Nothing is parsed until a value is
+ * accessed: member and element lookups walk the raw bytes and jump over
+ * subtrees they do not need, and scalars are decoded only when read. The
+ * text must outlive the cursor.
+ *
+ * Only the parts of the text that are visited get checked, so invalid JSON
+ * in skipped subtrees may go unnoticed. Errors in visited parts throw
+ * NtSyntaxError. Lookups that find nothing return an invalid cursor.
+ */
+class NT_EXPORT NtJSONCursor
+{
+public:
+    /**
+     * \class Iterator
+     * \brief Child iterator
+     *
+     * Iterates over the elements of an array or the members of an object.
+     */
+    class NT_EXPORT Iterator
+    {
+    public:
+        /**
+         * \brief Constructor
+         *
+         * Construct an iterator at the first child of a container, or an
+         * end iterator if pos is npos.
+         *
+         * \param data JSON text
+         * \param len Length of text
+         * \param pos Position of the first child
+         * \param isObject True when iterating object members
+         */
+        Iterator(const char* data, size_t len, size_t pos, bool isObject);
+
+        /**
+         * \brief Get value
+         *
+         * Get the current element or member value.
+         *
+         * \return Current value
+         */
+        NtJSONCursor operator*() const { return NtJSONCursor(m_data, m_len, m_valuePos); }
+
+        /**
+         * \brief Get key
+         *
+         * Get the decoded name of the current member.
+         *
+         * \return Member name
+         */
+        std::string key() const;
+
+        /**
+         * \brief Get raw key
+         *
+         * Get the name of the current member as it appears in the text,
+         * without quotes and escapes left in place.
+         *
+         * \return Raw member name
+         */
+        std::string_view rawKey() const { return std::string_view(m_data + m_pos + 1, m_keyLen); }
+
+        /**
+         * \brief Key has escapes
+         *
+         * Check whether the raw key contains escape sequences.
+         *
+         * \return True if the key must be decoded
+         */
+        bool isKeyEscaped() const { return m_isKeyEscaped; }
+
+        Iterator& operator++();
+
+        bool operator==(const Iterator& other) const { return m_pos == other.m_pos; }
+        bool operator!=(const Iterator& other) const { return m_pos != other.m_pos; }
+
+    private:
+        void locateValue();
+
+        const char* m_data;
+        size_t m_len;
+        size_t m_pos;
+        size_t m_valuePos;
+        size_t m_keyLen;
+        bool m_isObject;
+        bool m_isKeyEscaped;
+    };
+
+    /**
+     * End position
+     */
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    /**
+     * \brief Constructor
+     *
+     * Construct an invalid cursor.
+     */
+    NtJSONCursor()
+        : m_data{ nullptr }, m_len{ 0 }, m_pos{ 0 }
+    {
+    }
+
+    /**
+     * \brief Constructor
+     *
+     * Construct a cursor at the root value of a JSON text.
+     *
+     * \param data JSON text
+     * \param len Length of text
+     */
+    NtJSONCursor(const char* data, size_t len);
+
+    /**
+     * \brief Constructor
+     *
+     * Construct a cursor at the root value of a JSON text.
+     *
+     * \param json JSON text
+     */
+    explicit NtJSONCursor(std::string_view json)
+        : NtJSONCursor(json.data(), json.size())
+    {
+    }
+
+    /**
+     * \brief Constructor
+     *
+     * Construct a cursor at a value in a JSON text.
+     *
+     * \param data JSON text
+     * \param len Length of text
+     * \param pos Position of the value
+     */
+    NtJSONCursor(const char* data, size_t len, size_t pos)
+        : m_data{ data }, m_len{ len }, m_pos{ pos }
+    {
+    }
+
+    /**
+     * \brief Is valid
+     *
+     * Check whether this cursor points at a value.
+     *
+     * \return True if valid
+     */
+    bool isValid() const { return m_data != nullptr; }
+
+    explicit operator bool() const { return isValid(); }
+
+    /**
+     * \brief Get type
+     *
+     * Get the type of the value from its first character.
+     *
+     * \return Value type
+     */
+    NtJSONElement::Type type() const;
+
+    bool isObject() const { return isValid() && m_data[m_pos] == '{'; }
+    bool isArray() const { return isValid() && m_data[m_pos] == '['; }
+    bool isString() const { return isValid() && m_data[m_pos] == '"'; }
+    bool isNumber() const { return isValid() && type() == NtJSONElement::Type::NUMBER; }
+    bool isBoolean() const { return isValid() && type() == NtJSONElement::Type::BOOLEAN; }
+    bool isNull() const { return isValid() && type() == NtJSONElement::Type::NUL; }
+
+    /**
+     * \brief Get string value
+     *
+     * Decode a string value, or return an empty string for other types.
+     *
+     * \return String value
+     */
+    std::string asString() const;
+
+    /**
+     * \brief Get numeric value
+     *
+     * Decode a number, or return zero for other types.
+     *
+     * \return Numeric value
+     */
+    double asNumber() const;
+
+    /**
+     * \brief Get signed integer value
+     *
+     * Decode a number as a signed integer. Doubles are truncated.
+     *
+     * \return Integer value
+     */
+    int64_t asInt64() const;
+
+    /**
+     * \brief Get unsigned integer value
+     *
+     * Decode a number as an unsigned integer. Doubles are truncated.
+     *
+     * \return Integer value
+     */
+    uint64_t asUInt64() const;
+
+    /**
+     * \brief Get exact signed integer value
+     *
+     * Decode a number that is an integer, including doubles without a
+     * fractional part such as 1e3, without truncating or wrapping it.
+     *
+     * \param out Integer value
+     * \return False if the value is not an integer that fits in 64 bits
+     */
+    bool getInt64(int64_t& out) const;
+
+    /**
+     * \brief Get exact unsigned integer value
+     *
+     * Decode a number that is a non-negative integer, including doubles
+     * without a fractional part, without truncating or wrapping it.
+     *
+     * \param out Integer value
+     * \return False if the value is not an integer that fits in 64 bits
+     */
+    bool getUInt64(uint64_t& out) const;
+
+    /**
+     * \brief Get boolean value
+     *
+     * Decode a boolean, or return false for other types.
+     *
+     * \return Boolean value
+     */
+    bool asBoolean() const;
+
+    /**
+     * \brief Element count
+     *
+     * Count the elements or members of a container. This walks the whole
+     * container.
+     *
+     * \return Number of children
+     */
+    size_t count() const;
+
+    /**
+     * \brief Access member
+     *
+     * Find an object member by name, skipping the values of the members
+     * before it.
+     *
+     * \param name Member name
+     * \return Member value, invalid if not found
+     */
+    NtJSONCursor get(std::string_view name) const;
+
+    /**
+     * \brief Access element
+     *
+     * Find an array element by index, skipping the elements before it.
+     *
+     * \param idx Index to access
+     * \return Element value, invalid if out of range
+     */
+    NtJSONCursor get(size_t idx) const;
+
+    NtJSONCursor operator[](std::string_view name) const { return get(name); }
+    NtJSONCursor operator[](size_t idx) const { return get(idx); }
+
+    Iterator begin() const;
+    Iterator end() const;
+
+    /**
+     * \brief Get raw text
+     *
+     * Get the text of the value, including quotes and brackets.
+     *
+     * \return Raw value text
+     */
+    std::string_view raw() const;
+
+    /**
+     * \brief Get position
+     *
+     * Get the offset of the value in the text.
+     *
+     * \return Value position
+     */
+    size_t position() const { return m_pos; }
+
+    /**
+     * \brief Skip value
+     *
+     * Get the position after a value and its subtree.
+     *
+     * \return Position after the value
+     */
+    size_t skip() const;
+
+    /**
+     * \brief Is last value
+     *
+     * Check whether only whitespace follows the value in the text, as it
+     * must for a root value.
+     *
+     * \return True if nothing follows the value
+     */
+    bool isLast() const;
+
+private:
+    NtJSONNumberValue scanNumber() const;
+
+private:
+    /**
+     * JSON text
+     */
+    const char* m_data;
+
+    /**
+     * Length of text
+     */
+    size_t m_len;
+
+    /**
+     * Position of the value
+     */
+    size_t m_pos;
+};
+
+}
@@ -0,0 +1,553 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtJSONDocument.h
+ * \brief Arena-backed JSON document
+ * \author Hákon Hjaltalín
+ *
+ * This file contains a JSON document that stores its tree as compact nodes
+ * in contiguous memory and owns all of its strings.
+ */
+
+#include "newton/base/NtArena.h"
+#include "newton/base/NtMappedFile.h"
+#include "newton/json/NtJSONNumber.h"
+
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace newton
+{
+
+class NtJSONDocument;
+
+/**
+ * \struct NtJSONNode
+ * \brief Document node
+ *
+ * Compact tagged node. Nodes are stored in document order: a container is
+ * followed by its children, and an object's children alternate between
+ * key strings and values. Containers record the index of the node after
+ * their subtree so whole subtrees can be skipped in one step.
+ *
+ * Strings of up to eight bytes are stored inline in the node, zero padded,
+ * and need no arena memory.
+ */
+struct NtJSONNode
+{
+    /**
+     * String flags
+     */
+    enum : uint8_t
+    {
+        INLINE = 0x01,      ///< String stored inline
+        INTERNED = 0x02     ///< Key shared through the intern table
+    };
+
+    /**
+     * Longest string stored inline
+     */
+    static constexpr size_t ms_inlineSize = 8;
+
+    uint8_t type;           ///< NtJSONElement::Type of the node
+    uint8_t flags;          ///< NtJSONNumber::Kind of a number, string flags of a string
+    uint16_t reserved;      ///< Unused
+    uint32_t size;          ///< String length or number of children
+
+    union
+    {
+        double number;      ///< Double value
+        int64_t integer;    ///< Signed integer value
+        uint64_t uinteger;  ///< Unsigned integer value
+        bool boolean;       ///< Boolean value
+        const char* string; ///< String data, not null-terminated
+        char inlined[ms_inlineSize]; ///< Short string data
+        uint64_t next;      ///< Index after a container's subtree
+    };
+
+    /**
+     * \brief Get string
+     *
+     * Get the data of a string node.
+     *
+     * \return String value
+     */
+    std::string_view str() const
+    {
+        return std::string_view((flags & INLINE) ? inlined : string, size);
+    }
+};
+
+NT_STATIC_ASSERT_MSG(sizeof(NtJSONNode) == 16, "JSON nodes must stay 16 bytes.");
+
+/**
+ * \class NtJSONValue
+ * \brief Document value handle
+ *
+ * Lightweight handle to a value inside an NtJSONDocument. Handles are only
+ * valid while the document is alive. Lookups that find nothing return an
+ * invalid handle instead of throwing.
+ */
+class NT_EXPORT NtJSONValue
+{
+public:
+    /**
+     * \class Iterator
+     * \brief Child iterator
+     *
+     * Iterates over the elements of an array or the members of an object.
+     */
+    class Iterator
+    {
+    public:
+        Iterator(const NtJSONDocument* doc, uint32_t index, bool isObject)
+            : m_doc{ doc }, m_index{ index }, m_isObject{ isObject }
+        {
+        }
+
+        /**
+         * \brief Get value
+         *
+         * Get the current element or member value.
+         *
+         * \return Current value
+         */
+        NtJSONValue operator*() const { return NtJSONValue(m_doc, m_isObject ? m_index + 1 : m_index); }
+
+        /**
+         * \brief Get key
+         *
+         * Get the current member name when iterating an object.
+         *
+         * \return Member name
+         */
+        std::string_view key() const { return NtJSONValue(m_doc, m_index).asString(); }
+
+        Iterator& operator++();
+
+        bool operator==(const Iterator& other) const { return m_index == other.m_index; }
+        bool operator!=(const Iterator& other) const { return m_index != other.m_index; }
+
+    private:
+        const NtJSONDocument* m_doc;
+        uint32_t m_index;
+        bool m_isObject;
+    };
+
+    /**
+     * \brief Constructor
+     *
+     * Construct an invalid handle.
+     */
+    NtJSONValue()
+        : m_doc{ nullptr }, m_index{ 0 }
+    {
+    }
+
+    /**
+     * \brief Constructor
+     *
+     * Construct a handle to a document node.
+     *
+     * \param doc Document
+     * \param index Node index
+     */
+    NtJSONValue(const NtJSONDocument* doc, uint32_t index)
+        : m_doc{ doc }, m_index{ index }
+    {
+    }
+
+    /**
+     * \brief Is valid
+     *
+     * Check whether this handle refers to a value.
+     *
+     * \return True if valid
+     */
+    bool isValid() const { return m_doc != nullptr; }
+
+    explicit operator bool() const { return isValid(); }
+
+    /**
+     * \brief Get type
+     *
+     * Get the type of the value.
+     *
+     * \return Value type
+     */
+    NtJSONElement::Type type() const;
+
+    bool isObject() const { return isValid() && type() == NtJSONElement::Type::OBJECT; }
+    bool isArray() const { return isValid() && type() == NtJSONElement::Type::ARRAY; }
+    bool isString() const { return isValid() && type() == NtJSONElement::Type::STRING; }
+    bool isNumber() const { return isValid() && type() == NtJSONElement::Type::NUMBER; }
+    bool isBoolean() const { return isValid() && type() == NtJSONElement::Type::BOOLEAN; }
+    bool isNull() const { return isValid() && type() == NtJSONElement::Type::NUL; }
+
+    /**
+     * \brief Get string value
+     *
+     * Get the value of a string, or an empty view for other types.
+     *
+     * \return String value
+     */
+    std::string_view asString() const;
+
+    /**
+     * \brief Get numeric value
+     *
+     * Get the value of a number, or zero for other types.
+     *
+     * \return Numeric value
+     */
+    double asNumber() const;
+
+    /**
+     * \brief Get signed integer value
+     *
+     * Get the value of a number as a signed integer. Doubles are truncated.
+     *
+     * \return Integer value
+     */
+    int64_t asInt64() const;
+
+    /**
+     * \brief Get unsigned integer value
+     *
+     * Get the value of a number as an unsigned integer. Doubles are
+     * truncated.
+     *
+     * \return Integer value
+     */
+    uint64_t asUInt64() const;
+
+    /**
+     * \brief Get number representation
+     *
+     * Get how a number is stored.
+     *
+     * \return Number kind
+     */
+    NtJSONNumber::Kind numberKind() const;
+
+    /**
+     * \brief Get boolean value
+     *
+     * Get the value of a boolean, or false for other types.
+     *
+     * \return Boolean value
+     */
+    bool asBoolean() const;
+
+    /**
+     * \brief Element count
+     *
+     * Get the number of elements or members of a container.
+     *
+     * \return Number of children
+     */
+    size_t count() const;
+
+    /**
+     * \brief Access member
+     *
+     * Get an object member by name.
+     *
+     * \param name Member name
+     * \return Member value, invalid if not found
+     */
+    NtJSONValue get(std::string_view name) const;
+
+    /**
+     * \brief Access element
+     *
+     * Get an array element by index.
+     *
+     * \param idx Index to access
+     * \return Element value, invalid if out of range
+     */
+    NtJSONValue get(size_t idx) const;
+
+    NtJSONValue operator[](std::string_view name) const { return get(name); }
+    NtJSONValue operator[](size_t idx) const { return get(idx); }
+
+    Iterator begin() const;
+    Iterator end() const;
+
+    /**
+     * \brief Get node index
+     *
+     * Get the index of the node in the document.
+     *
+     * \return Node index
+     */
+    uint32_t index() const { return m_index; }
+
+private:
+    /**
+     * Document
+     */
+    const NtJSONDocument* m_doc;
+
+    /**
+     * Node index
+     */
+    uint32_t m_index;
+};
+
+/**
+ * \class NtJSONDocument
+ * \brief Arena-backed JSON document
+ *
+ * JSON document holding its nodes in one contiguous array and its strings
+ * in a bump arena. Parsing does one allocation per arena block instead of
+ * one per value, and everything is freed at once with the document.
+ *
+ * Parsing runs in two stages: the text is first scanned in 64-byte blocks
+ * with SIMD instructions to index its structural characters, then the
+ * nodes are built by walking that index without looking at whitespace.
+ *
+ * With key interning enabled, object keys longer than the inline limit are
+ * stored once per document and shared by every member using them, which
+ * both saves memory on arrays of records and lets lookups compare keys by
+ * pointer.
+ */
+class NT_EXPORT NtJSONDocument
+{
+public:
+    /**
+     * \brief Constructor
+     *
+     * Default constructor.
+     */
+    NtJSONDocument() { }
+
+    NtJSONDocument(NtJSONDocument&&) = default;
+    NtJSONDocument& operator=(NtJSONDocument&&) = default;
+
+    NT_DISABLE_COPY(NtJSONDocument)
+
+    /**
+     * \brief Parse document
+     *
+     * Parse a JSON text, replacing the current contents. Any JSON value is
+     * accepted as the root. Throws NtSyntaxError on invalid input.
+     *
+     * \param data Data buffer
+     * \param len Length of data
+     */
+    void parse(const char* data, size_t len);
+
+    /**
+     * \brief Parse document
+     *
+     * Parse a JSON text from a string view.
+     *
+     * \param json JSON text
+     */
+    void parse(std::string_view json) { parse(json.data(), json.size()); }
+
+    /**
+     * \brief Parse file
+     *
+     * Map a JSON file into memory and parse it, replacing the current
+     * contents. The document keeps the mapping until it is cleared, and
+     * strings without escapes point into it instead of being copied.
+     * Throws NtRuntimeException if the file cannot be mapped and
+     * NtSyntaxError on invalid input.
+     *
+     * \param path File path
+     */
+    void parseFile(const char* path);
+
+    /**
+     * \brief Set key interning
+     *
+     * Share the storage of repeated object keys. Takes effect on the next
+     * parse.
+     *
+     * \param isInterningKeys True to intern keys
+     */
+    void setInternKeys(bool isInterningKeys) { m_isInterningKeys = isInterningKeys; }
+
+    /**
+     * \brief Is interning keys
+     *
+     * Check whether object keys are interned.
+     *
+     * \return True if interning keys
+     */
+    bool isInterningKeys() const { return m_isInterningKeys; }
+
+    /**
+     * \brief Has interned keys
+     *
+     * Check whether the current contents were parsed with key interning,
+     * which may differ from isInterningKeys() if it was changed since.
+     *
+     * \return True if keys are interned
+     */
+    bool hasInternedKeys() const { return m_hasInternedKeys; }
+
+    /**
+     * \brief Find interned key
+     *
+     * Get the shared storage of a key. Keys are only interned when they are
+     * longer than NtJSONNode::ms_inlineSize.
+     *
+     * \param name Key
+     * \return Interned key data, nullptr if no member uses the key
+     */
+    const char* internedKey(std::string_view name) const
+    {
+        auto it = m_keys.find(name);
+        return it == m_keys.end() ? nullptr : it->data();
+    }
+
+    /**
+     * \brief Clear document
+     *
+     * Release all nodes and strings.
+     */
+    void clear();
+
+    /**
+     * \brief Get indexer kernel
+     *
+     * Get the name of the structural indexer selected for this CPU.
+     *
+     * \return "avx2", "sse2" or "scalar"
+     */
+    static const char* indexerKernel();
+
+    /**
+     * \brief Get root
+     *
+     * Get the root value of the document.
+     *
+     * \return Root value, invalid if the document is empty
+     */
+    NtJSONValue root() const { return m_nodes.empty() ? NtJSONValue() : NtJSONValue(this, 0); }
+
+    /**
+     * \brief Get node
+     *
+     * Get a node by index.
+     *
+     * \param index Node index
+     * \return Node
+     */
+    const NtJSONNode& node(uint32_t index) const { return m_nodes[index]; }
+
+    /**
+     * \brief Get node count
+     *
+     * Get the number of nodes in the document.
+     *
+     * \return Number of nodes
+     */
+    size_t nodeCount() const { return m_nodes.size(); }
+
+    /**
+     * \brief Skip node
+     *
+     * Get the index of the node following a node and its subtree.
+     *
+     * \param index Node index
+     * \return Index after the subtree
+     */
+    uint32_t skip(uint32_t index) const
+    {
+        const NtJSONNode& n = m_nodes[index];
+
+        if (n.type == static_cast<uint8_t>(NtJSONElement::Type::OBJECT) ||
+                n.type == static_cast<uint8_t>(NtJSONElement::Type::ARRAY))
+            return static_cast<uint32_t>(n.next);
+
+        return index + 1;
+    }
+
+    /**
+     * \brief Get memory usage
+     *
+     * Get the number of bytes held by the document, not counting a mapped
+     * file.
+     *
+     * \return Memory usage
+     */
+    size_t memoryUsage() const
+    {
+        return m_nodes.capacity() * sizeof(NtJSONNode) + m_structurals.capacity() * sizeof(uint32_t) +
+            m_arena.reserved() + m_keys.bucket_count() * sizeof(void*) +
+            m_keys.size() * (sizeof(std::string_view) + 2 * sizeof(void*));
+    }
+
+    /**
+     * \brief Get arena
+     *
+     * Get the arena holding the document's strings.
+     *
+     * \return Arena
+     */
+    NtArena& arena() { return m_arena; }
+
+    /**
+     * \brief Get nodes
+     *
+     * Get the node array for building documents.
+     *
+     * \return Node array
+     */
+    std::vector<NtJSONNode>& nodes() { return m_nodes; }
+
+private:
+    friend class NtJSONDocumentParser;
+
+    /**
+     * Arena block size
+     */
+    static constexpr size_t ms_arenaBlockSize = 64 * 1024;
+
+    /**
+     * Nodes in document order
+     */
+    std::vector<NtJSONNode> m_nodes;
+
+    /**
+     * String arena
+     */
+    NtArena m_arena;
+
+    /**
+     * Structural index of the last parse, kept to reuse its capacity
+     */
+    std::vector<uint32_t> m_structurals;
+
+    /**
+     * Mapped file the nodes may point into
+     */
+    NtMappedFile m_file;
+
+    /**
+     * Interned keys, pointing into the arena or the mapped file
+     */
+    std::unordered_set<std::string_view> m_keys;
+
+    /**
+     * Intern object keys
+     */
+    bool m_isInterningKeys{ false };
+
+    /**
+     * Were the current contents parsed with interned keys
+     */
+    bool m_hasInternedKeys{ false };
+};
+
+}
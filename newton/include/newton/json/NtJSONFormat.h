@@ -0,0 +1,112 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtJSONFormat.h
+ * \brief JSON wire formats
+ * \author Hákon Hjaltalín
+ *
+ * This file contains the wire formats the element model can be exchanged
+ * in, with media type negotiation for HTTP.
+ */
+
+#include "newton/json/NtJSONDocument.h"
+
+#include <string>
+#include <string_view>
+
+namespace newton
+{
+
+/**
+ * \enum NtJSONFormat
+ * \brief Wire format
+ *
+ * This enum specifies an encoding of the JSON element model.
+ */
+enum class NtJSONFormat
+{
+    JSON,           ///< JSON text
+    MESSAGEPACK,    ///< MessagePack
+    CBOR            ///< CBOR (RFC 8949)
+};
+
+/**
+ * \fn NtJSONContentType
+ * \brief Get media type
+ *
+ * Get the media type sent in Content-Type for a format.
+ *
+ * \param format Wire format
+ * \return Media type
+ */
+const char* NtJSONContentType(NtJSONFormat format);
+
+/**
+ * \fn NtJSONFormatFromContentType
+ * \brief Get format of media type
+ *
+ * Get the format of a Content-Type value. Parameters such as charset are
+ * ignored and unknown media types are treated as JSON.
+ *
+ * \param contentType Content-Type value
+ * \return Wire format
+ */
+NtJSONFormat NtJSONFormatFromContentType(std::string_view contentType);
+
+/**
+ * \fn NtNegotiateJSONFormat
+ * \brief Negotiate format
+ *
+ * Pick the format for a response from an Accept header value. The media
+ * range with the highest quality wins, with JSON preferred on ties and
+ * when nothing supported is acceptable.
+ *
+ * \param accept Accept value
+ * \return Wire format
+ */
+NtJSONFormat NtNegotiateJSONFormat(std::string_view accept);
+
+/**
+ * \fn NtEncodeJSON
+ * \brief Encode element tree
+ *
+ * Encode an element tree in a format.
+ *
+ * \param element Root element
+ * \param format Wire format
+ * \return Encoded data
+ */
+std::string NtEncodeJSON(const NtJSONElement* element, NtJSONFormat format);
+
+/**
+ * \fn NtEncodeJSON
+ * \brief Encode document value
+ *
+ * Encode a document value in a format.
+ *
+ * \param value Document value
+ * \param format Wire format
+ * \return Encoded data
+ */
+std::string NtEncodeJSON(const NtJSONValue& value, NtJSONFormat format);
+
+/**
+ * \fn NtDecodeJSON
+ * \brief Decode document
+ *
+ * Decode data in a format into a document, replacing its contents.
+ * Throws NtSyntaxError on invalid data.
+ *
+ * \param data Data buffer
+ * \param len Length of data
+ * \param format Wire format
+ * \param doc Document to fill
+ */
+void NtDecodeJSON(const char* data, size_t len, NtJSONFormat format, NtJSONDocument& doc);
+
+}
@@ -15,7 +15,7 @@
 
 #include "newton/json/NtJSONElement.h"
 #include <string>
-#include <sstream>
+#include <type_traits>
 
 namespace newton
 {
@@ -24,11 +24,23 @@ namespace newton
  * \class NtJSONNumber
  * \brief JSON number class
  *
- * This class defines a JSON number.
+ * This class defines a JSON number. Integers are kept as 64-bit integers
+ * rather than doubles so large identifiers survive a round trip.
  */
 class NT_EXPORT NtJSONNumber : public NtJSONElement
 {
 public:
+    /**
+     * \enum Kind
+     * \brief Number representation
+     */
+    enum class Kind : uint8_t
+    {
+        INTEGER,    ///< Signed 64-bit integer
+        UNSIGNED,   ///< Unsigned 64-bit integer above INT64_MAX
+        DOUBLE      ///< Double precision floating point
+    };
+
     /**
      * \brief Constructor
      *
@@ -37,8 +49,23 @@ public:
      * \param value Numeric value
      */
     NtJSONNumber(const double value = 0.0)
-        : NtJSONElement(Type::NUMBER), m_value{ value }
+        : NtJSONElement(Type::NUMBER), m_kind{ Kind::DOUBLE }, m_double{ value }
+    {
+    }
+
+    /**
+     * \brief Constructor from integer
+     *
+     * Constructor from an integer value, kept exact.
+     *
+     * \tparam T Integer type
+     * \param value Integer value
+     */
+    template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    NtJSONNumber(const T value)
+        : NtJSONElement(Type::NUMBER)
     {
+        setValue(value);
     }
 
     /**
@@ -51,7 +78,7 @@ public:
     NtJSONNumber(const char* value)
         : NtJSONElement(Type::NUMBER)
     {
-        m_value = atof(value);
+        setValue(value);
     }
 
     /**
@@ -62,19 +89,16 @@ public:
     /**
      * \brief Set string value
      *
-     * Set string value.
+     * Set value from JSON number text. Invalid text sets zero.
      *
      * \param value Value to set
      */
-    void setValue(const char* value)
-    {
-        m_value = atof(value);
-    }
+    void setValue(const char* value);
 
     /**
      * \brief Set numeric value
      *
-     * Set numeric value.
+     * Set numeric value. Integer types keep an integer representation.
      *
      * \tparam T Numeric type
      * \param value Value to set
@@ -82,22 +106,32 @@ public:
     template <typename T>
     void setValue(const T value)
     {
-        m_value = static_cast<double>(value);
+        if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+            m_kind = Kind::INTEGER;
+            m_int = static_cast<int64_t>(value);
+        } else if constexpr (std::is_integral<T>::value) {
+            if (static_cast<uint64_t>(value) > static_cast<uint64_t>(INT64_MAX)) {
+                m_kind = Kind::UNSIGNED;
+                m_uint = static_cast<uint64_t>(value);
+            } else {
+                m_kind = Kind::INTEGER;
+                m_int = static_cast<int64_t>(value);
+            }
+        } else {
+            m_kind = Kind::DOUBLE;
+            m_double = static_cast<double>(value);
+        }
     }
 
     /**
      * \brief Convert to string
      *
-     * Convert numeric value to string and return.
+     * Convert numeric value to string and return. Doubles are written in
+     * their shortest round-trip form.
      *
      * \return String value
      */
-    std::string toString() const
-    {
-        std::stringstream ss;
-        ss << m_value;
-        return ss.str();
-    }
+    std::string toString() const;
 
     /**
      * \brief Get numeric value
@@ -106,14 +140,89 @@ public:
      *
      * \return Numeric value
      */
-    double value() const { return m_value; }
+    double value() const
+    {
+        switch (m_kind) {
+        case Kind::INTEGER:
+            return static_cast<double>(m_int);
+        case Kind::UNSIGNED:
+            return static_cast<double>(m_uint);
+        default:
+            return m_double;
+        }
+    }
+
+    /**
+     * \brief Get signed integer value
+     *
+     * Get the value as a signed integer. Doubles are truncated.
+     *
+     * \return Integer value
+     */
+    int64_t toInt64() const
+    {
+        switch (m_kind) {
+        case Kind::INTEGER:
+            return m_int;
+        case Kind::UNSIGNED:
+            return static_cast<int64_t>(m_uint);
+        default:
+            return static_cast<int64_t>(m_double);
+        }
+    }
+
+    /**
+     * \brief Get unsigned integer value
+     *
+     * Get the value as an unsigned integer. Doubles are truncated.
+     *
+     * \return Integer value
+     */
+    uint64_t toUInt64() const
+    {
+        switch (m_kind) {
+        case Kind::INTEGER:
+            return static_cast<uint64_t>(m_int);
+        case Kind::UNSIGNED:
+            return m_uint;
+        default:
+            return static_cast<uint64_t>(m_double);
+        }
+    }
+
+    /**
+     * \brief Get representation
+     *
+     * Get how the number is stored.
+     *
+     * \return Number kind
+     */
+    Kind kind() const { return m_kind; }
+
+    /**
+     * \brief Is integer
+     *
+     * Check whether the number is stored as an integer.
+     *
+     * \return True if integer
+     */
+    bool isInteger() const { return m_kind != Kind::DOUBLE; }
 
 private:
+    /**
+     * Number representation
+     */
+    Kind m_kind;
+
     /**
      * Numeric value
      */
-    double m_value;
+    union
+    {
+        int64_t m_int;
+        uint64_t m_uint;
+        double m_double;
+    };
 };
 
 }
-
@@ -14,8 +14,11 @@
  */
 
 #include "newton/json/NtJSONElement.h"
-#include <map>
+#include <functional>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace newton
 {
@@ -24,11 +27,24 @@ namespace newton
  * \class NtJSONObject
  * \brief JSON object class
  *
- * This class defines a JSON object.
+ * This class defines a JSON object. Members are kept in insertion order in
+ * a flat array. Small objects are searched linearly; once an object grows
+ * past ms_indexThreshold members a hash index of member positions is
+ * built alongside the array.
  */
 class NT_EXPORT NtJSONObject : public NtJSONElement
 {
 public:
+    /**
+     * Member name and value
+     */
+    using Member = std::pair<std::string, NtJSONElement*>;
+
+    /**
+     * Member count above which lookups use a hash index
+     */
+    static constexpr size_t ms_indexThreshold = 16;
+
     /**
      * \brief Constructor
      *
@@ -47,14 +63,26 @@ public:
     /**
      * \brief Add element
      *
-     * Add an element to this object.
+     * Add an element to this object. If a member with the same name
+     * exists, the object is left unchanged.
      *
      * \param name Name of element
      * \param value Element value
      */
     void add(const std::string& name, NtJSONElement* value)
     {
-        m_members.insert({ name, value });
+        if (find(name) != npos)
+            return;
+
+        m_members.emplace_back(name, value);
+
+        if (m_members.size() <= ms_indexThreshold)
+            return;
+
+        if (m_members.size() * 2 > m_index.size())
+            rebuildIndex();
+        else
+            insertIndex(m_members.size() - 1);
     }
 
     /**
@@ -64,23 +92,38 @@ public:
      *
      * \param name Name of element
      */
-    void remove(const std::string& name)
+    void remove(std::string_view name)
     {
-        auto it = m_members.find(name);
-        if (it != m_members.end())
-            m_members.erase(it);
+        size_t idx = find(name);
+
+        if (idx == npos)
+            return;
+
+        m_members.erase(m_members.begin() + idx);
+        rebuildIndex();
     }
 
+    /**
+     * \brief Reserve members
+     *
+     * Reserve space for a number of members.
+     *
+     * \param count Number of members
+     */
+    void reserve(size_t count) { m_members.reserve(count); }
+
     /**
      * \brief Access element
      *
      * Get element by name string
      *
      * \param name Element name
+     * \return Element, nullptr if not found
      */
-    NtJSONElement* get(const std::string& name)
+    NtJSONElement* get(std::string_view name) const
     {
-        return m_members[name];
+        size_t idx = find(name);
+        return idx == npos ? nullptr : m_members[idx].second;
     }
 
     /**
@@ -89,10 +132,11 @@ public:
      * Access member at string index
      *
      * \param name Name to access
+     * \return Element, nullptr if not found
      */
-    NtJSONElement* operator[](const char* name)
+    NtJSONElement* operator[](const char* name) const
     {
-        return m_members[name];
+        return get(name);
     }
 
     /**
@@ -104,12 +148,113 @@ public:
      */
     size_t count() const { return m_members.size(); }
 
+    /**
+     * \brief Begin iterator
+     *
+     * Get an iterator to the first member.
+     *
+     * \return Member iterator
+     */
+    auto begin() const { return m_members.begin(); }
+
+    /**
+     * \brief End iterator
+     *
+     * Get an iterator past the last member.
+     *
+     * \return Member iterator
+     */
+    auto end() const { return m_members.end(); }
+
+private:
+    /**
+     * Not found position
+     */
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    /**
+     * \brief Find member
+     *
+     * Find the position of a member.
+     *
+     * \param name Member name
+     * \return Member position, npos if not found
+     */
+    size_t find(std::string_view name) const
+    {
+        if (m_index.empty()) {
+            for (size_t i = 0; i < m_members.size(); ++i) {
+                if (m_members[i].first == name)
+                    return i;
+            }
+
+            return npos;
+        }
+
+        size_t mask = m_index.size() - 1;
+
+        for (size_t slot = std::hash<std::string_view>()(name) & mask; m_index[slot]; slot = (slot + 1) & mask) {
+            uint32_t idx = m_index[slot] - 1;
+
+            if (m_members[idx].first == name)
+                return idx;
+        }
+
+        return npos;
+    }
+
+    /**
+     * \brief Insert into index
+     *
+     * Add a member position to the hash index.
+     *
+     * \param idx Member position
+     */
+    void insertIndex(size_t idx)
+    {
+        size_t mask = m_index.size() - 1;
+        size_t slot = std::hash<std::string_view>()(m_members[idx].first) & mask;
+
+        while (m_index[slot])
+            slot = (slot + 1) & mask;
+
+        m_index[slot] = static_cast<uint32_t>(idx + 1);
+    }
+
+    /**
+     * \brief Rebuild index
+     *
+     * Rebuild the hash index with room for the current members, or drop it
+     * if the object is small.
+     */
+    void rebuildIndex()
+    {
+        m_index.clear();
+
+        if (m_members.size() <= ms_indexThreshold)
+            return;
+
+        size_t size = 64;
+
+        while (size < m_members.size() * 4)
+            size *= 2;
+
+        m_index.assign(size, 0);
+
+        for (size_t i = 0; i < m_members.size(); ++i)
+            insertIndex(i);
+    }
+
 private:
     /**
-     * Members map
+     * Members in insertion order
      */
-    std::map<std::string, NtJSONElement*> m_members;
+    std::vector<Member> m_members;
+
+    /**
+     * Open addressing table of member positions plus one, zero when empty
+     */
+    std::vector<uint32_t> m_index;
 };
 
 }
-
@@ -20,10 +20,60 @@
 #include "newton/json/NtJSONBoolean.h"
 #include "newton/json/NtJSONNull.h"
 
+#include <string_view>
+
 namespace newton
 {
 
+/**
+ * \fn NtParseJSON
+ * \brief Parse a JSON document
+ *
+ * Parse a null-terminated JSON document.
+ *
+ * \param json JSON string
+ * \return Root JSON object
+ */
 NtJSONObject* NtParseJSON(const char* json);
 
+/**
+ * \fn NtParseJSON
+ * \brief Parse a JSON document from a buffer
+ *
+ * Parse a JSON document in place without copying the input. The buffer
+ * does not need to be null-terminated and may contain embedded NULs
+ * inside strings, so request bodies can be parsed straight from the
+ * receive buffer.
+ *
+ * \param data Data buffer
+ * \param len Length of data
+ * \return Root JSON object
+ */
+NtJSONObject* NtParseJSON(const char* data, size_t len);
+
+/**
+ * \fn NtParseJSON
+ * \brief Parse a JSON document from a string view
+ *
+ * Parse a JSON document in place without copying the input.
+ *
+ * \param json JSON string view
+ * \return Root JSON object
+ */
+NtJSONObject* NtParseJSON(std::string_view json);
+
+/**
+ * \fn NtParseJSONFile
+ * \brief Parse a JSON file
+ *
+ * Map a JSON file into memory and parse it in place, without reading it
+ * into a buffer first. Throws NtRuntimeException if the file cannot be
+ * mapped.
+ *
+ * \param path File path
+ * \return Root JSON object
+ */
+NtJSONObject* NtParseJSONFile(const char* path);
+
 }
 
@@ -0,0 +1,291 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtJSONReader.h
+ * \brief Streaming JSON reader
+ * \author Hákon Hjaltalín
+ *
+ * This file contains an event-based JSON reader that accepts its input in
+ * chunks of any size.
+ */
+
+#include "newton/base/NtDefs.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace newton
+{
+
+/**
+ * \class NtJSONHandler
+ * \brief JSON event handler
+ *
+ * Receives the events of an NtJSONReader. Every callback returns true to
+ * continue reading or false to stop. String views are only valid for the
+ * duration of the call. Integers that fit in 64 bits are reported through
+ * integer() and uinteger(), which fall back to number() by default.
+ */
+class NT_EXPORT NtJSONHandler
+{
+public:
+    virtual ~NtJSONHandler() { }
+
+    virtual bool startObject() { return true; }
+    virtual bool endObject() { return true; }
+    virtual bool startArray() { return true; }
+    virtual bool endArray() { return true; }
+    virtual bool key(std::string_view /* name */) { return true; }
+    virtual bool string(std::string_view /* value */) { return true; }
+    virtual bool number(double /* value */) { return true; }
+    virtual bool integer(int64_t value) { return number(static_cast<double>(value)); }
+    virtual bool uinteger(uint64_t value) { return number(static_cast<double>(value)); }
+    virtual bool boolean(bool /* value */) { return true; }
+    virtual bool null() { return true; }
+};
+
+/**
+ * \class NtJSONReader
+ * \brief Streaming JSON reader
+ *
+ * Resumable JSON parser driven by feed(). Input may be split anywhere,
+ * including inside strings, numbers and escape sequences. The reader only
+ * keeps the container stack and the token being read, which is limited by
+ * setMaxTokenSize(), so memory does not grow with the size of the
+ * document. Throws NtSyntaxError on invalid
+ * input.
+ */
+class NT_EXPORT NtJSONReader
+{
+public:
+    /**
+     * \brief Constructor
+     *
+     * Construct a reader delivering events to a handler.
+     *
+     * \param handler Event handler
+     */
+    explicit NtJSONReader(NtJSONHandler* handler);
+
+    NT_DISABLE_COPY(NtJSONReader)
+
+    /**
+     * \brief Set maximum depth
+     *
+     * Set how deeply containers may be nested before reading fails.
+     *
+     * \param depth Maximum depth
+     */
+    void setMaxDepth(size_t depth) { m_maxDepth = depth; }
+
+    /**
+     * \brief Get maximum depth
+     *
+     * Get the maximum nesting depth.
+     *
+     * \return Maximum depth
+     */
+    size_t maxDepth() const { return m_maxDepth; }
+
+    /**
+     * \brief Set maximum token size
+     *
+     * Set how many bytes a single string or number may take once decoded
+     * before reading fails. This bounds the memory the reader uses.
+     *
+     * \param size Maximum token size in bytes
+     */
+    void setMaxTokenSize(size_t size) { m_maxTokenSize = size; }
+
+    /**
+     * \brief Get maximum token size
+     *
+     * Get the maximum size of a string or number.
+     *
+     * \return Maximum token size in bytes
+     */
+    size_t maxTokenSize() const { return m_maxTokenSize; }
+
+    /**
+     * \brief Set multiple values
+     *
+     * Allow a sequence of root values, as in newline-delimited JSON,
+     * instead of a single one. A string, number or literal must be
+     * followed by whitespace before the next value.
+     *
+     * \param isMultiple True to allow multiple values
+     */
+    void setMultipleValues(bool isMultiple) { m_isMultiple = isMultiple; }
+
+    /**
+     * \brief Feed input
+     *
+     * Read the next chunk of input.
+     *
+     * \param data Chunk data
+     * \param len Length of chunk
+     * \return False if the handler stopped reading
+     */
+    bool feed(const char* data, size_t len);
+
+    /**
+     * \brief Feed input
+     *
+     * Read the next chunk of input.
+     *
+     * \param chunk Chunk data
+     * \return False if the handler stopped reading
+     */
+    bool feed(std::string_view chunk) { return feed(chunk.data(), chunk.size()); }
+
+    /**
+     * \brief Finish input
+     *
+     * Signal the end of input and check that the text was complete. The
+     * reader is reset and can be used again.
+     *
+     * \return False if the handler stopped reading
+     */
+    bool finish();
+
+    /**
+     * \brief Reset reader
+     *
+     * Discard all state and start over.
+     */
+    void reset();
+
+    /**
+     * \brief Get depth
+     *
+     * Get the current nesting depth.
+     *
+     * \return Depth
+     */
+    size_t depth() const { return m_stack.size(); }
+
+private:
+    /**
+     * \enum State
+     * \brief Reader state
+     */
+    enum class State
+    {
+        VALUE,
+        ARRAY_FIRST,
+        OBJECT_FIRST,
+        KEY,
+        COLON,
+        AFTER_VALUE,
+        STRING,
+        NUMBER,
+        LITERAL,
+        DONE
+    };
+
+    [[noreturn]] void error(const char* msg) const;
+
+    bool startValue(char c);
+    bool endValue(bool isScalar = false);
+    void checkTokenSize() const;
+    bool endString();
+    bool endNumber();
+    void escape(char c);
+    void appendCodePoint(uint32_t cp);
+    void flushSurrogate();
+
+private:
+    /**
+     * Event handler
+     */
+    NtJSONHandler* m_handler;
+
+    /**
+     * Current state
+     */
+    State m_state{ State::VALUE };
+
+    /**
+     * Open containers, '{' or '['
+     */
+    std::vector<char> m_stack;
+
+    /**
+     * Current string or number
+     */
+    std::string m_token;
+
+    /**
+     * Start of the unescaped run in the current string that is not yet
+     * validated as UTF-8
+     */
+    size_t m_runStart{ std::string::npos };
+
+    /**
+     * Literal being matched
+     */
+    const char* m_literal{ nullptr };
+
+    /**
+     * Characters of the literal matched so far
+     */
+    size_t m_literalPos{ 0 };
+
+    /**
+     * Escape state: 0 none, 1 after backslash, 2-5 reading hex digits
+     */
+    int m_escape{ 0 };
+
+    /**
+     * Hex escape value
+     */
+    uint32_t m_hex{ 0 };
+
+    /**
+     * High surrogate waiting for its pair
+     */
+    uint32_t m_highSurrogate{ 0 };
+
+    /**
+     * Is the current string a member name
+     */
+    bool m_isKey{ false };
+
+    /**
+     * Maximum nesting depth
+     */
+    size_t m_maxDepth{ 512 };
+
+    /**
+     * Maximum size of a string or number
+     */
+    size_t m_maxTokenSize{ 16 * 1024 * 1024 };
+
+    /**
+     * Allow multiple root values
+     */
+    bool m_isMultiple{ false };
+
+    /**
+     * Has a root scalar ended without whitespace after it
+     */
+    bool m_needsSeparator{ false };
+
+    /**
+     * Has the handler stopped reading
+     */
+    bool m_isStopped{ false };
+
+    /**
+     * Current line
+     */
+    int m_line{ 1 };
+};
+
+}
@@ -0,0 +1,165 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtJSONSelector.h
+ * \brief JSON Pointer and path selectors
+ * \author Hákon Hjaltalín
+ *
+ * This file contains precompiled selectors for JSON Pointer and a subset
+ * of JSONPath.
+ */
+
+#include "newton/json/NtJSONCursor.h"
+#include "newton/json/NtJSONDocument.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace newton
+{
+
+/**
+ * \class NtJSONSelector
+ * \brief Precompiled JSON selector
+ *
+ * Selector compiled once from a JSON Pointer (RFC 6901) or a JSONPath
+ * expression and evaluated many times. Expressions starting with '$' are
+ * JSONPath, anything else is a JSON Pointer.
+ *
+ * The JSONPath subset covers the root '$', member access with '.name' or
+ * ['name'], array indices [n], wildcards '.*' and [*], and recursive
+ * descent '..name'. Filters and slices are not supported.
+ *
+ * Selectors run on element trees, documents and cursors. On a cursor only
+ * the members and elements on the selected paths are decoded, the other
+ * subtrees are skipped over in the raw text.
+ */
+class NT_EXPORT NtJSONSelector
+{
+public:
+    /**
+     * \struct Step
+     * \brief Selector step
+     */
+    struct Step
+    {
+        /**
+         * \enum Kind
+         * \brief Step kind
+         */
+        enum class Kind
+        {
+            MEMBER,     ///< Object member by name
+            INDEX,      ///< Array element by index
+            TOKEN,      ///< JSON Pointer token, a member or an array index
+            WILDCARD,   ///< All members or elements
+            DESCENDANT  ///< Members with a name at any depth
+        };
+
+        Kind kind;          ///< Step kind
+        std::string name;   ///< Member name
+        size_t index;       ///< Array index, npos if the token is no index
+    };
+
+    /**
+     * Invalid index
+     */
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    /**
+     * \brief Constructor
+     *
+     * Compile a selector. Throws NtSyntaxError on an invalid expression.
+     *
+     * \param expr JSON Pointer or JSONPath expression
+     */
+    explicit NtJSONSelector(std::string_view expr);
+
+    /**
+     * \brief Select from element tree
+     *
+     * Get all values matched by the selector.
+     *
+     * \param root Root element
+     * \return Matched elements
+     */
+    std::vector<NtJSONElement*> select(NtJSONElement* root) const;
+
+    /**
+     * \brief Select from document
+     *
+     * Get all values matched by the selector.
+     *
+     * \param root Root value
+     * \return Matched values
+     */
+    std::vector<NtJSONValue> select(const NtJSONValue& root) const;
+
+    /**
+     * \brief Select from cursor
+     *
+     * Get all values matched by the selector.
+     *
+     * \param root Root value
+     * \return Matched values
+     */
+    std::vector<NtJSONCursor> select(const NtJSONCursor& root) const;
+
+    /**
+     * \brief Select first from element tree
+     *
+     * Get the first value matched by the selector, stopping the search
+     * there.
+     *
+     * \param root Root element
+     * \return First match, nullptr if none
+     */
+    NtJSONElement* first(NtJSONElement* root) const;
+
+    /**
+     * \brief Select first from document
+     *
+     * Get the first value matched by the selector.
+     *
+     * \param root Root value
+     * \return First match, invalid if none
+     */
+    NtJSONValue first(const NtJSONValue& root) const;
+
+    /**
+     * \brief Select first from cursor
+     *
+     * Get the first value matched by the selector.
+     *
+     * \param root Root value
+     * \return First match, invalid if none
+     */
+    NtJSONCursor first(const NtJSONCursor& root) const;
+
+    /**
+     * \brief Get steps
+     *
+     * Get the compiled steps.
+     *
+     * \return Selector steps
+     */
+    const std::vector<Step>& steps() const { return m_steps; }
+
+private:
+    void compilePointer(std::string_view expr);
+    void compilePath(std::string_view expr);
+
+private:
+    /**
+     * Compiled steps
+     */
+    std::vector<Step> m_steps;
+};
+
+}
@@ -0,0 +1,230 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtJSONWriter.h
+ * \brief JSON writer
+ * \author Hákon Hjaltalín
+ *
+ * This file contains a JSON serializer writing into a growable buffer.
+ */
+
+#include "newton/json/NtJSONReader.h"
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace newton
+{
+
+class NtJSONElement;
+class NtJSONValue;
+
+/**
+ * \class NtJSONWriter
+ * \brief JSON writer
+ *
+ * Serializes JSON into an internal buffer. Values are written with the same
+ * calls an NtJSONHandler receives, so a writer can be handed straight to an
+ * NtJSONReader to reformat a stream. Whole element trees and documents can
+ * be written with write().
+ *
+ * When a sink is set, the buffer is handed to it and reused every time it
+ * grows past the flush threshold, so large output can go straight to a
+ * socket without being held in memory.
+ */
+class NT_EXPORT NtJSONWriter : public NtJSONHandler
+{
+public:
+    /**
+     * Sink receiving serialized output
+     */
+    using NtJSONSink = std::function<void(const char* data, size_t len)>;
+
+    /**
+     * \brief Constructor
+     *
+     * Default constructor.
+     */
+    NtJSONWriter() { }
+
+    NT_DISABLE_COPY(NtJSONWriter)
+
+    /**
+     * \brief Set pretty printing
+     *
+     * Put every element and member on its own line.
+     *
+     * \param isPretty True to pretty print
+     * \param indent Spaces per level
+     */
+    void setPretty(bool isPretty, int indent = 4)
+    {
+        m_isPretty = isPretty;
+        m_indent = indent;
+    }
+
+    /**
+     * \brief Set sink
+     *
+     * Set a sink receiving output whenever the buffer reaches a threshold.
+     *
+     * \param sink Output sink
+     * \param threshold Flush threshold in bytes
+     */
+    void setSink(NtJSONSink sink, size_t threshold = 16 * 1024)
+    {
+        m_sink = std::move(sink);
+        m_threshold = threshold;
+    }
+
+    bool startObject() override;
+    bool endObject() override;
+    bool startArray() override;
+    bool endArray() override;
+    bool key(std::string_view name) override;
+    bool string(std::string_view value) override;
+    bool number(double value) override;
+    bool boolean(bool value) override;
+    bool null() override;
+
+    bool integer(int64_t value) override;
+    bool uinteger(uint64_t value) override;
+
+    /**
+     * \brief Write element
+     *
+     * Write an element tree.
+     *
+     * \param element Root element
+     */
+    void write(const NtJSONElement* element);
+
+    /**
+     * \brief Write document value
+     *
+     * Write a document value and its children.
+     *
+     * \param value Document value
+     */
+    void write(const NtJSONValue& value);
+
+    /**
+     * \brief Write raw JSON
+     *
+     * Write text that is already valid JSON as a value.
+     *
+     * \param json JSON text
+     */
+    void raw(std::string_view json);
+
+    /**
+     * \brief Flush output
+     *
+     * Hand all buffered output to the sink.
+     */
+    void flush();
+
+    /**
+     * \brief Get buffer
+     *
+     * Get the output that has not been flushed.
+     *
+     * \return Buffered output
+     */
+    std::string_view buffer() const { return m_buffer; }
+
+    /**
+     * \brief Take buffer
+     *
+     * Move the buffered output out of the writer and reset it.
+     *
+     * \return Buffered output
+     */
+    std::string take();
+
+    /**
+     * \brief Reset writer
+     *
+     * Discard buffered output and nesting state.
+     */
+    void reset();
+
+private:
+    void beginValue();
+    void newline();
+    void escape(std::string_view str);
+    void checkFlush()
+    {
+        if (m_sink && m_buffer.size() >= m_threshold)
+            flush();
+    }
+
+private:
+    /**
+     * Output buffer
+     */
+    std::string m_buffer;
+
+    /**
+     * Element count of each open container
+     */
+    std::vector<size_t> m_counts;
+
+    /**
+     * Was the last token a member name
+     */
+    bool m_isAfterKey{ false };
+
+    /**
+     * Pretty print
+     */
+    bool m_isPretty{ false };
+
+    /**
+     * Spaces per indent level
+     */
+    int m_indent{ 4 };
+
+    /**
+     * Output sink
+     */
+    NtJSONSink m_sink;
+
+    /**
+     * Flush threshold
+     */
+    size_t m_threshold{ 16 * 1024 };
+};
+
+/**
+ * \fn NtSerializeJSON
+ * \brief Serialize element tree
+ *
+ * Serialize an element tree to a string.
+ *
+ * \param element Root element
+ * \param isPretty Pretty print
+ * \return JSON text
+ */
+std::string NtSerializeJSON(const NtJSONElement* element, bool isPretty = false);
+
+/**
+ * \fn NtSerializeJSON
+ * \brief Serialize document value
+ *
+ * Serialize a document value to a string.
+ *
+ * \param value Document value
+ * \param isPretty Pretty print
+ * \return JSON text
+ */
+std::string NtSerializeJSON(const NtJSONValue& value, bool isPretty = false);
+
+}
@@ -0,0 +1,236 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtNDJSONParser.h
+ * \brief Newline-delimited JSON parser
+ * \author Hákon Hjaltalín
+ *
+ * This file contains a parser for newline-delimited JSON that parses
+ * records in parallel on a thread pool.
+ */
+
+#include "newton/core/NtThreadPool.h"
+#include "newton/json/NtJSONDocument.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace newton
+{
+
+/**
+ * \class NtNDJSONParser
+ * \brief Parallel NDJSON parser
+ *
+ * Parses newline-delimited JSON, one value per line. Input is fed in chunks
+ * of any size and cut into batches at line boundaries; every full batch is
+ * parsed into documents by a task on the thread pool while more input is
+ * read. Records are handed back in input order, blank lines are skipped.
+ *
+ * A record that fails to parse throws NtSyntaxError when it is reached, and
+ * the records after it can still be read. Completed batches are held until
+ * they are read, so long streams should be drained between feeds.
+ */
+class NT_EXPORT NtNDJSONParser
+{
+public:
+    /**
+     * \class Iterator
+     * \brief Record iterator
+     *
+     * Input iterator over the records that are fed so far.
+     */
+    class NT_EXPORT Iterator
+    {
+    public:
+        Iterator(NtNDJSONParser* parser)
+            : m_parser{ parser }
+        {
+            if (m_parser && !m_parser->next(m_doc))
+                m_parser = nullptr;
+        }
+
+        NtJSONDocument& operator*() { return m_doc; }
+        NtJSONDocument* operator->() { return &m_doc; }
+
+        Iterator& operator++()
+        {
+            if (!m_parser->next(m_doc))
+                m_parser = nullptr;
+
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const { return m_parser == other.m_parser; }
+        bool operator!=(const Iterator& other) const { return m_parser != other.m_parser; }
+
+    private:
+        NtNDJSONParser* m_parser;
+        NtJSONDocument m_doc;
+    };
+
+    /**
+     * \brief Constructor
+     *
+     * Construct a parser running on a thread pool.
+     *
+     * \param pool Thread pool
+     * \param batchSize Approximate number of bytes parsed per task
+     */
+    explicit NtNDJSONParser(NtThreadPool& pool, size_t batchSize = 256 * 1024);
+
+    NT_DISABLE_COPY(NtNDJSONParser)
+    NT_DISABLE_MOVE(NtNDJSONParser)
+
+    /**
+     * \brief Destructor
+     *
+     * Wait for batches still being parsed.
+     */
+    ~NtNDJSONParser();
+
+    /**
+     * \brief Feed input
+     *
+     * Add a chunk of input. Chunks may split records anywhere.
+     *
+     * \param data Data buffer
+     * \param len Length of data
+     */
+    void feed(const char* data, size_t len);
+
+    /**
+     * \brief Feed input
+     *
+     * Add a chunk of input from a string view.
+     *
+     * \param data Input chunk
+     */
+    void feed(std::string_view data) { feed(data.data(), data.size()); }
+
+    /**
+     * \brief Finish input
+     *
+     * Mark the end of input, submitting the last record even if it is not
+     * followed by a newline.
+     */
+    void finish();
+
+    /**
+     * \brief Next record
+     *
+     * Get the next record in input order, waiting for its batch to be
+     * parsed. Input is submitted once a batch fills up or finish() is
+     * called; records still pending are not returned.
+     *
+     * \param doc Document receiving the record
+     * \return False if no submitted record is left
+     */
+    bool next(NtJSONDocument& doc);
+
+    /**
+     * \brief Get record count
+     *
+     * Get the number of records returned or thrown by next() so far.
+     *
+     * \return Number of records
+     */
+    size_t recordCount() const { return m_recordCount; }
+
+    Iterator begin() { return Iterator(this); }
+    Iterator end() { return Iterator(nullptr); }
+
+private:
+    /**
+     * \struct NtNDJSONRecord
+     * \brief Parsed record
+     */
+    struct NtNDJSONRecord
+    {
+        NtJSONDocument doc;
+        std::exception_ptr error;
+    };
+
+    /**
+     * \struct NtNDJSONBatch
+     * \brief Batch of records
+     */
+    struct NtNDJSONBatch
+    {
+        std::string text;
+        std::vector<NtNDJSONRecord> records;
+        size_t position{ 0 };
+        bool isDone{ false };
+    };
+
+    void submit(std::string text);
+    void parseBatch(NtNDJSONBatch* batch);
+
+private:
+    /**
+     * Thread pool
+     */
+    NtThreadPool& m_pool;
+
+    /**
+     * Batch size in bytes
+     */
+    size_t m_batchSize;
+
+    /**
+     * Input not yet submitted
+     */
+    std::string m_pending;
+
+    /**
+     * Submitted batches in input order
+     */
+    std::deque<std::unique_ptr<NtNDJSONBatch>> m_batches;
+
+    /**
+     * Batch lock
+     */
+    std::mutex m_lock;
+
+    /**
+     * Signalled when a batch is done
+     */
+    std::condition_variable m_doneCond;
+
+    /**
+     * Number of batches being parsed
+     */
+    size_t m_running{ 0 };
+
+    /**
+     * Number of records read
+     */
+    size_t m_recordCount{ 0 };
+};
+
+/**
+ * \fn NtParseNDJSON
+ * \brief Parse NDJSON text
+ *
+ * Parse a whole newline-delimited JSON text on a thread pool. Throws
+ * NtSyntaxError for the first invalid record.
+ *
+ * \param data Data buffer
+ * \param len Length of data
+ * \param pool Thread pool
+ * \return Documents in input order
+ */
+std::vector<NtJSONDocument> NtParseNDJSON(const char* data, size_t len, NtThreadPool& pool);
+
+}
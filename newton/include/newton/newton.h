@@ -17,9 +17,26 @@
 
 #include "newton/base/NtLogger.h"
 #include "newton/base/NtException.h"
+#include "newton/base/NtMappedFile.h"
+#include "newton/base/NtAllocTracker.h"
 #include "newton/string/NtString.h"
 #include "newton/core/NtApplication.h"
 #include "newton/core/NtServer.h"
+#include "newton/core/NtCoroutine.h"
+#include "newton/core/NtThreadPool.h"
+#include "newton/core/NtMetricsRoute.h"
 #include "newton/json/NtJSONParser.h"
+#include "newton/json/NtJSONDocument.h"
+#include "newton/json/NtJSONCursor.h"
+#include "newton/json/NtJSONReader.h"
+#include "newton/json/NtJSONWriter.h"
+#include "newton/json/NtJSONBinding.h"
+#include "newton/json/NtNDJSONParser.h"
+#include "newton/json/NtJSONSelector.h"
+#include "newton/json/NtJSONBuilder.h"
+#include "newton/json/NtMessagePack.h"
+#include "newton/json/NtCBOR.h"
+#include "newton/json/NtJSONFormat.h"
 #include "newton/http/NtHTTPRequest.h"
+#include "newton/http/NtHTTPResponse.h"
 #include "newton/html/NtHTMLParser.h"
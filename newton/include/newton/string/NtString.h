@@ -15,7 +15,9 @@
 
 #include "newton/base/NtDefs.h"
 #include <string>
+#include <string_view>
 #include <algorithm>
+#include <cctype>
 
 namespace newton
 {
@@ -40,6 +42,23 @@ static inline void NtTrim(std::string& s)
     NtRTrim(s);
 }
 
+/**
+ * Compare two strings ignoring ASCII case, as protocol tokens such as
+ * HTTP header names are compared.
+ */
+static inline bool NtEqualsIgnoreCase(std::string_view a, std::string_view b)
+{
+    if (a.size() != b.size())
+        return false;
+
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (tolower(static_cast<unsigned char>(a[i])) != tolower(static_cast<unsigned char>(b[i])))
+            return false;
+    }
+
+    return true;
+}
+
 /**
  * \enum Character encoding
  *
@@ -0,0 +1,102 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+// Replacements of the global operator new and delete feeding the
+// allocation counters. This file is not part of the library; it is linked
+// into the tests and benchmarks with NT_BUILD_ALLOC_TRACKING.
+
+#include "newton/newton.h"
+using namespace newton;
+
+#include <cstdlib>
+#include <new>
+
+/**
+ * Every block carries its size in front, so frees can be counted in bytes
+ * whether or not the sized delete is called.
+ */
+static constexpr size_t NtAllocHeaderSize = alignof(std::max_align_t);
+
+static const struct NtAllocHooks
+{
+    NtAllocHooks() { NtEnableAllocTracking(); }
+} NtAllocHooksInstance;
+
+static void* NtTrackedAlloc(size_t size) noexcept
+{
+    char* ptr = static_cast<char*>(malloc(size + NtAllocHeaderSize));
+
+    if (!ptr)
+        return nullptr;
+
+    memcpy(ptr, &size, sizeof(size));
+    NtTrackAllocation(size);
+    return ptr + NtAllocHeaderSize;
+}
+
+static void NtTrackedFree(void* ptr) noexcept
+{
+    if (!ptr)
+        return;
+
+    char* block = static_cast<char*>(ptr) - NtAllocHeaderSize;
+    size_t size;
+    memcpy(&size, block, sizeof(size));
+    NtTrackDeallocation(size);
+    free(block);
+}
+
+void* operator new(size_t size)
+{
+    if (void* ptr = NtTrackedAlloc(size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return NtTrackedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return NtTrackedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    NtTrackedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    NtTrackedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    NtTrackedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    NtTrackedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    NtTrackedFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    NtTrackedFree(ptr);
+}
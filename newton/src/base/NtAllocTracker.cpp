@@ -0,0 +1,69 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+using namespace newton;
+
+#include <atomic>
+
+// Called from operator new, so nothing here may allocate.
+static std::atomic<bool> NtAllocTrackingEnabled{ false };
+static std::atomic<uint64_t> NtAllocCount{ 0 };
+static std::atomic<uint64_t> NtAllocBytes{ 0 };
+static std::atomic<uint64_t> NtAllocLive{ 0 };
+static std::atomic<uint64_t> NtAllocPeak{ 0 };
+
+bool newton::NtIsAllocTrackingEnabled()
+{
+    return NtAllocTrackingEnabled.load(std::memory_order_relaxed);
+}
+
+void newton::NtEnableAllocTracking()
+{
+    NtAllocTrackingEnabled.store(true, std::memory_order_relaxed);
+}
+
+void newton::NtTrackAllocation(size_t size)
+{
+    NtAllocCount.fetch_add(1, std::memory_order_relaxed);
+    NtAllocBytes.fetch_add(size, std::memory_order_relaxed);
+
+    uint64_t live = NtAllocLive.fetch_add(size, std::memory_order_relaxed) + size;
+    uint64_t peak = NtAllocPeak.load(std::memory_order_relaxed);
+
+    while (live > peak && !NtAllocPeak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+        ;
+}
+
+void newton::NtTrackDeallocation(size_t size)
+{
+    NtAllocLive.fetch_sub(size, std::memory_order_relaxed);
+}
+
+NtAllocStats newton::NtAllocationStats()
+{
+    NtAllocStats ret;
+    ret.count = NtAllocCount.load(std::memory_order_relaxed);
+    ret.bytes = NtAllocBytes.load(std::memory_order_relaxed);
+    ret.peak = NtAllocPeak.load(std::memory_order_relaxed);
+    return ret;
+}
+
+void NtAllocScope::reset()
+{
+    m_live = NtAllocLive.load(std::memory_order_relaxed);
+    NtAllocPeak.store(m_live, std::memory_order_relaxed);
+    m_start = NtAllocationStats();
+}
+
+NtAllocStats NtAllocScope::stats() const
+{
+    NtAllocStats now = NtAllocationStats();
+    NtAllocStats ret;
+    ret.count = now.count - m_start.count;
+    ret.bytes = now.bytes - m_start.bytes;
+    ret.peak = now.peak > m_live ? now.peak - m_live : 0;
+    return ret;
+}
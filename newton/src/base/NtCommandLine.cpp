@@ -6,6 +6,10 @@
 #include "newton/newton.h"
 using namespace newton;
 
+NtCommandLine::~NtCommandLine()
+{
+}
+
 void NtCommandLine::parse(int& argc, char** argv)
 {
     if (argc <= 1) {
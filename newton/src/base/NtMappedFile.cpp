@@ -0,0 +1,128 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+using namespace newton;
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef NT_WINDOWS
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+NtMappedFile::NtMappedFile(NtMappedFile&& other) noexcept
+    : m_data{ other.m_data }, m_size{ other.m_size }, m_isOpen{ other.m_isOpen }
+{
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_isOpen = false;
+}
+
+NtMappedFile& NtMappedFile::operator=(NtMappedFile&& other) noexcept
+{
+    if (this != &other) {
+        close();
+
+        m_data = other.m_data;
+        m_size = other.m_size;
+        m_isOpen = other.m_isOpen;
+
+        other.m_data = nullptr;
+        other.m_size = 0;
+        other.m_isOpen = false;
+    }
+
+    return *this;
+}
+
+void NtMappedFile::open(const char* path)
+{
+    close();
+
+#ifdef NT_WINDOWS
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+        throw NtRuntimeException(std::string("Failed to open file ") + path + ".");
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throw NtRuntimeException(std::string("Failed to read size of file ") + path + ".");
+    }
+
+    if (size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+        if (mapping)
+            CloseHandle(mapping);
+
+        if (!data) {
+            CloseHandle(file);
+            throw NtRuntimeException(std::string("Failed to map file ") + path + ".");
+        }
+
+        m_data = static_cast<const char*>(data);
+        m_size = static_cast<size_t>(size.QuadPart);
+    }
+
+    CloseHandle(file);
+#else
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+        throw NtRuntimeException(std::string("Failed to open file ") + path + ": " + strerror(errno));
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw NtRuntimeException(std::string("Failed to read size of file ") + path + ": " + strerror(errno));
+    }
+
+    if (st.st_size > 0) {
+        void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            throw NtRuntimeException(std::string("Failed to map file ") + path + ": " + strerror(errno));
+        }
+
+        madvise(data, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+        m_data = static_cast<const char*>(data);
+        m_size = static_cast<size_t>(st.st_size);
+    }
+
+    // The mapping keeps the file referenced after the descriptor is closed.
+    ::close(fd);
+#endif
+
+    m_isOpen = true;
+}
+
+void NtMappedFile::close()
+{
+    if (m_data) {
+#ifdef NT_WINDOWS
+        UnmapViewOfFile(m_data);
+#else
+        munmap(const_cast<char*>(m_data), m_size);
+#endif
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+    m_isOpen = false;
+}
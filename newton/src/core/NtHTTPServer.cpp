@@ -7,35 +7,206 @@
 using namespace newton;
 
 #include <iostream>
+#include <memory>
+
+/**
+ * \struct NtPendingRequest
+ * \brief Pending request state
+ *
+ * State shared between a dispatched request and its completion callback.
+ */
+struct NtPendingRequest
+{
+    NtContext* ctxPtr;
+    uint64_t generation;
+    NtHTTPRequest* req;
+    std::atomic<bool> isCompleted{ false };
+    bool isDispatching{ true };
+    bool isDone{ false };
+    bool result{ true };
+};
+
+/**
+ * Response to requests that cannot be framed, after which the connection
+ * is closed.
+ */
+static const char NtBadRequestResponse[] =
+    "HTTP/1.1 400 Bad Request\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
 
 bool NtHTTPServer::onRequest(NtContext* ctxPtr)
 {
-    NtHTTPRequest* req = NtParseHTTPRequest(ctxPtr->recvBuffer, ctxPtr->dataLen);
+    // One 503 answers whatever the client has sent so far, and the
+    // connection is closed rather than framing the rest of its input.
+    if (isShedding()) {
+        count(NT_COUNTER_SHED_REQUESTS);
+        ctxPtr->pendingInput.clear();
+        sendData(ctxPtr, m_overloadResponse.data(), m_overloadResponse.size());
+        return false;
+    }
+
+    ctxPtr->pendingInput.append(ctxPtr->recvBuffer, ctxPtr->readLen);
+
+    if (ctxPtr->pendingInput.size() > m_maxRequestSize) {
+        count(NT_COUNTER_PARSE_ERRORS);
+        return false;
+    }
+
+    return processRequests(ctxPtr);
+}
+
+bool NtHTTPServer::processRequests(NtContext* ctxPtr)
+{
+    // Pipelined requests are answered in order, so the next one is not
+    // parsed before the client is resumed by the previous response.
+    while (!ctxPtr->isSuspended) {
+        std::string& input = ctxPtr->pendingInput;
+        size_t len = 0;
+
+        try {
+            len = NtHTTPMessageLength(input.data(), input.size());
+        } catch (const NtSyntaxError&) {
+            // The rest of the input cannot be taken apart into requests.
+            count(NT_COUNTER_PARSE_ERRORS);
+            input.clear();
+            sendData(ctxPtr, NtBadRequestResponse, sizeof(NtBadRequestResponse) - 1);
+            return false;
+        }
+
+        if (!len)
+            return true;
 
+        NtHTTPRequest* req = NtParseHTTPRequest(&input[0], len);
+        input.erase(0, len);
+        count(NT_COUNTER_REQUESTS);
+
+        if (req->version() == NtHTTPVersion::HTTP_VERSION_UNKNOWN)
+            count(NT_COUNTER_PARSE_ERRORS);
+
+        if (!dispatchRequest(ctxPtr, req))
+            return false;
+    }
+
+    return true;
+}
+
+bool NtHTTPServer::dispatchRequest(NtContext* ctxPtr, NtHTTPRequest* req)
+{
     if (!req)
         return false;
 
+    NtHTTPHeader* acceptHdr = req->getHeader("Accept");
+
+    if (acceptHdr)
+        req->setResponseFormat(NtNegotiateJSONFormat(acceptHdr->value()));
+
+    NtVirtualHost* vhost = findHost(req);
+
+    if (!vhost) {
+        delete req;
+        return false;
+    }
+
+    if (!suspendClient(ctxPtr)) {
+        delete req;
+        return false;
+    }
+
+    auto pending = std::make_shared<NtPendingRequest>();
+    pending->ctxPtr = ctxPtr;
+    pending->generation = ctxPtr->generation;
+    pending->req = req;
+
+    NtResponseCallback done = [this, pending](NtHTTPResponse* resp) {
+        if (pending->isCompleted.exchange(true)) {
+            delete resp;
+            return;
+        }
+
+        if (isReactorThread() && pending->isDispatching) {
+            pending->isDone = true;
+            pending->result = completeRequest(pending->ctxPtr, pending->generation, pending->req, resp);
+            return;
+        }
+
+        // A failed wakeup leaves the task queued for the next one and the
+        // error recorded by post(). The client belongs to the reactor, so it
+        // is never torn down from here.
+        post([this, pending, resp]() {
+            NtContext* ctxPtr = pending->ctxPtr;
+
+            if (!completeRequest(ctxPtr, pending->generation, pending->req, resp)
+                    || (ctxPtr->generation == pending->generation && !processRequests(ctxPtr)))
+                terminateClient(ctxPtr);
+        });
+    };
+
+    NtRoute* route = vhost->findRoute(req->requestURI());
+
+    if (route && route->isOffload()) {
+        if (!m_offloadPool)
+            m_offloadPool = std::make_unique<NtThreadPool>(m_offloadThreads);
+
+        auto queuedAt = std::chrono::steady_clock::now();
+
+        m_offloadPool->submit([this, route, req, done, queuedAt]() {
+            recordQueueDelay(std::chrono::steady_clock::now() - queuedAt);
+
+            try {
+                route->handleRequestAsync(req, done);
+            } catch (...) {
+                done(nullptr);
+            }
+        });
+    } else {
+        vhost->handleRequestAsync(req, std::move(done));
+    }
+
+    pending->isDispatching = false;
+
+    if (pending->isDone)
+        return pending->result;
+
+    return true;
+}
+
+NtVirtualHost* NtHTTPServer::findHost(NtHTTPRequest* req)
+{
     std::string host = m_defaultHost;
     NtHTTPHeader* hostHdr = req->getHeader("Host");
-    NtHTTPResponse* resp = nullptr;
-    
+
     if (hostHdr)
         host = hostHdr->value();
 
-    if (m_hosts.find(host) != m_hosts.end()) {
-        if (m_hosts[host]) {
-            resp = m_hosts[host]->handleRequest(req);
-        }
+    auto it = m_hosts.find(host);
+
+    if (it != m_hosts.end())
+        return it->second;
+
+    return nullptr;
+}
+
+bool NtHTTPServer::completeRequest(NtContext* ctxPtr, uint64_t generation, NtHTTPRequest* req,
+        NtHTTPResponse* resp)
+{
+    delete req;
+
+    if (ctxPtr->generation != generation) {
+        delete resp;
+        return true;
     }
 
     if (!resp)
         return false;
 
     std::string ret = resp->toString();
+    delete resp;
+
+    if (!resumeClient(ctxPtr))
+        return false;
 
     if (!sendData(ctxPtr, ret.c_str(), ret.size())) {
         return false;
     }
-    
+
     return true;
 }
@@ -0,0 +1,29 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+using namespace newton;
+
+NtServerMetrics NtMetricsRoute::metrics() const
+{
+    NtServerMetrics ret;
+
+    for (auto* server : m_servers)
+        ret.merge(server->metrics());
+
+    return ret;
+}
+
+NtHTTPResponse* NtMetricsRoute::handleRequest(NtHTTPRequest*)
+{
+    std::string text = metrics().toPrometheus();
+
+    NtHTTPResponse* resp = new NtHTTPResponse("HTTP/1.1 200 OK");
+    resp->addHeader(new NtHTTPHeader("Content-Type", "text/plain; version=0.0.4; charset=utf-8"));
+    resp->addHeader(new NtHTTPHeader("Content-Length", std::to_string(text.size())));
+    resp->setBody(text);
+
+    return resp;
+}
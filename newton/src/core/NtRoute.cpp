@@ -15,10 +15,7 @@ NtHTTPResponse* NtRoute::handleRequest(NtHTTPRequest* req)
 {
     NtHTTPResponse* resp = new NtHTTPResponse("HTTP/1.1 200 OK");
     resp->addHeader(new NtHTTPHeader("Content-Length", "5"));
-    
-    char* body = new char[6];
-    strcpy(body, "hello");
-    resp->setBody(body);
+    resp->setBody("hello");
 
     return resp;
 }
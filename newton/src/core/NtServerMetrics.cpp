@@ -0,0 +1,105 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+using namespace newton;
+
+#include <algorithm>
+#include <cstdio>
+
+/**
+ * Prometheus names and help text, in NtServerCounter order.
+ */
+static const char* NtServerCounterInfo[NT_COUNTER_COUNT][2] = {
+    { "newton_accepts_total", "Connections accepted." },
+    { "newton_rejects_total", "Connections closed on accept because the server was overloaded." },
+    { "newton_requests_total", "Requests received." },
+    { "newton_shed_requests_total", "Requests answered with 503 because the server was overloaded." },
+    { "newton_parse_errors_total", "Requests that are malformed, cannot be framed or are over the size limit." },
+    { "newton_bytes_in_total", "Bytes received from clients." },
+    { "newton_bytes_out_total", "Bytes sent to clients." },
+    { "newton_send_eagain_total", "Sends that would have blocked and were queued." },
+    { "newton_context_cache_hits_total", "Client contexts reused from the cache." },
+    { "newton_context_cache_misses_total", "Client contexts allocated." },
+};
+
+static void NtAppendMetric(std::string& out, const char* name, const char* help, const char* type,
+        const char* value)
+{
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+    out += name;
+    out += ' ';
+    out += value;
+    out += '\n';
+}
+
+static void NtAppendCounter(std::string& out, const char* name, const char* help, uint64_t value)
+{
+    NtAppendMetric(out, name, help, "counter", std::to_string(value).c_str());
+}
+
+static void NtAppendGauge(std::string& out, const char* name, const char* help, uint64_t value)
+{
+    NtAppendMetric(out, name, help, "gauge", std::to_string(value).c_str());
+}
+
+static void NtAppendSeconds(std::string& out, const char* name, const char* help, uint64_t us)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.6f", us / 1e6);
+    NtAppendMetric(out, name, help, "gauge", buf);
+}
+
+NtServerMetrics NtServer::metrics() const
+{
+    NtServerMetrics ret;
+
+    for (size_t i = 0; i < NT_COUNTER_COUNT; ++i)
+        ret.counters[i] = m_counters.get(static_cast<NtServerCounter>(i));
+
+    ret.connections = static_cast<uint64_t>(std::max(m_numClients.load(), 0));
+    ret.pendingSendBytes = m_globalPendingSendBytes.load();
+    ret.loopLagUs = m_loopLagUs.load();
+    ret.queueDelayUs = m_queueDelayUs.load();
+
+    return ret;
+}
+
+void NtServerMetrics::merge(const NtServerMetrics& other)
+{
+    for (size_t i = 0; i < NT_COUNTER_COUNT; ++i)
+        counters[i] += other.counters[i];
+
+    connections += other.connections;
+    pendingSendBytes += other.pendingSendBytes;
+    loopLagUs = std::max(loopLagUs, other.loopLagUs);
+    queueDelayUs = std::max(queueDelayUs, other.queueDelayUs);
+}
+
+std::string NtServerMetrics::toPrometheus() const
+{
+    std::string ret;
+
+    for (size_t i = 0; i < NT_COUNTER_COUNT; ++i)
+        NtAppendCounter(ret, NtServerCounterInfo[i][0], NtServerCounterInfo[i][1], counters[i]);
+
+    NtAppendGauge(ret, "newton_connections", "Connected clients.", connections);
+    NtAppendGauge(ret, "newton_pending_send_bytes", "Bytes queued for sending across all clients.",
+            pendingSendBytes);
+    NtAppendSeconds(ret, "newton_loop_lag_seconds", "Smoothed time the reactor spends on a batch of events.",
+            loopLagUs);
+    NtAppendSeconds(ret, "newton_queue_delay_seconds", "Smoothed time tasks spend queued before they run.",
+            queueDelayUs);
+
+    return ret;
+}
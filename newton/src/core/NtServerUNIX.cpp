@@ -8,6 +8,28 @@ using namespace newton;
 
 #include <iostream>
 
+#ifndef NT_APPLE
+#  include <sys/eventfd.h>
+#endif
+
+static void NtUpdateAverage(std::atomic<uint64_t>& average, uint64_t sample)
+{
+    uint64_t current = average.load(std::memory_order_relaxed);
+    uint64_t next = 0;
+
+    do {
+        next = current - current / 8 + sample / 8;
+    } while (!average.compare_exchange_weak(current, next, std::memory_order_relaxed));
+}
+
+static void NtDecayAverage(std::atomic<uint64_t>& average)
+{
+    uint64_t current = average.load(std::memory_order_relaxed);
+
+    while (!average.compare_exchange_weak(current, current / 2, std::memory_order_relaxed))
+        ;
+}
+
 NtServer::NtServer()
     : m_connected{ false }
 {
@@ -34,12 +56,10 @@ bool NtServer::sendData(NtContext* ctxPtr, const char* buf, size_t len)
         }
 
         ctxPtr->pendingSendDeque.push_back(pendingSent);
+        trackPendingSend(ctxPtr, len);
 
-#ifdef NT_APPLE
-        if (!controlKq(ctxPtr, EVFILT_WRITE, EV_ADD | EV_ENABLE)) {
-#else
-        if (!controlEpoll(ctxPtr, EPOLLIN | EPOLLOUT | EPOLLERR | EPOLLRDHUP, EPOLL_CTL_MOD)) {
-#endif
+        if (!updateClientEvents(ctxPtr)) {
+            untrackPendingSend(ctxPtr, len);
             delete[] pendingSent.pendingSentData;
             ctxPtr->pendingSendDeque.pop_back();
             return false;
@@ -61,8 +81,11 @@ bool NtServer::sendData(NtContext* ctxPtr, const char* buf, size_t len)
         if (sentLen > 0) {
             totalSent += sentLen;
             dataPositionPtr += sentLen;
+            count(NT_COUNTER_BYTES_OUT, sentLen);
         } else if (sentLen < 0) {
             if (errno == EWOULDBLOCK || errno == EAGAIN) {
+                count(NT_COUNTER_SEND_EAGAIN);
+
                 NtPendingSent pendingSent;
                 pendingSent.pendingSentData = new char[len - totalSent];
                 pendingSent.pendingSentLen = len - totalSent;
@@ -73,18 +96,17 @@ bool NtServer::sendData(NtContext* ctxPtr, const char* buf, size_t len)
                             &ctxPtr->udpRemoteAddr, sizeof(pendingSent.udpRemoteAddr));
                 }
                 ctxPtr->pendingSendDeque.push_back(pendingSent);
+                ctxPtr->isSentPending = true;
+                trackPendingSend(ctxPtr, pendingSent.pendingSentLen);
 
-#ifdef NT_APPLE
-                if (!controlKq(ctxPtr, EVFILT_WRITE, EV_ADD | EV_ENABLE) {
-#else
-                if (!controlEpoll(ctxPtr, EPOLLIN | EPOLLOUT | EPOLLERR | EPOLLRDHUP, EPOLL_CTL_MOD)) {
-#endif
+                if (!updateClientEvents(ctxPtr)) {
+                    untrackPendingSend(ctxPtr, pendingSent.pendingSentLen);
                     delete[] pendingSent.pendingSentData;
                     ctxPtr->pendingSendDeque.pop_back();
+                    ctxPtr->isSentPending = false;
                     return false;
                 }
 
-                ctxPtr->isSentPending = true;
                 return true;
             } else if (errno != EINTR) {
                 std::lock_guard<std::mutex> lock(m_errMsgLock);
@@ -118,6 +140,133 @@ bool NtServer::setSocketNonBlocking(int fd)
     return true;
 }
 
+bool NtServer::post(std::function<void()> task)
+{
+    if (m_wakeWriteFd < 0) {
+        std::lock_guard<std::mutex> lock(m_errMsgLock);
+        m_errMsg = "server is not running.";
+        return false;
+    }
+
+    m_postedTasks.push({ std::move(task), std::chrono::steady_clock::now() });
+
+    if (m_isWakePending.exchange(true, std::memory_order_acq_rel))
+        return true;
+
+    uint64_t value = 1;
+
+    if (write(m_wakeWriteFd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+        m_isWakePending = false;
+
+        std::lock_guard<std::mutex> lock(m_errMsgLock);
+        m_errMsg = "wakeup write error: " + std::string(strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+bool NtServer::suspendClient(NtContext* ctxPtr)
+{
+    if (ctxPtr->isSuspended)
+        return true;
+
+    ctxPtr->isSuspended = true;
+    return updateClientEvents(ctxPtr);
+}
+
+bool NtServer::resumeClient(NtContext* ctxPtr)
+{
+    if (!ctxPtr->isSuspended)
+        return true;
+
+    ctxPtr->isSuspended = false;
+    return updateClientEvents(ctxPtr);
+}
+
+bool NtServer::updateClientEvents(NtContext* ctxPtr)
+{
+#ifdef NT_APPLE
+    bool isReading = !ctxPtr->isSuspended && !ctxPtr->isReadPaused;
+
+    if (!controlKq(ctxPtr, EVFILT_READ, isReading ? EV_ADD | EV_ENABLE : EV_DISABLE))
+        return false;
+
+    return controlKq(ctxPtr, EVFILT_WRITE, ctxPtr->isSentPending ? EV_ADD | EV_ENABLE : EV_DISABLE);
+#else
+    uint32_t events = EPOLLERR | EPOLLRDHUP;
+
+    if (!ctxPtr->isSuspended && !ctxPtr->isReadPaused)
+        events |= EPOLLIN;
+
+    if (ctxPtr->isSentPending)
+        events |= EPOLLOUT;
+
+    return controlEpoll(ctxPtr, events, EPOLL_CTL_MOD);
+#endif
+}
+
+void NtServer::trackPendingSend(NtContext* ctxPtr, size_t len)
+{
+    ctxPtr->pendingSendBytes += len;
+    size_t globalPending = m_globalPendingSendBytes.fetch_add(len) + len;
+
+    if (ctxPtr->isReadPaused)
+        return;
+
+    if (ctxPtr->pendingSendBytes > m_sendHighWaterMark || globalPending > m_globalSendHighWaterMark)
+        pauseReading(ctxPtr);
+}
+
+void NtServer::pauseReading(NtContext* ctxPtr)
+{
+    ctxPtr->isReadPaused = true;
+
+    std::lock_guard<std::mutex> lock(m_pausedClientsLock);
+    m_pausedClients.push_back({ ctxPtr, ctxPtr->generation });
+}
+
+void NtServer::untrackPendingSend(NtContext* ctxPtr, size_t len)
+{
+    ctxPtr->pendingSendBytes -= len;
+    m_globalPendingSendBytes -= len;
+}
+
+void NtServer::relieveSendPressure(NtContext* ctxPtr)
+{
+    if (m_globalPendingSendBytes > m_globalSendLowWaterMark)
+        return;
+
+    if (ctxPtr && ctxPtr->isReadPaused && ctxPtr->pendingSendBytes <= m_sendLowWaterMark) {
+        ctxPtr->isReadPaused = false;
+        updateClientEvents(ctxPtr);
+        onWritable(ctxPtr);
+    }
+
+    std::vector<std::pair<NtContext*, uint64_t>> paused;
+
+    {
+        std::lock_guard<std::mutex> lock(m_pausedClientsLock);
+        std::swap(paused, m_pausedClients);
+    }
+
+    for (auto& p : paused) {
+        NtContext* pausedCtxPtr = p.first;
+
+        if (pausedCtxPtr->generation != p.second || !pausedCtxPtr->isReadPaused)
+            continue;
+
+        if (pausedCtxPtr->pendingSendBytes <= m_sendLowWaterMark) {
+            pausedCtxPtr->isReadPaused = false;
+            updateClientEvents(pausedCtxPtr);
+            onWritable(pausedCtxPtr);
+        } else {
+            std::lock_guard<std::mutex> lock(m_pausedClientsLock);
+            m_pausedClients.push_back(p);
+        }
+    }
+}
+
 bool NtServer::onRequest(NtContext* ctxPtr)
 {
     std::cerr << "onRequest handler unimplemented." << std::endl;
@@ -149,7 +298,7 @@ bool NtServer::initTCPServer(const char* bindIP, int bindPort, size_t maxClients
     m_port = bindPort;
     m_maxClients = maxClients;
 
-    if (maxClients < 0)
+    if (maxClients == 0)
         return false;
 
     return runServer();
@@ -256,6 +405,24 @@ bool NtServer::runServer()
 
     if (!controlKq(m_listenContextPtr, EVFILT_READ, EV_ADD))
         return false;
+
+    int wakeFds[2];
+
+    if (pipe(wakeFds) < 0) {
+        std::lock_guard<std::mutex> lock(m_errMsgLock);
+        m_errMsg = "wakeup pipe error: " + std::string(strerror(errno));
+        return false;
+    }
+
+    if (!setSocketNonBlocking(wakeFds[0]) || !setSocketNonBlocking(wakeFds[1]))
+        return false;
+
+    m_wakeContextPtr = new NtContext();
+    m_wakeContextPtr->socket = wakeFds[0];
+    m_wakeWriteFd = wakeFds[1];
+
+    if (!controlKq(m_wakeContextPtr, EVFILT_READ, EV_ADD))
+        return false;
 #else
     m_epFd = epoll_create1(0);
 
@@ -267,14 +434,29 @@ bool NtServer::runServer()
 
     if (!controlEpoll(m_listenContextPtr, EPOLLIN | EPOLLERR, EPOLL_CTL_ADD))
         return false;
+
+    int wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (wakeFd < 0) {
+        std::lock_guard<std::mutex> lock(m_errMsgLock);
+        m_errMsg = "eventfd error: " + std::string(strerror(errno));
+        return false;
+    }
+
+    m_wakeContextPtr = new NtContext();
+    m_wakeContextPtr->socket = wakeFd;
+    m_wakeWriteFd = wakeFd;
+
+    if (!controlEpoll(m_wakeContextPtr, EPOLLIN | EPOLLERR, EPOLL_CTL_ADD))
+        return false;
 #endif
 
 #ifdef NT_APPLE
-    m_kqEventsPtr = new struct kevent[m_maxClients];
-    memset(m_kqEventsPtr, 0, sizeof(struct kevent) * m_maxClients);
+    m_kqEventsPtr = new struct kevent[ms_eventBatchSize];
+    memset(m_kqEventsPtr, 0, sizeof(struct kevent) * ms_eventBatchSize);
 #else
-    m_epEvents = new struct epoll_event[m_maxClients];
-    memset(m_epEvents, 0, sizeof(struct epoll_event) * m_maxClients);
+    m_epEvents = new struct epoll_event[ms_eventBatchSize];
+    memset(m_epEvents, 0, sizeof(struct epoll_event) * ms_eventBatchSize);
 #endif
 
     m_needServerRun = true;
@@ -298,9 +480,13 @@ void NtServer::serverThreadHandler()
     ts.tv_nsec = 0;
 #endif
 
+    m_reactorThreadId = std::this_thread::get_id();
+
     while (m_needServerRun) {
+        auto waitStart = std::chrono::steady_clock::now();
+
 #ifdef NT_APPLE
-        int eventCnt = kevent(m_kqFd, NULL, 0, m_kqEventsPtr, m_maxClients, &ts);
+        int eventCnt = kevent(m_kqFd, NULL, 0, m_kqEventsPtr, ms_eventBatchSize, &ts);
 
         if (eventCnt < 0) {
             std::lock_guard<std::mutex> lock(m_errMsgLock);
@@ -309,7 +495,7 @@ void NtServer::serverThreadHandler()
             return;
         }
 #else
-        int eventCnt = epoll_wait(m_epFd, m_epEvents, m_maxClients, 1000);
+        int eventCnt = epoll_wait(m_epFd, m_epEvents, ms_eventBatchSize, 1000);
 
         if (eventCnt < 0) {
             std::lock_guard<std::mutex> lock(m_errMsgLock);
@@ -319,6 +505,17 @@ void NtServer::serverThreadHandler()
         }
 #endif
 
+        auto batchStart = std::chrono::steady_clock::now();
+
+        if (batchStart - waitStart >= std::chrono::milliseconds(1)) {
+            NtDecayAverage(m_loopLagUs);
+            NtDecayAverage(m_queueDelayUs);
+        }
+
+        // Tasks left queued by a failed wakeup run on the next idle timeout.
+        if (eventCnt == 0)
+            runPostedTasks();
+
         for (int i = 0; i < eventCnt; ++i) {
 #ifdef NT_APPLE
             if (m_kqEventsPtr[i].ident == m_listenSocket) {
@@ -329,6 +526,12 @@ void NtServer::serverThreadHandler()
                     std::cerr << "accept error: " << m_errMsg << std::endl;
                     return;
                 }
+#ifdef NT_APPLE
+            } else if (m_kqEventsPtr[i].udata == m_wakeContextPtr) {
+#else
+            } else if (m_epEvents[i].data.ptr == m_wakeContextPtr) {
+#endif
+                runPostedTasks();
             } else {
 #ifdef NT_APPLE
                 NtContext* ctxPtr = (NtContext*)m_kqEventsPtr[i].udata;
@@ -357,6 +560,9 @@ void NtServer::serverThreadHandler()
                 }
             }
         }
+
+        auto batchTime = std::chrono::steady_clock::now() - batchStart;
+        NtUpdateAverage(m_loopLagUs, std::chrono::duration_cast<std::chrono::microseconds>(batchTime).count());
     }
 
     m_serverRunning = false;
@@ -370,6 +576,15 @@ void NtServer::terminateClient(NtContext* clientCtx, bool force)
 {
     --m_numClients;
 
+    if (m_isListenPaused && static_cast<size_t>(m_numClients) < m_maxClients) {
+#ifdef NT_APPLE
+        if (controlKq(m_listenContextPtr, EVFILT_READ, EV_ENABLE))
+#else
+        if (controlEpoll(m_listenContextPtr, EPOLLIN | EPOLLERR, EPOLL_CTL_MOD))
+#endif
+            m_isListenPaused = false;
+    }
+
     if (force) {
         struct linger linger_struct;
         linger_struct.l_onoff = 1;
@@ -387,6 +602,7 @@ void NtServer::terminateClient(NtContext* clientCtx, bool force)
 
     onDisconnect(clientCtx);
     pushClientContextToCache(clientCtx);
+    relieveSendPressure(nullptr);
 }
 
 bool NtServer::acceptNewClient()
@@ -394,6 +610,20 @@ bool NtServer::acceptNewClient()
     while (1) {
         int clientFd = -1;
 
+        if (static_cast<size_t>(m_numClients) >= m_maxClients) {
+#ifdef NT_APPLE
+            if (!controlKq(m_listenContextPtr, EVFILT_READ, EV_DISABLE)) {
+#else
+            if (!controlEpoll(m_listenContextPtr, EPOLLERR, EPOLL_CTL_MOD)) {
+#endif
+                m_serverRunning = false;
+                return false;
+            }
+
+            m_isListenPaused = true;
+            break;
+        }
+
         if (m_sockUsage == NT_USAGE_IPC_SERVER) {
             sockaddr_un clientAddr;
             socklen_t clientAddrSize = sizeof(clientAddr);
@@ -417,7 +647,18 @@ bool NtServer::acceptNewClient()
             }
         }
 
+        if (isRejecting()) {
+            struct linger lingerStruct;
+            lingerStruct.l_onoff = 1;
+            lingerStruct.l_linger = 0;
+            setsockopt(clientFd, SOL_SOCKET, SO_LINGER, (char*)&lingerStruct, sizeof(lingerStruct));
+            close(clientFd);
+            count(NT_COUNTER_REJECTS);
+            continue;
+        }
+
         ++m_numClients;
+        count(NT_COUNTER_ACCEPTS);
 
         setSocketNonBlocking(clientFd);
         NtContext* clientContextPtr = popClientContextFromCache();
@@ -430,7 +671,6 @@ bool NtServer::acceptNewClient()
         clientContextPtr->socket = clientFd;
         clientContextPtr->isConnected = true;
         clientContextPtr->dataLen = 4096;
-        clientContextPtr->recvBuffer = nullptr;
 
         onConnect(clientContextPtr);
 
@@ -449,14 +689,26 @@ bool NtServer::acceptNewClient()
 
 bool NtServer::recvData(NtContext* ctxPtr)
 {
+    // Leave the request in the socket while too much is queued overall.
+    // The client is resumed with the others once the total drains.
+    if (m_globalPendingSendBytes > m_globalSendHighWaterMark) {
+        std::lock_guard<std::mutex> lock(ctxPtr->ctxLock);
+        pauseReading(ctxPtr);
+        return updateClientEvents(ctxPtr);
+    }
+
     size_t len = ctxPtr->dataLen;
-    ctxPtr->recvBuffer = (char*)malloc(len);
-    memset(ctxPtr->recvBuffer, 0, len + 1);
 
-    int recvdLen = recv(ctxPtr->socket, ctxPtr->recvBuffer, len, 0);
+    // The buffer stays with the context and is reused by later clients.
+    if (!ctxPtr->recvBuffer)
+        ctxPtr->recvBuffer = new char[len + 1];
+
+    ssize_t recvdLen = recv(ctxPtr->socket, ctxPtr->recvBuffer, len, 0);
 
     if (recvdLen > 0) {
+        ctxPtr->recvBuffer[recvdLen] = '\0';
         ctxPtr->readLen = recvdLen;
+        count(NT_COUNTER_BYTES_IN, recvdLen);
         return onRequest(ctxPtr);
     } else {
         std::lock_guard<std::mutex> lock(m_errMsgLock);
@@ -468,6 +720,15 @@ bool NtServer::recvData(NtContext* ctxPtr)
 }
 
 bool NtServer::sendPendingData(NtContext* ctxPtr)
+{
+    if (!flushPendingData(ctxPtr))
+        return false;
+
+    relieveSendPressure(ctxPtr);
+    return true;
+}
+
+bool NtServer::flushPendingData(NtContext* ctxPtr)
 {
     std::lock_guard<std::mutex> guard(ctxPtr->ctxLock);
 
@@ -484,6 +745,9 @@ bool NtServer::sendPendingData(NtContext* ctxPtr)
         }
 
         if (sentLen > 0) {
+            untrackPendingSend(ctxPtr, sentLen);
+            count(NT_COUNTER_BYTES_OUT, sentLen);
+
             if (sentLen == (int)pendingSent.pendingSentLen) {
                 delete[] pendingSent.pendingSentData;
                 ctxPtr->pendingSendDeque.pop_front();
@@ -491,11 +755,7 @@ bool NtServer::sendPendingData(NtContext* ctxPtr)
                 if (ctxPtr->pendingSendDeque.empty()) {
                     ctxPtr->isSentPending = false;
 
-#ifdef NT_APPLE
-                    if (!controlKq(ctxPtr, EVFILT_WRITE, EV_DELETE) || !controlKq(ctxPtr, EVFILT_READ, EV_ADD)) {
-#else
-                    if (!controlEpoll(ctxPtr, EPOLLIN | EPOLLERR | EPOLLRDHUP, EPOLL_CTL_MOD)) {
-#endif
+                    if (!updateClientEvents(ctxPtr)) {
                         m_serverRunning = false;
                         return false;
                     }
@@ -516,6 +776,7 @@ bool NtServer::sendPendingData(NtContext* ctxPtr)
             }
         } else if (sentLen < 0) {
             if (errno == EWOULDBLOCK || errno == EAGAIN) {
+                count(NT_COUNTER_SEND_EAGAIN);
                 break;
             } else if (errno != EINTR) {
                 {
@@ -534,11 +795,13 @@ bool NtServer::sendPendingData(NtContext* ctxPtr)
 
 void NtServer::pushClientContextToCache(NtContext* ctxPtr)
 {
-    ctxPtr->recvBuffer = nullptr;
     ctxPtr->socket = -1;
     ctxPtr->isSentPending = false;
+    ctxPtr->isSuspended = false;
     ctxPtr->isConnected = false;
     ctxPtr->dataLen = 0;
+    ctxPtr->pendingInput.clear();
+    ++ctxPtr->generation;
     
     while (!ctxPtr->pendingSendDeque.empty()) {
         NtPendingSent pendingSent = ctxPtr->pendingSendDeque.front();
@@ -546,6 +809,9 @@ void NtServer::pushClientContextToCache(NtContext* ctxPtr)
         ctxPtr->pendingSendDeque.pop_front();
     }
 
+    untrackPendingSend(ctxPtr, ctxPtr->pendingSendBytes);
+    ctxPtr->isReadPaused = false;
+
     std::lock_guard<std::mutex> lock(m_ctxCacheLock);
     m_queueCtxCache.push(ctxPtr);
 }
@@ -559,10 +825,16 @@ NtContext* NtServer::popClientContextFromCache()
         if (!m_queueCtxCache.empty()) {
             ctxPtr = m_queueCtxCache.front();
             m_queueCtxCache.pop();
-            return ctxPtr;
         }
     }
 
+    if (ctxPtr) {
+        count(NT_COUNTER_CONTEXT_CACHE_HITS);
+        return ctxPtr;
+    }
+
+    count(NT_COUNTER_CONTEXT_CACHE_MISSES);
+
     ctxPtr = new (std::nothrow) NtContext();
 
     if (!ctxPtr) {
@@ -573,3 +845,30 @@ NtContext* NtServer::popClientContextFromCache()
 
     return ctxPtr;
 }
+
+void NtServer::runPostedTasks()
+{
+    uint64_t value = 0;
+
+    while (read(m_wakeContextPtr->socket, &value, sizeof(value)) > 0)
+        ;
+
+    m_isWakePending.exchange(false, std::memory_order_acq_rel);
+
+    NtPostedTask posted;
+
+    if (!m_postedTasks.pop(posted))
+        return;
+
+    recordQueueDelay(std::chrono::steady_clock::now() - posted.postedAt);
+
+    do {
+        posted.task();
+    } while (m_postedTasks.pop(posted));
+}
+
+void NtServer::recordQueueDelay(std::chrono::steady_clock::duration delay)
+{
+    auto delayUs = std::chrono::duration_cast<std::chrono::microseconds>(delay).count();
+    NtUpdateAverage(m_queueDelayUs, delayUs > 0 ? static_cast<uint64_t>(delayUs) : 0);
+}
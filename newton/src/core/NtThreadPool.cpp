@@ -0,0 +1,120 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+using namespace newton;
+
+static thread_local NtThreadPool* s_currentPool{ nullptr };
+static thread_local size_t s_workerIndex{ 0 };
+
+NtThreadPool::NtThreadPool(size_t threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+
+    if (threadCount == 0)
+        threadCount = 1;
+
+    for (size_t i = 0; i < threadCount; ++i)
+        m_queues.push_back(std::make_unique<NtWorkerQueue>());
+
+    for (size_t i = 0; i < threadCount; ++i)
+        m_threads.emplace_back(&NtThreadPool::workerLoop, this, i);
+}
+
+NtThreadPool::~NtThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepLock);
+        m_isRunning = false;
+    }
+
+    m_sleepCond.notify_all();
+
+    for (auto& t : m_threads)
+        t.join();
+}
+
+void NtThreadPool::submit(std::function<void()> task)
+{
+    size_t index = 0;
+
+    if (s_currentPool == this)
+        index = s_workerIndex;
+    else
+        index = m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+    // The count changes under the same lock as the deque, so a stealer can
+    // never pop the task before it is counted.
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->lock);
+        m_queues[index]->tasks.push_back(std::move(task));
+        ++m_pendingTasks;
+    }
+
+    // Taking the sleep lock orders the count before a worker that is about
+    // to wait, so the notification cannot be lost.
+    {
+        std::lock_guard<std::mutex> lock(m_sleepLock);
+    }
+
+    m_sleepCond.notify_one();
+}
+
+bool NtThreadPool::popTask(size_t index, std::function<void()>& task)
+{
+    {
+        NtWorkerQueue& own = *m_queues[index];
+        std::lock_guard<std::mutex> lock(own.lock);
+
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --m_pendingTasks;
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < m_queues.size(); ++i) {
+        NtWorkerQueue& victim = *m_queues[(index + i) % m_queues.size()];
+        std::unique_lock<std::mutex> lock(victim.lock, std::try_to_lock);
+
+        if (lock.owns_lock() && !victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --m_pendingTasks;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void NtThreadPool::workerLoop(size_t index)
+{
+    s_currentPool = this;
+    s_workerIndex = index;
+
+    while (true) {
+        std::function<void()> task;
+
+        if (popTask(index, task)) {
+            try {
+                task();
+            } catch (...) {
+                NtLogger::instance()->log("Uncaught exception in thread pool task.", LOG_ERROR);
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepLock);
+        m_sleepCond.wait(lock, [this]() {
+            return m_pendingTasks > 0 || !m_isRunning;
+        });
+
+        if (!m_isRunning && m_pendingTasks == 0)
+            return;
+    }
+}
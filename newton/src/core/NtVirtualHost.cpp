@@ -10,12 +10,31 @@ using namespace newton;
 
 NtHTTPResponse* NtVirtualHost::handleRequest(NtHTTPRequest* req)
 {
-    std::string uri = req->requestURI();
+    NtRoute* route = findRoute(req->requestURI());
 
+    if (route)
+        return route->handleRequest(req);
+
+    return nullptr;
+}
+
+void NtVirtualHost::handleRequestAsync(NtHTTPRequest* req, NtResponseCallback done)
+{
+    NtRoute* route = findRoute(req->requestURI());
+
+    if (route) {
+        route->handleRequestAsync(req, std::move(done));
+    } else {
+        done(nullptr);
+    }
+}
+
+NtRoute* NtVirtualHost::findRoute(const std::string& path)
+{
     for (auto& r : m_routes) {
         if (r) {
-            if (r->matchPath(uri)) {
-                return r->handleRequest(req);
+            if (r->matchPath(path)) {
+                return r;
             }
         }
     }
@@ -0,0 +1,93 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+using namespace newton;
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Check whether the header line at pos has the given lowercase name.
+ */
+static bool NtIsHeaderName(const char* buf, size_t pos, size_t end, const char* name, size_t nameLen)
+{
+    return end - pos >= nameLen && std::equal(name, name + nameLen, buf + pos,
+        [](char a, char b) { return a == tolower(static_cast<unsigned char>(b)); });
+}
+
+/**
+ * Parse a Content-Length value, which must be a plain decimal number.
+ */
+static size_t NtParseContentLength(const char* buf, size_t pos, size_t end)
+{
+    while (pos < end && (buf[pos] == ' ' || buf[pos] == '\t'))
+        ++pos;
+
+    while (end > pos && (buf[end - 1] == ' ' || buf[end - 1] == '\t'))
+        --end;
+
+    if (pos == end)
+        throw NtSyntaxError("Empty Content-Length.");
+
+    size_t ret = 0;
+
+    for (; pos < end; ++pos) {
+        if (buf[pos] < '0' || buf[pos] > '9')
+            throw NtSyntaxError("Invalid Content-Length.");
+
+        if (ret > (SIZE_MAX - 9) / 10)
+            throw NtSyntaxError("Content-Length is too large.");
+
+        ret = ret * 10 + static_cast<size_t>(buf[pos] - '0');
+    }
+
+    return ret;
+}
+
+size_t newton::NtHTTPMessageLength(const char* buf, size_t len)
+{
+    static const char lengthName[] = "content-length:";
+    static const char encodingName[] = "transfer-encoding:";
+
+    std::string_view text(buf, len);
+    size_t headerEnd = text.find("\r\n\r\n");
+
+    if (headerEnd == std::string_view::npos)
+        return 0;
+
+    size_t bodyLen = 0;
+    bool hasLength = false;
+    size_t pos = text.find("\r\n");
+
+    while (pos < headerEnd) {
+        pos += 2;
+        size_t end = text.find("\r\n", pos);
+
+        // Chunked bodies are not framed, so a message using any transfer
+        // coding cannot be told apart from the one following it.
+        if (NtIsHeaderName(buf, pos, end, encodingName, sizeof(encodingName) - 1))
+            throw NtSyntaxError("Transfer-Encoding is not supported.");
+
+        if (NtIsHeaderName(buf, pos, end, lengthName, sizeof(lengthName) - 1)) {
+            size_t value = NtParseContentLength(buf, pos + sizeof(lengthName) - 1, end);
+
+            if (hasLength && value != bodyLen)
+                throw NtSyntaxError("Conflicting Content-Length headers.");
+
+            bodyLen = value;
+            hasLength = true;
+        }
+
+        pos = end;
+    }
+
+    if (len - headerEnd - 4 < bodyLen)
+        return 0;
+
+    return headerEnd + 4 + bodyLen;
+}
@@ -6,8 +6,25 @@
 #include "newton/newton.h"
 using namespace newton;
 
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 
+NtJSONFormat NtHTTPRequest::bodyFormat() const
+{
+    const NtHTTPHeader* hdr = getHeader("Content-Type");
+
+    if (!hdr)
+        return NtJSONFormat::JSON;
+
+    return NtJSONFormatFromContentType(hdr->value());
+}
+
+void NtHTTPRequest::parseBody(NtJSONDocument& doc) const
+{
+    NtDecodeJSON(m_body.data(), m_body.size(), bodyFormat(), doc);
+}
+
 void NtHTTPRequest::parseRequestLine()
 {
     if (m_startLine == "")
@@ -103,5 +120,12 @@ NtHTTPRequest* newton::NtParseHTTPRequest(char* buf, size_t len)
 
     pos += 2;
 
+    NtHTTPHeader* lenHdr = req->getHeader("Content-Length");
+
+    if (lenHdr && pos < len) {
+        size_t bodyLen = std::min<size_t>(strtoull(lenHdr->value().c_str(), nullptr, 10), len - pos);
+        req->setBody(std::string(buf + pos, bodyLen));
+    }
+
     return req;
 }
@@ -0,0 +1,27 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+using namespace newton;
+
+void NtHTTPResponse::setContentHeaders(NtJSONFormat format)
+{
+    removeHeader("Content-Type");
+    removeHeader("Content-Length");
+    addHeader(new NtHTTPHeader("Content-Type", NtJSONContentType(format)));
+    addHeader(new NtHTTPHeader("Content-Length", std::to_string(m_body.size())));
+}
+
+void NtHTTPResponse::setJSONBody(const NtJSONElement* element, NtJSONFormat format)
+{
+    setBody(NtEncodeJSON(element, format));
+    setContentHeaders(format);
+}
+
+void NtHTTPResponse::setJSONBody(const NtJSONValue& value, NtJSONFormat format)
+{
+    setBody(NtEncodeJSON(value, format));
+    setContentHeaders(format);
+}
@@ -0,0 +1,381 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+#include "NtJSONBinary.h"
+#include "NtUTF8.h"
+using namespace newton;
+
+#include <cmath>
+
+/**
+ * Convert an IEEE 754 half precision value to a double.
+ */
+static double NtHalfToDouble(uint16_t half)
+{
+    int exp = (half >> 10) & 0x1F;
+    int mant = half & 0x3FF;
+    double ret;
+
+    if (exp == 0)
+        ret = std::ldexp(mant, -24);
+    else if (exp != 31)
+        ret = std::ldexp(mant + 1024, exp - 25);
+    else
+        ret = mant == 0 ? INFINITY : NAN;
+
+    return (half & 0x8000) ? -ret : ret;
+}
+
+/**
+ * \class NtCBOREncoder
+ * \brief CBOR encoder
+ */
+class NtCBOREncoder
+{
+public:
+    void nil() { m_out += static_cast<char>(0xF6); }
+    void boolean(bool value) { m_out += static_cast<char>(value ? 0xF5 : 0xF4); }
+
+    void integer(int64_t value)
+    {
+        if (value >= 0)
+            header(0, static_cast<uint64_t>(value));
+        else
+            header(1, ~static_cast<uint64_t>(value));
+    }
+
+    void uinteger(uint64_t value) { header(0, value); }
+
+    void number(double value)
+    {
+        m_out += static_cast<char>(0xFB);
+        NtAppendBigEndian(m_out, NtDoubleBits(value));
+    }
+
+    void string(std::string_view value)
+    {
+        header(3, value.size());
+        m_out.append(value.data(), value.size());
+    }
+
+    void array(size_t count) { header(4, count); }
+    void map(size_t count) { header(5, count); }
+
+    std::string take() { return std::move(m_out); }
+
+private:
+    void header(unsigned char major, uint64_t arg)
+    {
+        major <<= 5;
+
+        if (arg < 24) {
+            m_out += static_cast<char>(major | arg);
+        } else if (arg <= UINT8_MAX) {
+            m_out += static_cast<char>(major | 24);
+            m_out += static_cast<char>(arg);
+        } else if (arg <= UINT16_MAX) {
+            m_out += static_cast<char>(major | 25);
+            NtAppendBigEndian(m_out, static_cast<uint16_t>(arg));
+        } else if (arg <= UINT32_MAX) {
+            m_out += static_cast<char>(major | 26);
+            NtAppendBigEndian(m_out, static_cast<uint32_t>(arg));
+        } else {
+            m_out += static_cast<char>(major | 27);
+            NtAppendBigEndian(m_out, arg);
+        }
+    }
+
+private:
+    std::string m_out;
+};
+
+/**
+ * \class NtCBORDecoder
+ * \brief CBOR decoder
+ */
+class NtCBORDecoder
+{
+public:
+    NtCBORDecoder(const char* data, size_t len, NtJSONHandler* handler)
+        : m_data{ data }, m_len{ len }, m_handler{ handler }
+    {
+    }
+
+    bool decode()
+    {
+        if (!decodeValue(0, false))
+            return false;
+
+        if (m_pos != m_len)
+            error("Unexpected data after CBOR value.");
+
+        return true;
+    }
+
+private:
+    static constexpr uint64_t ms_indefinite = UINT64_MAX;
+
+    [[noreturn]] void error(const char* msg)
+    {
+        throw NtSyntaxError("Offset " + std::to_string(m_pos) + ": " + msg);
+    }
+
+    const char* take(size_t n)
+    {
+        if (m_len - m_pos < n)
+            error("Truncated CBOR data.");
+
+        const char* ret = m_data + m_pos;
+        m_pos += n;
+        return ret;
+    }
+
+    bool isBreak()
+    {
+        if (m_pos >= m_len)
+            error("Truncated CBOR data.");
+
+        if (static_cast<unsigned char>(m_data[m_pos]) != 0xFF)
+            return false;
+
+        ++m_pos;
+        return true;
+    }
+
+    /**
+     * Read the argument of an initial byte, or ms_indefinite for the
+     * indefinite length marker if it is allowed.
+     */
+    uint64_t argument(unsigned char info, bool isIndefiniteAllowed = false)
+    {
+        if (info < 24)
+            return info;
+
+        switch (info) {
+        case 24:
+            return NtLoadBigEndian(take(1), 1);
+        case 25:
+            return NtLoadBigEndian(take(2), 2);
+        case 26:
+            return NtLoadBigEndian(take(4), 4);
+        case 27:
+            {
+                uint64_t ret = NtLoadBigEndian(take(8), 8);
+
+                if (ret == ms_indefinite && isIndefiniteAllowed)
+                    error("CBOR length is too large.");
+
+                return ret;
+            }
+        case 31:
+            if (isIndefiniteAllowed)
+                return ms_indefinite;
+            [[fallthrough]];
+        default:
+            --m_pos;
+            error("Invalid CBOR additional information.");
+        }
+    }
+
+    bool text(unsigned char major, uint64_t len, bool isKey)
+    {
+        std::string_view str;
+        std::string chunks;
+
+        if (len != ms_indefinite) {
+            if (len > m_len - m_pos)
+                error("Truncated CBOR data.");
+
+            str = std::string_view(take(len), len);
+        } else {
+            while (!isBreak()) {
+                unsigned char type = static_cast<unsigned char>(*take(1));
+                uint64_t chunk = argument(type & 0x1F);
+
+                if ((type >> 5) != major)
+                    error("Invalid chunk in indefinite length CBOR string.");
+
+                if (chunk > m_len - m_pos)
+                    error("Truncated CBOR data.");
+
+                chunks.append(take(chunk), chunk);
+            }
+
+            str = chunks;
+        }
+
+        if (major == 2) {
+            chunks = NtEncodeBase64URL(str);
+            str = chunks;
+        } else if (!NtValidateUTF8(str.data(), str.size())) {
+            error("Invalid UTF-8 in CBOR text string.");
+        }
+
+        return isKey ? m_handler->key(str) : m_handler->string(str);
+    }
+
+    bool array(uint64_t count, size_t depth)
+    {
+        if (depth >= NT_JSON_BINARY_MAX_DEPTH)
+            error("Maximum nesting depth exceeded.");
+
+        if (!m_handler->startArray())
+            return false;
+
+        if (count == ms_indefinite) {
+            while (!isBreak()) {
+                if (!decodeValue(depth + 1, false))
+                    return false;
+            }
+        } else {
+            for (uint64_t i = 0; i < count; ++i) {
+                if (!decodeValue(depth + 1, false))
+                    return false;
+            }
+        }
+
+        return m_handler->endArray();
+    }
+
+    bool map(uint64_t count, size_t depth)
+    {
+        if (depth >= NT_JSON_BINARY_MAX_DEPTH)
+            error("Maximum nesting depth exceeded.");
+
+        if (!m_handler->startObject())
+            return false;
+
+        if (count == ms_indefinite) {
+            while (!isBreak()) {
+                if (!decodeValue(depth + 1, true) || !decodeValue(depth + 1, false))
+                    return false;
+            }
+        } else {
+            for (uint64_t i = 0; i < count; ++i) {
+                if (!decodeValue(depth + 1, true) || !decodeValue(depth + 1, false))
+                    return false;
+            }
+        }
+
+        return m_handler->endObject();
+    }
+
+    bool decodeValue(size_t depth, bool isKey)
+    {
+        unsigned char type = static_cast<unsigned char>(*take(1));
+        unsigned char major = type >> 5;
+        unsigned char info = type & 0x1F;
+
+        // Tags carry no meaning for the element model and are skipped.
+        while (major == 6) {
+            if (info >= 28)
+                error("Invalid CBOR tag.");
+
+            argument(info);
+            type = static_cast<unsigned char>(*take(1));
+            major = type >> 5;
+            info = type & 0x1F;
+        }
+
+        if (major == 2 || major == 3)
+            return text(major, argument(info, true), isKey);
+
+        if (isKey)
+            error("CBOR map keys must be strings.");
+
+        switch (major) {
+        case 0:
+            {
+                uint64_t value = argument(info);
+
+                if (value > static_cast<uint64_t>(INT64_MAX))
+                    return m_handler->uinteger(value);
+
+                return m_handler->integer(static_cast<int64_t>(value));
+            }
+        case 1:
+            {
+                uint64_t value = argument(info);
+
+                // Values below INT64_MIN have no integer representation.
+                if (value > static_cast<uint64_t>(INT64_MAX))
+                    return m_handler->number(-1.0 - static_cast<double>(value));
+
+                return m_handler->integer(-1 - static_cast<int64_t>(value));
+            }
+        case 4:
+            return array(argument(info, true), depth);
+        case 5:
+            return map(argument(info, true), depth);
+        default:
+            break;
+        }
+
+        switch (info) {
+        case 20:
+            return m_handler->boolean(false);
+        case 21:
+            return m_handler->boolean(true);
+        case 22:
+        case 23:
+            return m_handler->null();
+        case 25:
+            return m_handler->number(NtHalfToDouble(static_cast<uint16_t>(NtLoadBigEndian(take(2), 2))));
+        case 26:
+            return m_handler->number(NtBitsFloat(static_cast<uint32_t>(NtLoadBigEndian(take(4), 4))));
+        case 27:
+            return m_handler->number(NtBitsDouble(NtLoadBigEndian(take(8), 8)));
+        default:
+            --m_pos;
+            error("Unsupported CBOR simple value.");
+        }
+    }
+
+private:
+    const char* m_data;
+    size_t m_len;
+    size_t m_pos{ 0 };
+    NtJSONHandler* m_handler;
+};
+
+std::string newton::NtEncodeCBOR(const NtJSONElement* element)
+{
+    NtCBOREncoder enc;
+    NtEncodeBinaryElement(enc, element);
+    return enc.take();
+}
+
+std::string newton::NtEncodeCBOR(const NtJSONValue& value)
+{
+    NtCBOREncoder enc;
+    NtEncodeBinaryValue(enc, value);
+    return enc.take();
+}
+
+bool newton::NtDecodeCBOR(const char* data, size_t len, NtJSONHandler* handler)
+{
+    NtCBORDecoder decoder(data, len, handler);
+    return decoder.decode();
+}
+
+NtJSONElement* newton::NtParseCBOR(const char* data, size_t len)
+{
+    NtJSONTreeBuilder builder;
+    NtDecodeCBOR(data, len, &builder);
+    return builder.take();
+}
+
+void newton::NtParseCBOR(const char* data, size_t len, NtJSONDocument& doc)
+{
+    NtJSONDocumentBuilder builder(doc);
+
+    try {
+        NtDecodeCBOR(data, len, &builder);
+    } catch (...) {
+        doc.clear();
+        throw;
+    }
+}
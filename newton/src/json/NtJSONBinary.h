@@ -0,0 +1,229 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtJSONBinary.h
+ * \brief Binary JSON encoding helpers
+ * \author Hákon Hjaltalín
+ *
+ * Internal helpers shared by the MessagePack and CBOR codecs.
+ */
+
+#include "newton/newton.h"
+
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace newton
+{
+
+/**
+ * Maximum container nesting accepted by the binary decoders
+ */
+static constexpr size_t NT_JSON_BINARY_MAX_DEPTH = 512;
+
+/**
+ * Append an unsigned integer in big-endian byte order.
+ */
+template <typename T>
+static inline void NtAppendBigEndian(std::string& out, T value)
+{
+    char buf[sizeof(T)];
+
+    for (size_t i = 0; i < sizeof(T); ++i)
+        buf[i] = static_cast<char>(static_cast<uint64_t>(value) >> (8 * (sizeof(T) - 1 - i)));
+
+    out.append(buf, sizeof(T));
+}
+
+/**
+ * Read an unsigned integer of n bytes in big-endian byte order.
+ */
+static inline uint64_t NtLoadBigEndian(const char* data, size_t n)
+{
+    uint64_t ret = 0;
+
+    for (size_t i = 0; i < n; ++i)
+        ret = (ret << 8) | static_cast<unsigned char>(data[i]);
+
+    return ret;
+}
+
+/**
+ * Encode binary data as base64url without padding, the text form RFC 8949
+ * gives byte strings converted to JSON. Binary values become strings this
+ * way, since the element model only holds valid UTF-8.
+ */
+static inline std::string NtEncodeBase64URL(std::string_view data)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    std::string ret;
+    ret.reserve((data.size() * 4 + 2) / 3);
+
+    size_t i = 0;
+
+    for (; i + 3 <= data.size(); i += 3) {
+        uint32_t v = (static_cast<unsigned char>(data[i]) << 16) |
+            (static_cast<unsigned char>(data[i + 1]) << 8) | static_cast<unsigned char>(data[i + 2]);
+        ret += alphabet[v >> 18];
+        ret += alphabet[(v >> 12) & 0x3F];
+        ret += alphabet[(v >> 6) & 0x3F];
+        ret += alphabet[v & 0x3F];
+    }
+
+    if (i < data.size()) {
+        uint32_t v = static_cast<unsigned char>(data[i]) << 16;
+
+        if (i + 1 < data.size())
+            v |= static_cast<unsigned char>(data[i + 1]) << 8;
+
+        ret += alphabet[v >> 18];
+        ret += alphabet[(v >> 12) & 0x3F];
+
+        if (i + 1 < data.size())
+            ret += alphabet[(v >> 6) & 0x3F];
+    }
+
+    return ret;
+}
+
+static inline uint64_t NtDoubleBits(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline double NtBitsDouble(uint64_t bits)
+{
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static inline float NtBitsFloat(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * Write an element tree with an encoder providing nil, boolean, integer,
+ * uinteger, number, string, array and map.
+ */
+template <typename E>
+static void NtEncodeBinaryElement(E& enc, const NtJSONElement* element)
+{
+    if (!element) {
+        enc.nil();
+        return;
+    }
+
+    switch (element->type()) {
+    case NtJSONElement::Type::OBJECT:
+        {
+            const NtJSONObject* obj = static_cast<const NtJSONObject*>(element);
+            enc.map(obj->count());
+
+            for (auto& member : *obj) {
+                enc.string(member.first);
+                NtEncodeBinaryElement(enc, member.second);
+            }
+        }
+        break;
+    case NtJSONElement::Type::ARRAY:
+        {
+            const NtJSONArray* arr = static_cast<const NtJSONArray*>(element);
+            enc.array(arr->count());
+
+            for (auto* child : *arr)
+                NtEncodeBinaryElement(enc, child);
+        }
+        break;
+    case NtJSONElement::Type::STRING:
+        enc.string(static_cast<const NtJSONString*>(element)->value());
+        break;
+    case NtJSONElement::Type::NUMBER:
+        {
+            const NtJSONNumber* num = static_cast<const NtJSONNumber*>(element);
+
+            switch (num->kind()) {
+            case NtJSONNumber::Kind::INTEGER:
+                enc.integer(num->toInt64());
+                break;
+            case NtJSONNumber::Kind::UNSIGNED:
+                enc.uinteger(num->toUInt64());
+                break;
+            default:
+                enc.number(num->value());
+                break;
+            }
+        }
+        break;
+    case NtJSONElement::Type::BOOLEAN:
+        enc.boolean(static_cast<const NtJSONBoolean*>(element)->value());
+        break;
+    case NtJSONElement::Type::NUL:
+        enc.nil();
+        break;
+    }
+}
+
+/**
+ * Write a document value with an encoder.
+ */
+template <typename E>
+static void NtEncodeBinaryValue(E& enc, const NtJSONValue& value)
+{
+    if (!value.isValid()) {
+        enc.nil();
+        return;
+    }
+
+    switch (value.type()) {
+    case NtJSONElement::Type::OBJECT:
+        enc.map(value.count());
+
+        for (auto it = value.begin(); it != value.end(); ++it) {
+            enc.string(it.key());
+            NtEncodeBinaryValue(enc, *it);
+        }
+        break;
+    case NtJSONElement::Type::ARRAY:
+        enc.array(value.count());
+
+        for (auto it = value.begin(); it != value.end(); ++it)
+            NtEncodeBinaryValue(enc, *it);
+        break;
+    case NtJSONElement::Type::STRING:
+        enc.string(value.asString());
+        break;
+    case NtJSONElement::Type::NUMBER:
+        switch (value.numberKind()) {
+        case NtJSONNumber::Kind::INTEGER:
+            enc.integer(value.asInt64());
+            break;
+        case NtJSONNumber::Kind::UNSIGNED:
+            enc.uinteger(value.asUInt64());
+            break;
+        default:
+            enc.number(value.asNumber());
+            break;
+        }
+        break;
+    case NtJSONElement::Type::BOOLEAN:
+        enc.boolean(value.asBoolean());
+        break;
+    case NtJSONElement::Type::NUL:
+        enc.nil();
+        break;
+    }
+}
+
+}
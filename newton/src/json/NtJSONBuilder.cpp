@@ -0,0 +1,261 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+using namespace newton;
+
+#include <cstring>
+
+/**
+ * Delete an element and everything below it.
+ */
+static void NtDeleteJSONTree(NtJSONElement* element)
+{
+    if (!element)
+        return;
+
+    if (element->type() == NtJSONElement::Type::OBJECT) {
+        for (auto& member : *static_cast<NtJSONObject*>(element))
+            NtDeleteJSONTree(member.second);
+    } else if (element->type() == NtJSONElement::Type::ARRAY) {
+        for (auto* child : *static_cast<NtJSONArray*>(element))
+            NtDeleteJSONTree(child);
+    }
+
+    delete element;
+}
+
+NtJSONTreeBuilder::~NtJSONTreeBuilder()
+{
+    NtDeleteJSONTree(m_root);
+}
+
+void NtJSONTreeBuilder::add(NtJSONElement* element)
+{
+    if (m_stack.empty()) {
+        NtDeleteJSONTree(m_root);
+        m_root = element;
+        return;
+    }
+
+    NtJSONElement* parent = m_stack.back();
+
+    if (parent->type() == NtJSONElement::Type::ARRAY) {
+        static_cast<NtJSONArray*>(parent)->add(element);
+        return;
+    }
+
+    NtJSONObject* obj = static_cast<NtJSONObject*>(parent);
+
+    // The first of duplicate members wins, as in NtParseJSON.
+    if (obj->get(m_key))
+        NtDeleteJSONTree(element);
+    else
+        obj->add(m_key, element);
+}
+
+bool NtJSONTreeBuilder::startObject()
+{
+    NtJSONObject* obj = new NtJSONObject();
+    add(obj);
+    m_stack.push_back(obj);
+    return true;
+}
+
+bool NtJSONTreeBuilder::endObject()
+{
+    m_stack.pop_back();
+    return true;
+}
+
+bool NtJSONTreeBuilder::startArray()
+{
+    NtJSONArray* arr = new NtJSONArray();
+    add(arr);
+    m_stack.push_back(arr);
+    return true;
+}
+
+bool NtJSONTreeBuilder::endArray()
+{
+    m_stack.pop_back();
+    return true;
+}
+
+bool NtJSONTreeBuilder::key(std::string_view name)
+{
+    m_key.assign(name.data(), name.size());
+    return true;
+}
+
+bool NtJSONTreeBuilder::string(std::string_view value)
+{
+    add(new NtJSONString(std::string(value)));
+    return true;
+}
+
+bool NtJSONTreeBuilder::number(double value)
+{
+    add(new NtJSONNumber(value));
+    return true;
+}
+
+bool NtJSONTreeBuilder::integer(int64_t value)
+{
+    add(new NtJSONNumber(value));
+    return true;
+}
+
+bool NtJSONTreeBuilder::uinteger(uint64_t value)
+{
+    add(new NtJSONNumber(value));
+    return true;
+}
+
+bool NtJSONTreeBuilder::boolean(bool value)
+{
+    add(new NtJSONBoolean(value));
+    return true;
+}
+
+bool NtJSONTreeBuilder::null()
+{
+    add(new NtJSONNull());
+    return true;
+}
+
+NtJSONElement* NtJSONTreeBuilder::take()
+{
+    NtJSONElement* ret = m_root;
+    m_root = nullptr;
+    m_stack.clear();
+    return ret;
+}
+
+NtJSONDocumentBuilder::NtJSONDocumentBuilder(NtJSONDocument& doc)
+    : m_doc{ doc }
+{
+    m_doc.clear();
+}
+
+NtJSONNode& NtJSONDocumentBuilder::append(NtJSONElement::Type type)
+{
+    if (!m_stack.empty())
+        ++m_stack.back().second;
+
+    std::vector<NtJSONNode>& nodes = m_doc.nodes();
+    nodes.emplace_back();
+    NtJSONNode& n = nodes.back();
+    n.type = static_cast<uint8_t>(type);
+    n.flags = 0;
+    n.reserved = 0;
+    n.size = 0;
+    n.next = 0;
+    return n;
+}
+
+bool NtJSONDocumentBuilder::endContainer()
+{
+    std::vector<NtJSONNode>& nodes = m_doc.nodes();
+    NtJSONNode& n = nodes[m_stack.back().first];
+    n.size = m_stack.back().second;
+    n.next = nodes.size();
+    m_stack.pop_back();
+    return true;
+}
+
+bool NtJSONDocumentBuilder::startObject()
+{
+    append(NtJSONElement::Type::OBJECT);
+    m_stack.push_back({ m_doc.nodes().size() - 1, 0 });
+    return true;
+}
+
+bool NtJSONDocumentBuilder::endObject()
+{
+    return endContainer();
+}
+
+bool NtJSONDocumentBuilder::startArray()
+{
+    append(NtJSONElement::Type::ARRAY);
+    m_stack.push_back({ m_doc.nodes().size() - 1, 0 });
+    return true;
+}
+
+bool NtJSONDocumentBuilder::endArray()
+{
+    return endContainer();
+}
+
+bool NtJSONDocumentBuilder::key(std::string_view name)
+{
+    // Keys are not members of their own, so they are not counted.
+    --m_stack.back().second;
+    return string(name);
+}
+
+bool NtJSONDocumentBuilder::string(std::string_view value)
+{
+    if (value.size() > UINT32_MAX)
+        throw NtSyntaxError("JSON string is too long.");
+
+    NtJSONNode& n = append(NtJSONElement::Type::STRING);
+    n.size = static_cast<uint32_t>(value.size());
+
+    if (value.size() <= NtJSONNode::ms_inlineSize) {
+        if (!value.empty())
+            memcpy(n.inlined, value.data(), value.size());
+
+        n.flags = NtJSONNode::INLINE;
+    } else {
+        n.string = m_doc.arena().copy(value.data(), value.size());
+    }
+
+    return true;
+}
+
+bool NtJSONDocumentBuilder::number(double value)
+{
+    NtJSONNode& n = append(NtJSONElement::Type::NUMBER);
+    n.flags = static_cast<uint8_t>(NtJSONNumber::Kind::DOUBLE);
+    n.number = value;
+    return true;
+}
+
+bool NtJSONDocumentBuilder::integer(int64_t value)
+{
+    NtJSONNode& n = append(NtJSONElement::Type::NUMBER);
+    n.flags = static_cast<uint8_t>(NtJSONNumber::Kind::INTEGER);
+    n.integer = value;
+    return true;
+}
+
+bool NtJSONDocumentBuilder::uinteger(uint64_t value)
+{
+    NtJSONNode& n = append(NtJSONElement::Type::NUMBER);
+
+    if (value > static_cast<uint64_t>(INT64_MAX)) {
+        n.flags = static_cast<uint8_t>(NtJSONNumber::Kind::UNSIGNED);
+        n.uinteger = value;
+    } else {
+        n.flags = static_cast<uint8_t>(NtJSONNumber::Kind::INTEGER);
+        n.integer = static_cast<int64_t>(value);
+    }
+
+    return true;
+}
+
+bool NtJSONDocumentBuilder::boolean(bool value)
+{
+    append(NtJSONElement::Type::BOOLEAN).boolean = value;
+    return true;
+}
+
+bool NtJSONDocumentBuilder::null()
+{
+    append(NtJSONElement::Type::NUL);
+    return true;
+}
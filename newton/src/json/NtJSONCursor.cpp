@@ -0,0 +1,399 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+#include "NtJSONLexer.h"
+using namespace newton;
+
+#include <cmath>
+
+static inline size_t NtSkipJSONWhitespace(const char* data, size_t len, size_t pos)
+{
+    while (pos < len && (
+            data[pos] == ' ' ||
+            data[pos] == '\n' ||
+            data[pos] == '\r' ||
+            data[pos] == '\t'))
+        ++pos;
+
+    return pos;
+}
+
+/**
+ * Position after the closing quote of the string starting at pos. Quotes
+ * are found with memchr and kept only if preceded by an even number of
+ * backslashes.
+ */
+static size_t NtSkipJSONString(const char* data, size_t len, size_t pos)
+{
+    size_t start = pos + 1;
+    size_t at = start;
+
+    while (true) {
+        const char* quote = static_cast<const char*>(memchr(data + at, '"', len - at));
+
+        if (!quote)
+            NtThrowJSONError(data, len, pos, "Unterminated JSON string.");
+
+        size_t end = static_cast<size_t>(quote - data);
+        size_t backslashes = 0;
+
+        while (end - backslashes > start && data[end - backslashes - 1] == '\\')
+            ++backslashes;
+
+        if (backslashes % 2 == 0)
+            return end + 1;
+
+        at = end + 1;
+    }
+}
+
+static size_t NtSkipJSONValue(const char* data, size_t len, size_t pos)
+{
+    switch (data[pos]) {
+    case '"':
+        return NtSkipJSONString(data, len, pos);
+    case '{':
+    case '[':
+        {
+            size_t depth = 0;
+
+            while (pos < len) {
+                switch (data[pos]) {
+                case '"':
+                    pos = NtSkipJSONString(data, len, pos);
+                    continue;
+                case '{':
+                case '[':
+                    ++depth;
+                    break;
+                case '}':
+                case ']':
+                    if (--depth == 0)
+                        return pos + 1;
+                    break;
+                default:
+                    break;
+                }
+
+                ++pos;
+            }
+
+            NtThrowJSONError(data, len, len, "Unterminated JSON container.");
+        }
+    default:
+        while (pos < len && !NtIsJSONDelimiter(data[pos]))
+            ++pos;
+
+        return pos;
+    }
+}
+
+NtJSONCursor::Iterator::Iterator(const char* data, size_t len, size_t pos, bool isObject)
+    : m_data{ data }, m_len{ len }, m_pos{ pos }, m_valuePos{ pos }, m_keyLen{ 0 },
+      m_isObject{ isObject }, m_isKeyEscaped{ false }
+{
+    if (m_isObject && m_pos != npos)
+        locateValue();
+}
+
+void NtJSONCursor::Iterator::locateValue()
+{
+    if (m_data[m_pos] != '"')
+        NtThrowJSONError(m_data, m_len, m_pos, "Invalid member in JSON object.");
+
+    size_t keyEnd = NtSkipJSONString(m_data, m_len, m_pos);
+    m_keyLen = keyEnd - m_pos - 2;
+    m_isKeyEscaped = memchr(m_data + m_pos + 1, '\\', m_keyLen) != nullptr;
+
+    size_t pos = NtSkipJSONWhitespace(m_data, m_len, keyEnd);
+
+    if (pos >= m_len || m_data[pos] != ':')
+        NtThrowJSONError(m_data, m_len, pos, "Member name must be followed by ':' colon character.");
+
+    pos = NtSkipJSONWhitespace(m_data, m_len, pos + 1);
+
+    if (pos >= m_len)
+        NtThrowJSONError(m_data, m_len, pos, "Invalid JSON value.");
+
+    m_valuePos = pos;
+}
+
+std::string NtJSONCursor::Iterator::key() const
+{
+    if (!m_isKeyEscaped)
+        return std::string(rawKey());
+
+    int line = 1;
+    size_t pos = m_pos;
+    return NtParseJSONString(std::string_view(m_data, m_len), line, pos);
+}
+
+NtJSONCursor::Iterator& NtJSONCursor::Iterator::operator++()
+{
+    size_t pos = NtSkipJSONWhitespace(m_data, m_len, NtSkipJSONValue(m_data, m_len, m_valuePos));
+
+    if (pos >= m_len)
+        NtThrowJSONError(m_data, m_len, pos, "Unterminated JSON container.");
+
+    char c = m_data[pos];
+
+    if (c == ',') {
+        pos = NtSkipJSONWhitespace(m_data, m_len, pos + 1);
+
+        if (pos >= m_len)
+            NtThrowJSONError(m_data, m_len, pos, "Invalid JSON value.");
+
+        m_pos = pos;
+        m_valuePos = pos;
+
+        if (m_isObject)
+            locateValue();
+    } else if (c == (m_isObject ? '}' : ']')) {
+        m_pos = npos;
+    } else {
+        NtThrowJSONError(m_data, m_len, pos, m_isObject ?
+            "Invalid termination of JSON object." : "Invalid termination of JSON array.");
+    }
+
+    return *this;
+}
+
+NtJSONCursor::NtJSONCursor(const char* data, size_t len)
+    : m_data{ data }, m_len{ len }, m_pos{ NtSkipJSONWhitespace(data, len, 0) }
+{
+    if (m_pos >= m_len)
+        m_data = nullptr;
+}
+
+NtJSONElement::Type NtJSONCursor::type() const
+{
+    switch (m_data[m_pos]) {
+    case '{':
+        return NtJSONElement::Type::OBJECT;
+    case '[':
+        return NtJSONElement::Type::ARRAY;
+    case '"':
+        return NtJSONElement::Type::STRING;
+    case 't':
+    case 'f':
+        return NtJSONElement::Type::BOOLEAN;
+    case 'n':
+        return NtJSONElement::Type::NUL;
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+    case '-':
+        return NtJSONElement::Type::NUMBER;
+    default:
+        NtThrowJSONError(m_data, m_len, m_pos, "Invalid JSON value.");
+    }
+}
+
+std::string NtJSONCursor::asString() const
+{
+    if (!isString())
+        return std::string();
+
+    int line = 1;
+    size_t pos = m_pos;
+    return NtParseJSONString(std::string_view(m_data, m_len), line, pos);
+}
+
+NtJSONNumberValue NtJSONCursor::scanNumber() const
+{
+    size_t pos = m_pos;
+    NtJSONNumberValue num;
+
+    if (!NtScanJSONNumber(std::string_view(m_data, m_len), pos, num) ||
+            (pos < m_len && !NtIsJSONDelimiter(m_data[pos])))
+        NtThrowJSONError(m_data, m_len, m_pos, "Invalid JSON number.");
+
+    return num;
+}
+
+double NtJSONCursor::asNumber() const
+{
+    if (!isNumber())
+        return 0.0;
+
+    return scanNumber().toDouble();
+}
+
+int64_t NtJSONCursor::asInt64() const
+{
+    if (!isNumber())
+        return 0;
+
+    NtJSONNumberValue num = scanNumber();
+
+    if (num.kind == NtJSONNumber::Kind::DOUBLE)
+        return static_cast<int64_t>(num.number);
+
+    return num.integer;
+}
+
+uint64_t NtJSONCursor::asUInt64() const
+{
+    if (!isNumber())
+        return 0;
+
+    NtJSONNumberValue num = scanNumber();
+
+    if (num.kind == NtJSONNumber::Kind::DOUBLE)
+        return static_cast<uint64_t>(num.number);
+
+    return num.uinteger;
+}
+
+bool NtJSONCursor::getInt64(int64_t& out) const
+{
+    if (!isNumber())
+        return false;
+
+    NtJSONNumberValue num = scanNumber();
+
+    switch (num.kind) {
+    case NtJSONNumber::Kind::INTEGER:
+        out = num.integer;
+        return true;
+    case NtJSONNumber::Kind::UNSIGNED:
+        return false;
+    default:
+        // Every integral double in [-2^63, 2^63) converts exactly.
+        if (num.number != std::trunc(num.number) || num.number < -0x1p63 || num.number >= 0x1p63)
+            return false;
+
+        out = static_cast<int64_t>(num.number);
+        return true;
+    }
+}
+
+bool NtJSONCursor::getUInt64(uint64_t& out) const
+{
+    if (!isNumber())
+        return false;
+
+    NtJSONNumberValue num = scanNumber();
+
+    switch (num.kind) {
+    case NtJSONNumber::Kind::INTEGER:
+        if (num.integer < 0)
+            return false;
+
+        out = static_cast<uint64_t>(num.integer);
+        return true;
+    case NtJSONNumber::Kind::UNSIGNED:
+        out = num.uinteger;
+        return true;
+    default:
+        if (num.number != std::trunc(num.number) || num.number < 0.0 || num.number >= 0x1p64)
+            return false;
+
+        out = static_cast<uint64_t>(num.number);
+        return true;
+    }
+}
+
+bool NtJSONCursor::asBoolean() const
+{
+    if (!isBoolean())
+        return false;
+
+    std::string_view value = raw();
+
+    if (value == "true")
+        return true;
+
+    if (value != "false")
+        NtThrowJSONError(m_data, m_len, m_pos, "Invalid JSON value.");
+
+    return false;
+}
+
+size_t NtJSONCursor::count() const
+{
+    size_t ret = 0;
+
+    for (auto it = begin(); it != end(); ++it)
+        ++ret;
+
+    return ret;
+}
+
+NtJSONCursor NtJSONCursor::get(std::string_view name) const
+{
+    if (!isObject())
+        return NtJSONCursor();
+
+    for (auto it = begin(); it != end(); ++it) {
+        if (it.isKeyEscaped() ? it.key() == name : it.rawKey() == name)
+            return *it;
+    }
+
+    return NtJSONCursor();
+}
+
+NtJSONCursor NtJSONCursor::get(size_t idx) const
+{
+    if (!isArray())
+        return NtJSONCursor();
+
+    auto it = begin();
+
+    for (size_t i = 0; i < idx && it != end(); ++i)
+        ++it;
+
+    if (it == end())
+        return NtJSONCursor();
+
+    return *it;
+}
+
+NtJSONCursor::Iterator NtJSONCursor::begin() const
+{
+    if (!isObject() && !isArray())
+        return end();
+
+    size_t pos = NtSkipJSONWhitespace(m_data, m_len, m_pos + 1);
+
+    if (pos >= m_len)
+        NtThrowJSONError(m_data, m_len, pos, "Unterminated JSON container.");
+
+    if (m_data[pos] == (isObject() ? '}' : ']'))
+        return end();
+
+    return Iterator(m_data, m_len, pos, isObject());
+}
+
+NtJSONCursor::Iterator NtJSONCursor::end() const
+{
+    return Iterator(m_data, m_len, npos, false);
+}
+
+std::string_view NtJSONCursor::raw() const
+{
+    if (!isValid())
+        return std::string_view();
+
+    return std::string_view(m_data + m_pos, skip() - m_pos);
+}
+
+size_t NtJSONCursor::skip() const
+{
+    return NtSkipJSONValue(m_data, m_len, m_pos);
+}
+
+bool NtJSONCursor::isLast() const
+{
+    return isValid() && NtSkipJSONWhitespace(m_data, m_len, skip()) == m_len;
+}
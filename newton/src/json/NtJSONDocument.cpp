@@ -0,0 +1,490 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+#include "NtJSONLexer.h"
+#include "NtJSONIndexer.h"
+using namespace newton;
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <sstream>
+
+static constexpr uint8_t NtNodeType(NtJSONElement::Type type)
+{
+    return static_cast<uint8_t>(type);
+}
+
+namespace newton
+{
+
+/**
+ * \class NtJSONDocumentParser
+ * \brief Document parser
+ *
+ * Second parsing stage: walks the structural index of a text and appends
+ * nodes to a document.
+ */
+class NtJSONDocumentParser
+{
+public:
+    NtJSONDocumentParser(NtJSONDocument& doc, const char* data, size_t len, bool isBorrowing)
+        : m_nodes{ doc.m_nodes }, m_arena{ doc.m_arena }, m_index{ doc.m_structurals },
+          m_keys{ doc.m_isInterningKeys ? &doc.m_keys : nullptr }, m_data{ data }, m_len{ len },
+          m_isBorrowing{ isBorrowing }
+    {
+    }
+
+    void parse()
+    {
+        if (m_len > UINT32_MAX)
+            throw NtSyntaxError("JSON text is too large.");
+
+        if (!NtJSONIndexStructurals(m_data, m_len, m_index))
+            error("Unterminated JSON string.", m_len);
+
+        m_nodes.reserve(m_index.size() + 1);
+
+        parseValue(0);
+
+        if (m_next < m_index.size())
+            error("Unexpected data after JSON value.", m_index[m_next]);
+    }
+
+private:
+    static constexpr size_t ms_maxDepth = 1024;
+
+    [[noreturn]] void error(const char* msg, size_t pos)
+    {
+        NtThrowJSONError(m_data, m_len, pos, msg);
+    }
+
+    size_t advance()
+    {
+        if (m_next >= m_index.size())
+            error("Unexpected end of JSON text.", m_len);
+
+        return m_index[m_next++];
+    }
+
+    size_t following() const
+    {
+        return m_next < m_index.size() ? m_index[m_next] : m_len;
+    }
+
+    NtJSONNode& append(NtJSONElement::Type type)
+    {
+        m_nodes.emplace_back();
+        NtJSONNode& n = m_nodes.back();
+        n.type = NtNodeType(type);
+        n.flags = 0;
+        n.reserved = 0;
+        n.size = 0;
+        n.next = 0;
+        return n;
+    }
+
+    void parseString(size_t pos, bool isKey)
+    {
+        // The closing quote lies before the next structural character, so
+        // the distance to it bounds the decoded length.
+        size_t bound = following() - pos;
+        const char* str = nullptr;
+        char* out = nullptr;
+        size_t len = 0;
+
+        // Valid strings without escapes can point straight into text the
+        // document keeps alive.
+        if (m_isBorrowing) {
+            const char* start = m_data + pos + 1;
+            size_t run = NtJSONStringRunLength(start, bound - 1);
+
+            if (run < bound - 1 && start[run] == '"' && NtValidateUTF8(start, run)) {
+                str = start;
+                len = run;
+            }
+        }
+
+        if (!str) {
+            out = static_cast<char*>(m_arena.allocate(bound, 1));
+
+            if (!NtUnescapeJSONString(m_data + pos + 1, m_data + pos + bound, out, len))
+                error("Invalid JSON string.", pos);
+
+            str = out;
+        }
+
+        NtJSONNode& n = append(NtJSONElement::Type::STRING);
+        n.size = static_cast<uint32_t>(len);
+
+        if (len <= NtJSONNode::ms_inlineSize) {
+            memcpy(n.inlined, str, len);
+            n.flags = NtJSONNode::INLINE;
+            len = 0;
+        } else if (isKey && m_keys) {
+            auto result = m_keys->insert(std::string_view(str, len));
+            n.flags = NtJSONNode::INTERNED;
+            n.string = result.first->data();
+
+            if (!result.second)
+                len = 0;
+        } else {
+            n.string = str;
+        }
+
+        if (out)
+            m_arena.shrink(out, len);
+    }
+
+    void endScalar(size_t pos, size_t end)
+    {
+        if (end < m_len && !NtIsJSONDelimiter(m_data[end]))
+            error("Invalid JSON value.", pos);
+    }
+
+    void parseLiteral(size_t pos, const char* literal, size_t len)
+    {
+        if (m_len - pos < len || memcmp(m_data + pos, literal, len) != 0)
+            error("Invalid JSON value.", pos);
+
+        endScalar(pos, pos + len);
+    }
+
+    void parseValue(size_t depth)
+    {
+        size_t pos = advance();
+
+        switch (m_data[pos]) {
+        case '{':
+            parseObject(pos, depth + 1);
+            break;
+        case '[':
+            parseArray(pos, depth + 1);
+            break;
+        case '"':
+            parseString(pos, false);
+            break;
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+        case '-':
+            {
+                size_t end = pos;
+                NtJSONNumberValue num;
+
+                if (!NtScanJSONNumber(std::string_view(m_data, m_len), end, num))
+                    error("Invalid JSON number.", pos);
+
+                endScalar(pos, end);
+
+                NtJSONNode& n = append(NtJSONElement::Type::NUMBER);
+                n.flags = static_cast<uint8_t>(num.kind);
+                n.uinteger = num.uinteger;
+            }
+            break;
+        case 't':
+            parseLiteral(pos, "true", 4);
+            append(NtJSONElement::Type::BOOLEAN).boolean = true;
+            break;
+        case 'f':
+            parseLiteral(pos, "false", 5);
+            append(NtJSONElement::Type::BOOLEAN).boolean = false;
+            break;
+        case 'n':
+            parseLiteral(pos, "null", 4);
+            append(NtJSONElement::Type::NUL);
+            break;
+        default:
+            error("Invalid JSON value.", pos);
+        }
+    }
+
+    void parseArray(size_t pos, size_t depth)
+    {
+        if (depth > ms_maxDepth)
+            error("Maximum nesting depth exceeded.", pos);
+
+        size_t index = m_nodes.size();
+        append(NtJSONElement::Type::ARRAY);
+        uint32_t count = 0;
+
+        if (m_next < m_index.size() && m_data[m_index[m_next]] == ']') {
+            ++m_next;
+        } else {
+            while (true) {
+                parseValue(depth);
+                ++count;
+
+                size_t sep = advance();
+
+                if (m_data[sep] == ']')
+                    break;
+
+                if (m_data[sep] != ',')
+                    error("Invalid termination of JSON array.", sep);
+            }
+        }
+
+        m_nodes[index].size = count;
+        m_nodes[index].next = m_nodes.size();
+    }
+
+    void parseObject(size_t pos, size_t depth)
+    {
+        if (depth > ms_maxDepth)
+            error("Maximum nesting depth exceeded.", pos);
+
+        size_t index = m_nodes.size();
+        append(NtJSONElement::Type::OBJECT);
+        uint32_t count = 0;
+
+        if (m_next < m_index.size() && m_data[m_index[m_next]] == '}') {
+            ++m_next;
+        } else {
+            while (true) {
+                size_t key = advance();
+
+                if (m_data[key] != '"')
+                    error("Invalid member in JSON object.", key);
+
+                parseString(key, true);
+
+                size_t colon = advance();
+
+                if (m_data[colon] != ':')
+                    error("Member name must be followed by ':' colon character.", colon);
+
+                parseValue(depth);
+                ++count;
+
+                size_t sep = advance();
+
+                if (m_data[sep] == '}')
+                    break;
+
+                if (m_data[sep] != ',')
+                    error("Invalid termination of JSON object.", sep);
+            }
+        }
+
+        m_nodes[index].size = count;
+        m_nodes[index].next = m_nodes.size();
+    }
+
+private:
+    std::vector<NtJSONNode>& m_nodes;
+    NtArena& m_arena;
+    std::vector<uint32_t>& m_index;
+    std::unordered_set<std::string_view>* m_keys;
+    const char* m_data;
+    size_t m_len;
+    bool m_isBorrowing;
+    size_t m_next{ 0 };
+};
+
+}
+
+void NtJSONDocument::parse(const char* data, size_t len)
+{
+    clear();
+
+    // Decoded strings are never longer than the text, so small documents
+    // such as NDJSON records get a block of their own size.
+    m_arena.setBlockSize(std::min(len, ms_arenaBlockSize));
+    m_hasInternedKeys = m_isInterningKeys;
+
+    NtJSONDocumentParser parser(*this, data, len, false);
+
+    try {
+        parser.parse();
+    } catch (...) {
+        clear();
+        throw;
+    }
+}
+
+void NtJSONDocument::parseFile(const char* path)
+{
+    clear();
+    m_file.open(path);
+    m_hasInternedKeys = m_isInterningKeys;
+
+    NtJSONDocumentParser parser(*this, m_file.data(), m_file.size(), true);
+
+    try {
+        parser.parse();
+    } catch (...) {
+        clear();
+        throw;
+    }
+}
+
+const char* NtJSONDocument::indexerKernel()
+{
+    return NtJSONIndexerKernel();
+}
+
+void NtJSONDocument::clear()
+{
+    m_nodes.clear();
+    m_arena.clear();
+    m_arena.setBlockSize(ms_arenaBlockSize);
+    m_keys.clear();
+    m_file.close();
+    m_hasInternedKeys = false;
+}
+
+NtJSONValue::Iterator& NtJSONValue::Iterator::operator++()
+{
+    if (m_isObject)
+        m_index = m_doc->skip(m_index + 1);
+    else
+        m_index = m_doc->skip(m_index);
+
+    return *this;
+}
+
+NtJSONElement::Type NtJSONValue::type() const
+{
+    return static_cast<NtJSONElement::Type>(m_doc->node(m_index).type);
+}
+
+std::string_view NtJSONValue::asString() const
+{
+    if (!isString())
+        return std::string_view();
+
+    return m_doc->node(m_index).str();
+}
+
+double NtJSONValue::asNumber() const
+{
+    if (!isNumber())
+        return 0.0;
+
+    const NtJSONNode& n = m_doc->node(m_index);
+
+    switch (static_cast<NtJSONNumber::Kind>(n.flags)) {
+    case NtJSONNumber::Kind::INTEGER:
+        return static_cast<double>(n.integer);
+    case NtJSONNumber::Kind::UNSIGNED:
+        return static_cast<double>(n.uinteger);
+    default:
+        return n.number;
+    }
+}
+
+int64_t NtJSONValue::asInt64() const
+{
+    if (!isNumber())
+        return 0;
+
+    const NtJSONNode& n = m_doc->node(m_index);
+
+    if (static_cast<NtJSONNumber::Kind>(n.flags) == NtJSONNumber::Kind::DOUBLE)
+        return static_cast<int64_t>(n.number);
+
+    return n.integer;
+}
+
+uint64_t NtJSONValue::asUInt64() const
+{
+    if (!isNumber())
+        return 0;
+
+    const NtJSONNode& n = m_doc->node(m_index);
+
+    if (static_cast<NtJSONNumber::Kind>(n.flags) == NtJSONNumber::Kind::DOUBLE)
+        return static_cast<uint64_t>(n.number);
+
+    return n.uinteger;
+}
+
+NtJSONNumber::Kind NtJSONValue::numberKind() const
+{
+    if (!isNumber())
+        return NtJSONNumber::Kind::DOUBLE;
+
+    return static_cast<NtJSONNumber::Kind>(m_doc->node(m_index).flags);
+}
+
+bool NtJSONValue::asBoolean() const
+{
+    if (!isBoolean())
+        return false;
+
+    return m_doc->node(m_index).boolean;
+}
+
+size_t NtJSONValue::count() const
+{
+    if (!isObject() && !isArray())
+        return 0;
+
+    return m_doc->node(m_index).size;
+}
+
+NtJSONValue NtJSONValue::get(std::string_view name) const
+{
+    if (!isObject())
+        return NtJSONValue();
+
+    // Interned keys are unique per document, so they compare by pointer and
+    // a name missing from the table is in no object.
+    const char* interned = nullptr;
+
+    if (m_doc->hasInternedKeys() && name.size() > NtJSONNode::ms_inlineSize) {
+        interned = m_doc->internedKey(name);
+
+        if (!interned)
+            return NtJSONValue();
+    }
+
+    for (auto it = begin(); it != end(); ++it) {
+        std::string_view key = it.key();
+
+        if (interned ? key.data() == interned : key == name)
+            return *it;
+    }
+
+    return NtJSONValue();
+}
+
+NtJSONValue NtJSONValue::get(size_t idx) const
+{
+    if (!isArray() || idx >= count())
+        return NtJSONValue();
+
+    auto it = begin();
+
+    for (size_t i = 0; i < idx; ++i)
+        ++it;
+
+    return *it;
+}
+
+NtJSONValue::Iterator NtJSONValue::begin() const
+{
+    if (!isObject() && !isArray())
+        return end();
+
+    return Iterator(m_doc, m_index + 1, isObject());
+}
+
+NtJSONValue::Iterator NtJSONValue::end() const
+{
+    if (!isValid())
+        return Iterator(nullptr, 0, false);
+
+    return Iterator(m_doc, m_doc->skip(m_index), isObject());
+}
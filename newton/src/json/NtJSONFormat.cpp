@@ -0,0 +1,147 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+using namespace newton;
+
+#include <cctype>
+#include <cstdlib>
+
+/**
+ * Remove leading and trailing spaces and tabs.
+ */
+static std::string_view NtTrimMediaToken(std::string_view str)
+{
+    while (!str.empty() && (str.front() == ' ' || str.front() == '\t'))
+        str.remove_prefix(1);
+
+    while (!str.empty() && (str.back() == ' ' || str.back() == '\t'))
+        str.remove_suffix(1);
+
+    return str;
+}
+
+/**
+ * Match a media type against the supported formats. Returns false if the
+ * type is not one of them.
+ */
+static bool NtMatchMediaType(std::string_view type, NtJSONFormat& format)
+{
+    if (NtEqualsIgnoreCase(type, "application/json")) {
+        format = NtJSONFormat::JSON;
+    } else if (NtEqualsIgnoreCase(type, "application/msgpack") ||
+            NtEqualsIgnoreCase(type, "application/x-msgpack") ||
+            NtEqualsIgnoreCase(type, "application/vnd.msgpack")) {
+        format = NtJSONFormat::MESSAGEPACK;
+    } else if (NtEqualsIgnoreCase(type, "application/cbor")) {
+        format = NtJSONFormat::CBOR;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+const char* newton::NtJSONContentType(NtJSONFormat format)
+{
+    switch (format) {
+    case NtJSONFormat::MESSAGEPACK:
+        return "application/msgpack";
+    case NtJSONFormat::CBOR:
+        return "application/cbor";
+    default:
+        return "application/json";
+    }
+}
+
+NtJSONFormat newton::NtJSONFormatFromContentType(std::string_view contentType)
+{
+    NtJSONFormat ret = NtJSONFormat::JSON;
+    NtMatchMediaType(NtTrimMediaToken(contentType.substr(0, contentType.find(';'))), ret);
+    return ret;
+}
+
+NtJSONFormat newton::NtNegotiateJSONFormat(std::string_view accept)
+{
+    NtJSONFormat ret = NtJSONFormat::JSON;
+    double best = 0.0;
+
+    while (!accept.empty()) {
+        size_t end = accept.find(',');
+        std::string_view range = accept.substr(0, end);
+        accept = end == std::string_view::npos ? std::string_view() : accept.substr(end + 1);
+
+        size_t semi = range.find(';');
+        std::string_view type = NtTrimMediaToken(range.substr(0, semi));
+        double quality = 1.0;
+
+        while (semi != std::string_view::npos) {
+            range = range.substr(semi + 1);
+            semi = range.find(';');
+            std::string_view param = NtTrimMediaToken(range.substr(0, semi));
+
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=')
+                quality = strtod(std::string(param.substr(2)).c_str(), nullptr);
+        }
+
+        if (quality <= 0.0)
+            continue;
+
+        NtJSONFormat format;
+
+        if (NtMatchMediaType(type, format)) {
+            if (quality > best || (quality == best && format == NtJSONFormat::JSON)) {
+                ret = format;
+                best = quality;
+            }
+        } else if (type == "*/*" || NtEqualsIgnoreCase(type, "application/*")) {
+            if (quality >= best) {
+                ret = NtJSONFormat::JSON;
+                best = quality;
+            }
+        }
+    }
+
+    return ret;
+}
+
+std::string newton::NtEncodeJSON(const NtJSONElement* element, NtJSONFormat format)
+{
+    switch (format) {
+    case NtJSONFormat::MESSAGEPACK:
+        return NtEncodeMessagePack(element);
+    case NtJSONFormat::CBOR:
+        return NtEncodeCBOR(element);
+    default:
+        return NtSerializeJSON(element);
+    }
+}
+
+std::string newton::NtEncodeJSON(const NtJSONValue& value, NtJSONFormat format)
+{
+    switch (format) {
+    case NtJSONFormat::MESSAGEPACK:
+        return NtEncodeMessagePack(value);
+    case NtJSONFormat::CBOR:
+        return NtEncodeCBOR(value);
+    default:
+        return NtSerializeJSON(value);
+    }
+}
+
+void newton::NtDecodeJSON(const char* data, size_t len, NtJSONFormat format, NtJSONDocument& doc)
+{
+    switch (format) {
+    case NtJSONFormat::MESSAGEPACK:
+        NtParseMessagePack(data, len, doc);
+        break;
+    case NtJSONFormat::CBOR:
+        NtParseCBOR(data, len, doc);
+        break;
+    default:
+        doc.parse(data, len);
+        break;
+    }
+}
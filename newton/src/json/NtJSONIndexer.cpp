@@ -0,0 +1,304 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+#include "NtJSONIndexer.h"
+using namespace newton;
+
+#include <atomic>
+#include <cstring>
+
+#if (defined(NT_COMPILER_GCC) || defined(NT_COMPILER_CLANG)) && (defined(__x86_64__) || defined(__i386__))
+#  define NT_JSON_X86_KERNELS
+#  include <immintrin.h>
+#endif
+
+/**
+ * \struct NtJSONBlock
+ * \brief Classified block
+ *
+ * Character class bitmaps for a 64-byte block, bit i is byte i.
+ */
+struct NtJSONBlock
+{
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t whitespace;
+    uint64_t op;
+};
+
+struct NtJSONClassifier
+{
+    void (*classify)(const char* block, NtJSONBlock& out);
+    const char* name;
+};
+
+static void NtClassifyScalar(const char* block, NtJSONBlock& out)
+{
+    out = NtJSONBlock{ 0, 0, 0, 0 };
+
+    for (int i = 0; i < 64; ++i) {
+        uint64_t bit = 1ULL << i;
+
+        switch (block[i]) {
+        case '"':
+            out.quote |= bit;
+            break;
+        case '\\':
+            out.backslash |= bit;
+            break;
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+            out.whitespace |= bit;
+            break;
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case ':':
+        case ',':
+            out.op |= bit;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+#ifdef NT_JSON_X86_KERNELS
+
+// Setting bit 5 folds '[' onto '{' and ']' onto '}', so four compares find
+// all six structural characters.
+
+__attribute__((target("sse2")))
+static void NtClassifySSE2(const char* block, NtJSONBlock& out)
+{
+    out = NtJSONBlock{ 0, 0, 0, 0 };
+
+    for (int i = 0; i < 4; ++i) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+        __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        int shift = i * 16;
+
+        __m128i ws = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+        __m128i op = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')), _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')), _mm_cmpeq_epi8(v, _mm_set1_epi8(','))));
+
+        out.quote |= static_cast<uint64_t>(static_cast<uint16_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))))) << shift;
+        out.backslash |= static_cast<uint64_t>(static_cast<uint16_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))))) << shift;
+        out.whitespace |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(ws))) << shift;
+        out.op |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(op))) << shift;
+    }
+}
+
+__attribute__((target("avx2")))
+static void NtClassifyAVX2(const char* block, NtJSONBlock& out)
+{
+    out = NtJSONBlock{ 0, 0, 0, 0 };
+
+    for (int i = 0; i < 2; ++i) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i * 32));
+        __m256i folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        int shift = i * 32;
+
+        __m256i ws = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+        __m256i op = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+
+        out.quote |= static_cast<uint64_t>(static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))))) << shift;
+        out.backslash |= static_cast<uint64_t>(static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))))) << shift;
+        out.whitespace |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(ws))) << shift;
+        out.op |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(op))) << shift;
+    }
+}
+
+#endif
+
+/**
+ * Classifiers this CPU supports, fastest first.
+ */
+static std::vector<NtJSONClassifier> NtSupportedClassifiers()
+{
+    std::vector<NtJSONClassifier> classifiers;
+
+#ifdef NT_JSON_X86_KERNELS
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+        classifiers.push_back(NtJSONClassifier{ NtClassifyAVX2, "avx2" });
+
+    if (__builtin_cpu_supports("sse2"))
+        classifiers.push_back(NtJSONClassifier{ NtClassifySSE2, "sse2" });
+#endif
+
+    classifiers.push_back(NtJSONClassifier{ NtClassifyScalar, "scalar" });
+    return classifiers;
+}
+
+static const std::vector<NtJSONClassifier>& NtClassifiers()
+{
+    static const std::vector<NtJSONClassifier> classifiers = NtSupportedClassifiers();
+    return classifiers;
+}
+
+static std::atomic<const NtJSONClassifier*>& NtClassifier()
+{
+    static std::atomic<const NtJSONClassifier*> classifier{ &NtClassifiers().front() };
+    return classifier;
+}
+
+static inline int NtCountTrailingZeros(uint64_t x)
+{
+#if defined(NT_COMPILER_GCC) || defined(NT_COMPILER_CLANG)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+
+    while (!(x & 1)) {
+        x >>= 1;
+        ++n;
+    }
+
+    return n;
+#endif
+}
+
+static inline int NtPopCount(uint64_t x)
+{
+#if defined(NT_COMPILER_GCC) || defined(NT_COMPILER_CLANG)
+    return __builtin_popcountll(x);
+#else
+    int n = 0;
+
+    while (x) {
+        x &= x - 1;
+        ++n;
+    }
+
+    return n;
+#endif
+}
+
+/**
+ * Bits of characters preceded by an odd number of backslashes. A run that
+ * reaches the end of the block carries into the next one.
+ */
+static inline uint64_t NtFindEscaped(uint64_t backslash, uint64_t& prevEscaped)
+{
+    const uint64_t evenBits = 0x5555555555555555ULL;
+
+    backslash &= ~prevEscaped;
+    uint64_t followsEscape = (backslash << 1) | prevEscaped;
+    uint64_t oddStarts = backslash & ~evenBits & ~followsEscape;
+    uint64_t evenStarts = oddStarts + backslash;
+
+    prevEscaped = evenStarts < oddStarts ? 1 : 0;
+
+    return (evenBits ^ (evenStarts << 1)) & followsEscape;
+}
+
+/**
+ * Running XOR of all lower bits: turns quote bits into a mask of the bytes
+ * from an opening quote up to, but not including, its closing quote.
+ */
+static inline uint64_t NtPrefixXor(uint64_t x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+bool newton::NtJSONIndexStructurals(const char* data, size_t len, std::vector<uint32_t>& index)
+{
+    const NtJSONClassifier& classifier = *NtClassifier().load(std::memory_order_relaxed);
+
+    uint64_t prevEscaped = 0;
+    uint64_t prevInString = 0;
+    uint64_t prevScalar = 0;
+    char tail[64];
+
+    index.clear();
+
+    for (size_t base = 0; base < len; base += 64) {
+        const char* block = data + base;
+
+        if (len - base < 64) {
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, block, len - base);
+            block = tail;
+        }
+
+        NtJSONBlock b;
+        classifier.classify(block, b);
+
+        uint64_t escaped = NtFindEscaped(b.backslash, prevEscaped);
+        uint64_t quote = b.quote & ~escaped;
+        uint64_t inString = NtPrefixXor(quote) ^ prevInString;
+        prevInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+
+        uint64_t scalar = ~(b.op | b.whitespace | b.quote) & ~inString;
+        uint64_t scalarStart = scalar & ~((scalar << 1) | prevScalar);
+        prevScalar = scalar >> 63;
+
+        uint64_t structurals = ((b.op | scalarStart) & ~inString) | (quote & inString);
+
+        if (!structurals)
+            continue;
+
+        size_t at = index.size();
+        index.resize(at + NtPopCount(structurals));
+        uint32_t* out = index.data() + at;
+
+        while (structurals) {
+            *out++ = static_cast<uint32_t>(base + NtCountTrailingZeros(structurals));
+            structurals &= structurals - 1;
+        }
+    }
+
+    return prevInString == 0;
+}
+
+const char* newton::NtJSONIndexerKernel()
+{
+    return NtClassifier().load(std::memory_order_relaxed)->name;
+}
+
+std::vector<const char*> newton::NtJSONIndexerKernels()
+{
+    std::vector<const char*> names;
+
+    for (const NtJSONClassifier& classifier : NtClassifiers())
+        names.push_back(classifier.name);
+
+    return names;
+}
+
+bool newton::NtSetJSONIndexerKernel(const char* name)
+{
+    for (const NtJSONClassifier& classifier : NtClassifiers()) {
+        if (strcmp(classifier.name, name) == 0) {
+            NtClassifier().store(&classifier, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtJSONIndexer.h
+ * \brief JSON structural indexer
+ * \author Hákon Hjaltalín
+ *
+ * This file contains the first parsing stage, which finds the structural
+ * characters of a JSON text in 64-byte blocks. It is internal to the
+ * library.
+ */
+
+#include "newton/base/NtDefs.h"
+
+#include <vector>
+
+namespace newton
+{
+
+/**
+ * \fn NtJSONIndexStructurals
+ * \brief Index structural characters
+ *
+ * Find the positions of every structural character outside of strings
+ * ('{', '}', '[', ']', ':' and ','), every opening quote and the first
+ * character of every other scalar. Uses AVX2 or SSE2 when the CPU has
+ * them.
+ *
+ * \param data JSON text
+ * \param len Length of text, at most 4 GiB
+ * \param index Output positions in ascending order
+ * \return False if the text ends inside a string
+ */
+bool NtJSONIndexStructurals(const char* data, size_t len, std::vector<uint32_t>& index);
+
+/**
+ * \fn NtJSONIndexerKernel
+ * \brief Get indexer kernel
+ *
+ * Get the name of the block classifier selected for this CPU.
+ *
+ * \return "avx2", "sse2" or "scalar"
+ */
+NT_EXPORT const char* NtJSONIndexerKernel();
+
+/**
+ * \fn NtJSONIndexerKernels
+ * \brief Get supported indexer kernels
+ *
+ * Get the names of the block classifiers this CPU supports, fastest first.
+ *
+ * \return Kernel names
+ */
+NT_EXPORT std::vector<const char*> NtJSONIndexerKernels();
+
+/**
+ * \fn NtSetJSONIndexerKernel
+ * \brief Set indexer kernel
+ *
+ * Use the named block classifier instead of the one selected for this CPU,
+ * so tests can cover every kernel.
+ *
+ * \param name Kernel name from NtJSONIndexerKernels()
+ * \return False if the CPU does not support the kernel
+ */
+NT_EXPORT bool NtSetJSONIndexerKernel(const char* name);
+
+}
@@ -0,0 +1,569 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtJSONLexer.h
+ * \brief JSON lexer
+ * \author Hákon Hjaltalín
+ *
+ * This file contains the token scanning functions shared by the JSON
+ * parsers. It is internal to the library.
+ */
+
+#include "newton/base/NtException.h"
+#include "newton/json/NtJSONNumber.h"
+#include "NtUTF8.h"
+
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <sstream>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#  define NT_JSON_LEXER_SSE2
+#  include <emmintrin.h>
+#endif
+
+namespace newton
+{
+
+static inline void NtJSONTrim(std::string_view str, int& line, size_t& pos)
+{
+    while (pos < str.size() && (
+            str[pos] == ' ' ||
+            str[pos] == '\r' ||
+            str[pos] == '\t' ||
+            str[pos] == '\n')) {
+        if (str[pos] == '\n')
+            ++line;
+
+        ++pos;
+    }
+}
+
+/**
+ * Throw a syntax error with the line number of a position in the text.
+ * Lines are only counted once something has gone wrong.
+ */
+[[noreturn]] static inline void NtThrowJSONError(const char* data, size_t len, size_t pos, const char* msg)
+{
+    int line = 1;
+
+    for (size_t i = 0; i < pos && i < len; ++i) {
+        if (data[i] == '\n')
+            ++line;
+    }
+
+    std::stringstream ss;
+    ss << "Line " << line << ": " << msg;
+    throw NtSyntaxError(ss.str());
+}
+
+/**
+ * Characters that may follow a number or literal.
+ */
+static inline bool NtIsJSONDelimiter(char c)
+{
+    switch (c) {
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\r':
+    case ',':
+    case ':':
+    case ']':
+    case '}':
+    case '"':
+        return true;
+    default:
+        return false;
+    }
+}
+
+static inline int NtJSONHexDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+
+    return -1;
+}
+
+static inline void NtAppendUTF8(char*& out, uint32_t cp)
+{
+    if (cp < 0x80) {
+        *out++ = static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        *out++ = static_cast<char>(0xC0 | (cp >> 6));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        *out++ = static_cast<char>(0xE0 | (cp >> 12));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        *out++ = static_cast<char>(0xF0 | (cp >> 18));
+        *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+/**
+ * Length of the prefix of str that is copied verbatim, up to the first
+ * quote, backslash or control character. A control character ends the run
+ * so callers can reject it, since JSON strings must escape them.
+ */
+static inline size_t NtJSONStringRunLength(const char* str, size_t len)
+{
+    size_t pos = 0;
+
+#ifdef NT_JSON_LEXER_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + pos));
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(v, control), control));
+        int mask = _mm_movemask_epi8(special);
+
+        if (mask) {
+#if defined(NT_COMPILER_GCC) || defined(NT_COMPILER_CLANG)
+            return pos + __builtin_ctz(mask);
+#else
+            break;
+#endif
+        }
+    }
+#endif
+
+    while (pos < len && str[pos] != '"' && str[pos] != '\\' && static_cast<unsigned char>(str[pos]) >= 0x20)
+        ++pos;
+
+    return pos;
+}
+
+/**
+ * Decode the four hex digits of a \u escape at src, joining a high
+ * surrogate with a \u escaped low surrogate right after it. A surrogate
+ * without its pair has no UTF-8 encoding and becomes U+FFFD, as in
+ * NtJSONReader. Returns the position after the escape, or nullptr if the
+ * digits are invalid.
+ */
+static inline const char* NtDecodeJSONUnicodeEscape(const char* src, const char* end, uint32_t& cp)
+{
+    if (end - src < 4)
+        return nullptr;
+
+    cp = 0;
+
+    for (int i = 0; i < 4; ++i) {
+        int digit = NtJSONHexDigit(src[i]);
+
+        if (digit < 0)
+            return nullptr;
+
+        cp = (cp << 4) | static_cast<uint32_t>(digit);
+    }
+
+    src += 4;
+
+    if (cp >= 0xD800 && cp <= 0xDBFF && end - src >= 6 && src[0] == '\\' && src[1] == 'u') {
+        uint32_t low = 0;
+
+        for (int i = 2; i < 6; ++i) {
+            int digit = NtJSONHexDigit(src[i]);
+
+            if (digit < 0) {
+                low = 0;
+                break;
+            }
+
+            low = (low << 4) | static_cast<uint32_t>(digit);
+        }
+
+        if (low >= 0xDC00 && low <= 0xDFFF) {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+            return src + 6;
+        }
+    }
+
+    if (cp >= 0xD800 && cp <= 0xDFFF)
+        cp = 0xFFFD;
+
+    return src;
+}
+
+/**
+ * Decode a string starting just after its opening quote. The output never
+ * grows larger than the input, so out must hold end - src bytes. Runs
+ * without escapes are validated as UTF-8 and copied in bulk, and control
+ * characters are rejected. Returns the position after the closing quote,
+ * or nullptr if the string is invalid or not terminated before end.
+ */
+static inline const char* NtUnescapeJSONString(const char* src, const char* end, char* out, size_t& len)
+{
+    char* start = out;
+
+    while (src < end) {
+        size_t run = NtJSONStringRunLength(src, static_cast<size_t>(end - src));
+
+        if (run) {
+            if (!NtValidateUTF8(src, run))
+                return nullptr;
+
+            memcpy(out, src, run);
+            out += run;
+            src += run;
+        }
+
+        if (src >= end)
+            return nullptr;
+
+        if (*src == '"') {
+            len = static_cast<size_t>(out - start);
+            return src + 1;
+        }
+
+        if (*src++ != '\\')
+            return nullptr;
+
+        if (src >= end)
+            return nullptr;
+
+        switch (*src++) {
+        case '"':
+            *out++ = '"';
+            break;
+        case '\\':
+            *out++ = '\\';
+            break;
+        case '/':
+            *out++ = '/';
+            break;
+        case 'b':
+            *out++ = '\b';
+            break;
+        case 'f':
+            *out++ = '\f';
+            break;
+        case 'n':
+            *out++ = '\n';
+            break;
+        case 'r':
+            *out++ = '\r';
+            break;
+        case 't':
+            *out++ = '\t';
+            break;
+        case 'u':
+            {
+                uint32_t cp;
+                src = NtDecodeJSONUnicodeEscape(src, end, cp);
+
+                if (!src)
+                    return nullptr;
+
+                NtAppendUTF8(out, cp);
+            }
+            break;
+        default:
+            return nullptr;
+        }
+    }
+
+    return nullptr;
+}
+
+static inline std::string NtParseJSONString(std::string_view str, int& line, size_t& pos)
+{
+    std::string ret = "";
+
+    if (pos >= str.size()) {
+        std::stringstream ss;
+        ss << "Line " << line << ": Invalid JSON string.";
+        throw NtSyntaxError(ss.str());
+    }
+
+    if (str[pos] == '"') {
+        ++pos;
+    }
+
+    const char* data = str.data();
+    const char* end = data + str.size();
+
+    while (pos < str.size()) {
+        size_t run = NtJSONStringRunLength(data + pos, str.size() - pos);
+
+        if (run) {
+            if (!NtValidateUTF8(data + pos, run)) {
+                std::stringstream ss;
+                ss << "Line " << line << ": Invalid UTF-8 in JSON string.";
+                throw NtSyntaxError(ss.str());
+            }
+
+            ret.append(data + pos, run);
+            pos += run;
+        }
+
+        if (pos >= str.size())
+            break;
+
+        char c = str[pos++];
+
+        if (c == '"')
+            return ret;
+
+        if (c != '\\') {
+            std::stringstream ss;
+            ss << "Line " << line << ": Unescaped control character in JSON string.";
+            throw NtSyntaxError(ss.str());
+        }
+
+        if (pos >= str.size()) {
+            std::stringstream ss;
+            ss << "Line " << line << ": Unterminated escape sequence.";
+            throw NtSyntaxError(ss.str());
+        }
+
+        switch (str[pos++]) {
+        case '"':
+            ret += '"';
+            break;
+        case '\\':
+            ret += '\\';
+            break;
+        case '/':
+            ret += '/';
+            break;
+        case 'b':
+            ret += '\b';
+            break;
+        case 'f':
+            ret += '\f';
+            break;
+        case 'n':
+            ret += '\n';
+            break;
+        case 'r':
+            ret += '\r';
+            break;
+        case 't':
+            ret += '\t';
+            break;
+        case 'u':
+            {
+                uint32_t cp;
+                const char* next = NtDecodeJSONUnicodeEscape(data + pos, end, cp);
+
+                if (!next) {
+                    std::stringstream ss;
+                    ss << "Line " << line << ": Invalid hex sequence.";
+                    throw NtSyntaxError(ss.str());
+                }
+
+                pos = static_cast<size_t>(next - data);
+
+                char buf[4];
+                char* out = buf;
+                NtAppendUTF8(out, cp);
+                ret.append(buf, static_cast<size_t>(out - buf));
+            }
+            break;
+        default:
+            {
+                std::stringstream ss;
+                ss << "Line " << line << ": Invalid escape sequence.";
+                throw NtSyntaxError(ss.str());
+            }
+            break;
+        }
+    }
+
+    std::stringstream ss;
+    ss << "Line " << line << ": Unterminated JSON string.";
+    throw NtSyntaxError(ss.str());
+}
+
+/**
+ * \struct NtJSONNumberValue
+ * \brief Scanned number
+ */
+struct NtJSONNumberValue
+{
+    NtJSONNumber::Kind kind;
+
+    union
+    {
+        int64_t integer;
+        uint64_t uinteger;
+        double number;
+    };
+
+    double toDouble() const
+    {
+        switch (kind) {
+        case NtJSONNumber::Kind::INTEGER:
+            return static_cast<double>(integer);
+        case NtJSONNumber::Kind::UNSIGNED:
+            return static_cast<double>(uinteger);
+        default:
+            return number;
+        }
+    }
+};
+
+static inline bool NtIsJSONDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/**
+ * Check whether a number outside the range of double is too large rather
+ * than too small, from its exponent and the position of its first
+ * significant digit.
+ */
+static inline bool NtIsJSONNumberOverflow(const char* data, size_t len)
+{
+    size_t p = data[0] == '-' ? 1 : 0;
+    long magnitude = 0;
+    bool isFraction = false;
+    bool isSignificant = false;
+
+    for (; p < len && data[p] != 'e' && data[p] != 'E'; ++p) {
+        if (data[p] == '.') {
+            isFraction = true;
+        } else if (!isSignificant && data[p] == '0') {
+            if (isFraction)
+                --magnitude;
+        } else {
+            isSignificant = true;
+
+            if (!isFraction)
+                ++magnitude;
+        }
+    }
+
+    long exponent = p < len ? strtol(data + p + 1, nullptr, 10) : 0;
+    return exponent > -magnitude;
+}
+
+/**
+ * Scan a number following the JSON grammar, starting at pos. Integers that
+ * fit in 64 bits keep an integer representation, everything else becomes
+ * a double. Numbers too small for a double become zero. Uses
+ * std::from_chars, so the result never depends on the locale. Returns
+ * false if the text is not a valid number or too large for a double.
+ */
+static inline bool NtScanJSONNumber(std::string_view str, size_t& pos, NtJSONNumberValue& out)
+{
+    const char* data = str.data();
+    size_t len = str.size();
+    size_t start = pos;
+    size_t p = pos;
+    bool isInteger = true;
+
+    if (p < len && data[p] == '-')
+        ++p;
+
+    if (p >= len || !NtIsJSONDigit(data[p]))
+        return false;
+
+    if (data[p] == '0') {
+        ++p;
+    } else {
+        while (p < len && NtIsJSONDigit(data[p]))
+            ++p;
+    }
+
+    if (p < len && data[p] == '.') {
+        ++p;
+        isInteger = false;
+
+        if (p >= len || !NtIsJSONDigit(data[p]))
+            return false;
+
+        while (p < len && NtIsJSONDigit(data[p]))
+            ++p;
+    }
+
+    if (p < len && (data[p] == 'e' || data[p] == 'E')) {
+        ++p;
+        isInteger = false;
+
+        if (p < len && (data[p] == '+' || data[p] == '-'))
+            ++p;
+
+        if (p >= len || !NtIsJSONDigit(data[p]))
+            return false;
+
+        while (p < len && NtIsJSONDigit(data[p]))
+            ++p;
+    }
+
+    pos = p;
+
+    if (isInteger) {
+        if (data[start] == '-') {
+            auto result = std::from_chars(data + start, data + p, out.integer);
+
+            if (result.ec == std::errc()) {
+                out.kind = NtJSONNumber::Kind::INTEGER;
+                return true;
+            }
+        } else {
+            auto result = std::from_chars(data + start, data + p, out.uinteger);
+
+            if (result.ec == std::errc()) {
+                out.kind = out.uinteger > static_cast<uint64_t>(INT64_MAX) ?
+                    NtJSONNumber::Kind::UNSIGNED : NtJSONNumber::Kind::INTEGER;
+                return true;
+            }
+        }
+    }
+
+    out.kind = NtJSONNumber::Kind::DOUBLE;
+
+#if defined(__cpp_lib_to_chars) || (defined(NT_COMPILER_GCC) && NT_COMPILER_VERSION_MAJOR >= 11)
+    auto result = std::from_chars(data + start, data + p, out.number);
+
+    if (result.ec == std::errc::result_out_of_range) {
+        if (NtIsJSONNumberOverflow(data + start, p - start))
+            return false;
+
+        out.number = data[start] == '-' ? -0.0 : 0.0;
+    }
+#else
+    out.number = strtod(std::string(data + start, p - start).c_str(), nullptr);
+#endif
+
+    return true;
+}
+
+static inline NtJSONNumberValue NtParseJSONNumber(std::string_view str, int& line, size_t& pos)
+{
+    NtJSONNumberValue ret;
+
+    if (!NtScanJSONNumber(str, pos, ret)) {
+        std::stringstream ss;
+        ss << "Line " << line << ": Invalid JSON number.";
+        throw NtSyntaxError(ss.str());
+    }
+
+    return ret;
+}
+
+}
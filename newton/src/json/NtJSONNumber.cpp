@@ -0,0 +1,61 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+#include "NtJSONLexer.h"
+using namespace newton;
+
+#include <cstdio>
+
+void NtJSONNumber::setValue(const char* value)
+{
+    std::string_view str(value ? value : "");
+    size_t pos = 0;
+    NtJSONNumberValue num;
+
+    if (!NtScanJSONNumber(str, pos, num)) {
+        m_kind = Kind::DOUBLE;
+        m_double = 0.0;
+        return;
+    }
+
+    m_kind = num.kind;
+
+    switch (num.kind) {
+    case Kind::INTEGER:
+        m_int = num.integer;
+        break;
+    case Kind::UNSIGNED:
+        m_uint = num.uinteger;
+        break;
+    default:
+        m_double = num.number;
+        break;
+    }
+}
+
+std::string NtJSONNumber::toString() const
+{
+    char buf[32];
+    char* end = buf;
+
+    switch (m_kind) {
+    case Kind::INTEGER:
+        end = std::to_chars(buf, buf + sizeof(buf), m_int).ptr;
+        break;
+    case Kind::UNSIGNED:
+        end = std::to_chars(buf, buf + sizeof(buf), m_uint).ptr;
+        break;
+    default:
+#if defined(__cpp_lib_to_chars) || (defined(NT_COMPILER_GCC) && NT_COMPILER_VERSION_MAJOR >= 11)
+        end = std::to_chars(buf, buf + sizeof(buf), m_double).ptr;
+#else
+        end = buf + snprintf(buf, sizeof(buf), "%.17g", m_double);
+#endif
+        break;
+    }
+
+    return std::string(buf, end);
+}
@@ -4,174 +4,17 @@
 // or go to https://opensource.org/licenses/MIT for more information.
 
 #include "newton/newton.h"
+#include "NtJSONLexer.h"
 using namespace newton;
 
 #include <string>
-#include <iostream>
+#include <string_view>
 #include <sstream>
 
-static NtJSONObject* NtParseJSONObject(std::string& str, int& line, int& pos);
-static NtJSONArray* NtParseJSONArray(std::string& str, int& line, int& pos);
+static NtJSONObject* NtParseJSONObject(std::string_view str, int& line, size_t& pos);
+static NtJSONArray* NtParseJSONArray(std::string_view str, int& line, size_t& pos);
 
-static void NtJSONTrim(std::string& str, int& line, int& pos)
-{
-    if (pos >= str.size()) {
-        return;
-    }
-
-    while (str[pos] == ' ' ||
-            str[pos] == '\r' ||
-            str[pos] == '\b' ||
-            str[pos] == '\n') {
-        if (str[pos] == '\n')
-            ++line;
-
-        ++pos;
-    }
-}
-
-static std::string NtParseJSONString(std::string& str, int& line, int& pos)
-{
-    std::string ret = "";
-
-    if (pos >= str.size()) {
-        std::stringstream ss;
-        ss << "Line " << line << ": Invalid JSON string.";
-        throw NtSyntaxError(ss.str());
-    }
-
-    if (str[pos] == '"') {
-        ++pos;
-    }
-
-    if (pos >= str.size()) {
-        std::stringstream ss;
-        ss << "Line " << line << ": Unterminated JSON string.";
-        throw NtSyntaxError(ss.str());
-    }
-
-    while (pos <= str.size() && str[pos] != '"') {
-        if (str[pos] == '\\') {
-            ++pos;
-
-            if (pos <= str.size()) {
-                std::stringstream ss;
-                ss << "Line " << line << ": Unterminated escape sequence.";
-                throw NtSyntaxError(ss.str());
-            }
-
-            switch (str[pos]) {
-            case '"':
-                ret += '"';
-                break;
-            case '\\':
-                ret += '\\';
-                break;
-            case '/':
-                ret += '/';
-                break;
-            case 'b':
-                ret += '\b';
-                break;
-            case 'f':
-                ret += '\f';
-                break;
-            case 'n':
-                ret += '\n';
-                break;
-            case 'r':
-                ret += '\r';
-                break;
-            case 't':
-                ret += '\t';
-                break;
-            case 'u':
-                {
-                    ++pos;
-
-                    if (pos + 4 >= str.size()) {
-                        std::stringstream ss;
-                        ss << "Line " << line << ": Invalid hex sequence.";
-                        throw NtSyntaxError(ss.str());
-                    }
-
-                    std::string hex = str.substr(pos, 4);
-                    pos += 3;
-
-                    std::stringstream ss;
-                    ss << std::hex << hex;
-                    uint16_t c;
-                    ss >> c;
-                    ret += c;
-                }
-                break;
-            default:
-                {
-                    std::stringstream ss;
-                    ss << "Line " << line << ": Invalid escape sequence.";
-                    throw NtSyntaxError(ss.str());
-                }
-                break;
-            }
-
-            ++pos;
-        } else {
-            ret += str[pos++];
-        }
-    }
-
-    if (str[pos] == '"') {
-        ++pos;
-    }
-
-    return ret;
-}
-
-static double NtParseJSONNumber(std::string& str, int& line, int& pos)
-{
-    double num = 0.0;
-    bool isDouble = false;
-    std::string part = "";
-
-    while (pos <= str.size() && (
-                str[pos] == '0' ||
-                str[pos] == '1' ||
-                str[pos] == '2' ||
-                str[pos] == '3' ||
-                str[pos] == '4' ||
-                str[pos] == '5' ||
-                str[pos] == '6' ||
-                str[pos] == '7' ||
-                str[pos] == '8' ||
-                str[pos] == '9' ||
-                str[pos] == '.' ||
-                str[pos] == 'e' ||
-                str[pos] == 'E' ||
-                str[pos] == '-' ||
-                str[pos] == '+')) {
-        if (str[pos] == '.' ||
-                str[pos] == 'e' ||
-                str[pos] == 'E' ||
-                str[pos] == '-' ||
-                str[pos] == '+')
-            isDouble = true;
-        part += str[pos++];
-    }
-    
-    std::stringstream ss(part);
-
-    if (isDouble) {
-        ss >> num;
-    } else {
-        int i = 0;
-        ss >> i;
-        num = static_cast<double>(i);
-    }
-
-    return num;
-}
-
-static NtJSONElement* NtParseJSONElement(std::string& str, int& line, int& pos)
+static NtJSONElement* NtParseJSONElement(std::string_view str, int& line, size_t& pos)
 {
     NtJSONTrim(str, line, pos);
 
@@ -211,12 +54,23 @@ static NtJSONElement* NtParseJSONElement(std::string& str, int& line, int& pos)
     case '7':
     case '8':
     case '9':
-    case '.':
     case '-':
         {
-            double num = NtParseJSONNumber(str, line, pos);
-            std::cout << "number " << num << std::endl;
-            NtJSONNumber* numobj = new NtJSONNumber(num);
+            NtJSONNumberValue num = NtParseJSONNumber(str, line, pos);
+            NtJSONNumber* numobj = nullptr;
+
+            switch (num.kind) {
+            case NtJSONNumber::Kind::INTEGER:
+                numobj = new NtJSONNumber(num.integer);
+                break;
+            case NtJSONNumber::Kind::UNSIGNED:
+                numobj = new NtJSONNumber(num.uinteger);
+                break;
+            default:
+                numobj = new NtJSONNumber(num.number);
+                break;
+            }
+
             return static_cast<NtJSONElement*>(numobj);
         }
         break;
@@ -230,7 +84,7 @@ static NtJSONElement* NtParseJSONElement(std::string& str, int& line, int& pos)
                 throw NtSyntaxError(ss.str());
             }
 
-            std::string sub = str.substr(pos, 4);
+            std::string_view sub = str.substr(pos, 4);
             
             if (sub == "true") {
                 pos += 4;
@@ -269,7 +123,7 @@ static NtJSONElement* NtParseJSONElement(std::string& str, int& line, int& pos)
     return nullptr;
 }
 
-static NtJSONArray* NtParseJSONArray(std::string& str, int& line, int& pos)
+static NtJSONArray* NtParseJSONArray(std::string_view str, int& line, size_t& pos)
 {
     NtJSONTrim(str, line, pos);
 
@@ -284,10 +138,10 @@ static NtJSONArray* NtParseJSONArray(std::string& str, int& line, int& pos)
     if (str[pos] == '[')
         ++pos;
 
-    while (pos <= str.size() && str[pos] != ']') {
+    while (pos < str.size() && str[pos] != ']') {
         NtJSONTrim(str, line, pos);
 
-        if (str[pos] == ']') {
+        if (pos >= str.size() || str[pos] == ']') {
             break;
         }
 
@@ -297,12 +151,14 @@ static NtJSONArray* NtParseJSONArray(std::string& str, int& line, int& pos)
             arr->add(elmt);
         }
 
-        if (str[pos] == ',') {
+        NtJSONTrim(str, line, pos);
+
+        if (pos < str.size() && str[pos] == ',') {
             ++pos;
         }
     }
 
-    if (str[pos] != ']') {
+    if (pos >= str.size() || str[pos] != ']') {
         std::stringstream ss;
         ss << "Line " << line << ": Invalid termination of JSON array.";
         throw NtSyntaxError(ss.str());
@@ -312,7 +168,7 @@ static NtJSONArray* NtParseJSONArray(std::string& str, int& line, int& pos)
     return arr;
 }
 
-static NtJSONObject* NtParseJSONObject(std::string& str, int& line, int& pos)
+static NtJSONObject* NtParseJSONObject(std::string_view str, int& line, size_t& pos)
 {
     NtJSONTrim(str, line, pos);
 
@@ -327,10 +183,10 @@ static NtJSONObject* NtParseJSONObject(std::string& str, int& line, int& pos)
     if (str[pos] == '{')
         ++pos;
 
-    while (pos <= str.size() && str[pos] != '}') {
+    while (pos < str.size() && str[pos] != '}') {
         NtJSONTrim(str, line, pos);
 
-        if (str[pos] == '}') {
+        if (pos >= str.size() || str[pos] == '}') {
             break;
         }
 
@@ -338,7 +194,7 @@ static NtJSONObject* NtParseJSONObject(std::string& str, int& line, int& pos)
             std::string name = NtParseJSONString(str, line, pos);
             NtJSONTrim(str, line, pos);
 
-            if (str[pos] != ':') {
+            if (pos >= str.size() || str[pos] != ':') {
                 std::stringstream ss;
                 ss << "Line " << line << ": Member name must be followed by ':' colon character.";
                 throw NtSyntaxError(ss.str());
@@ -358,7 +214,9 @@ static NtJSONObject* NtParseJSONObject(std::string& str, int& line, int& pos)
                 obj->add(name, elm);
             }
 
-            if (str[pos] == ',') {
+            NtJSONTrim(str, line, pos);
+
+            if (pos < str.size() && str[pos] == ',') {
                 ++pos;
             }
 
@@ -372,7 +230,7 @@ static NtJSONObject* NtParseJSONObject(std::string& str, int& line, int& pos)
         ++pos;
     }
 
-    if (str[pos] != '}') {
+    if (pos >= str.size() || str[pos] != '}') {
         std::stringstream ss;
         ss << "Line " << line << ": Invalid termination of JSON object.";
         throw NtSyntaxError(ss.str());
@@ -384,21 +242,36 @@ static NtJSONObject* NtParseJSONObject(std::string& str, int& line, int& pos)
 
 NtJSONObject* newton::NtParseJSON(const char* json)
 {
-    int pos = 0;
+    return NtParseJSON(std::string_view(json));
+}
+
+NtJSONObject* newton::NtParseJSON(const char* data, size_t len)
+{
+    return NtParseJSON(std::string_view(data, len));
+}
+
+NtJSONObject* newton::NtParseJSON(std::string_view json)
+{
+    size_t pos = 0;
     int line = 1;
-    std::string str = json;
 
-    if (str.size() == 0) {
+    if (json.size() == 0) {
         return new NtJSONObject();
     }
 
-    NtJSONTrim(str, line, pos);
+    NtJSONTrim(json, line, pos);
 
-    if (str[pos] != '{') {
+    if (pos >= json.size() || json[pos] != '{') {
         std::stringstream ss;
         ss << "Line " << line << ": JSON file must be a valid JSON object.";
         throw NtSyntaxError(ss.str());
     }
 
-    return NtParseJSONObject(str, line, pos);
+    return NtParseJSONObject(json, line, pos);
+}
+
+NtJSONObject* newton::NtParseJSONFile(const char* path)
+{
+    NtMappedFile file(path);
+    return NtParseJSON(file.view());
 }
@@ -0,0 +1,447 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+#include "NtJSONLexer.h"
+using namespace newton;
+
+static inline bool NtIsJSONNumberChar(char c)
+{
+    return (c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '-' || c == '+';
+}
+
+NtJSONReader::NtJSONReader(NtJSONHandler* handler)
+    : m_handler{ handler }
+{
+}
+
+void NtJSONReader::error(const char* msg) const
+{
+    std::stringstream ss;
+    ss << "Line " << m_line << ": " << msg;
+    throw NtSyntaxError(ss.str());
+}
+
+void NtJSONReader::reset()
+{
+    m_state = State::VALUE;
+    m_stack.clear();
+    m_token.clear();
+    m_literal = nullptr;
+    m_literalPos = 0;
+    m_escape = 0;
+    m_hex = 0;
+    m_highSurrogate = 0;
+    m_runStart = std::string::npos;
+    m_isKey = false;
+    m_needsSeparator = false;
+    m_isStopped = false;
+    m_line = 1;
+}
+
+bool NtJSONReader::feed(const char* data, size_t len)
+{
+    if (m_isStopped)
+        return false;
+
+    const char* p = data;
+    const char* end = data + len;
+
+    while (p < end) {
+        switch (m_state) {
+        case State::STRING:
+            {
+                if (m_escape) {
+                    escape(*p++);
+                    checkTokenSize();
+                    continue;
+                }
+
+                const char* run = p;
+                p += NtJSONStringRunLength(p, static_cast<size_t>(end - p));
+
+                if (p > run) {
+                    flushSurrogate();
+
+                    if (m_runStart == std::string::npos)
+                        m_runStart = m_token.size();
+
+                    m_token.append(run, p - run);
+                    checkTokenSize();
+                }
+
+                if (p == end)
+                    continue;
+
+                // A run may have been split across feeds, so it is only
+                // validated once it ends.
+                if (m_runStart != std::string::npos) {
+                    if (!NtValidateUTF8(m_token.data() + m_runStart, m_token.size() - m_runStart))
+                        error("Invalid UTF-8 in JSON string.");
+
+                    m_runStart = std::string::npos;
+                }
+
+                if (*p == '\\') {
+                    ++p;
+                    m_escape = 1;
+                    continue;
+                }
+
+                if (*p++ != '"')
+                    error("Unescaped control character in JSON string.");
+
+                flushSurrogate();
+
+                if (!endString()) {
+                    m_isStopped = true;
+                    return false;
+                }
+            }
+            continue;
+        case State::NUMBER:
+            {
+                const char* run = p;
+
+                while (p < end && NtIsJSONNumberChar(*p))
+                    ++p;
+
+                m_token.append(run, p - run);
+                checkTokenSize();
+
+                if (p < end && !endNumber()) {
+                    m_isStopped = true;
+                    return false;
+                }
+            }
+            continue;
+        case State::LITERAL:
+            if (*p++ != m_literal[m_literalPos++])
+                error("Invalid JSON value.");
+
+            if (m_literal[m_literalPos] == '\0') {
+                bool ret = true;
+
+                if (m_literal[0] == 'n')
+                    ret = m_handler->null();
+                else
+                    ret = m_handler->boolean(m_literal[0] == 't');
+
+                endValue(true);
+
+                if (!ret) {
+                    m_isStopped = true;
+                    return false;
+                }
+            }
+            continue;
+        default:
+            break;
+        }
+
+        char c = *p++;
+
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            if (c == '\n')
+                ++m_line;
+
+            m_needsSeparator = false;
+            continue;
+        }
+
+        bool ret = true;
+
+        switch (m_state) {
+        case State::DONE:
+            if (!m_isMultiple)
+                error("Unexpected data after JSON value.");
+
+            if (m_needsSeparator)
+                error("JSON values must be separated by whitespace.");
+
+            ret = startValue(c);
+            break;
+        case State::VALUE:
+            ret = startValue(c);
+            break;
+        case State::ARRAY_FIRST:
+            if (c == ']') {
+                m_stack.pop_back();
+                ret = m_handler->endArray();
+                endValue();
+            } else {
+                ret = startValue(c);
+            }
+            break;
+        case State::OBJECT_FIRST:
+        case State::KEY:
+            if (c == '}' && m_state == State::OBJECT_FIRST) {
+                m_stack.pop_back();
+                ret = m_handler->endObject();
+                endValue();
+            } else if (c == '"') {
+                m_token.clear();
+                m_isKey = true;
+                m_state = State::STRING;
+            } else {
+                error("Invalid member in JSON object.");
+            }
+            break;
+        case State::COLON:
+            if (c != ':')
+                error("Member name must be followed by ':' colon character.");
+
+            m_state = State::VALUE;
+            break;
+        case State::AFTER_VALUE:
+            if (m_stack.back() == '{') {
+                if (c == ',') {
+                    m_state = State::KEY;
+                } else if (c == '}') {
+                    m_stack.pop_back();
+                    ret = m_handler->endObject();
+                    endValue();
+                } else {
+                    error("Invalid termination of JSON object.");
+                }
+            } else {
+                if (c == ',') {
+                    m_state = State::VALUE;
+                } else if (c == ']') {
+                    m_stack.pop_back();
+                    ret = m_handler->endArray();
+                    endValue();
+                } else {
+                    error("Invalid termination of JSON array.");
+                }
+            }
+            break;
+        default:
+            break;
+        }
+
+        if (!ret) {
+            m_isStopped = true;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool NtJSONReader::finish()
+{
+    if (m_isStopped) {
+        reset();
+        return false;
+    }
+
+    if (m_state == State::NUMBER && !endNumber()) {
+        reset();
+        return false;
+    }
+
+    bool isComplete = m_state == State::DONE ||
+        (m_isMultiple && m_state == State::VALUE && m_stack.empty());
+
+    if (!isComplete)
+        error("Unexpected end of JSON text.");
+
+    reset();
+    return true;
+}
+
+bool NtJSONReader::startValue(char c)
+{
+    switch (c) {
+    case '{':
+    case '[':
+        if (m_stack.size() >= m_maxDepth)
+            error("Maximum nesting depth exceeded.");
+
+        m_stack.push_back(c);
+
+        if (c == '{') {
+            m_state = State::OBJECT_FIRST;
+            return m_handler->startObject();
+        }
+
+        m_state = State::ARRAY_FIRST;
+        return m_handler->startArray();
+    case '"':
+        m_token.clear();
+        m_isKey = false;
+        m_state = State::STRING;
+        return true;
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+    case '-':
+        m_token.assign(1, c);
+        m_state = State::NUMBER;
+        return true;
+    case 't':
+        m_literal = "true";
+        break;
+    case 'f':
+        m_literal = "false";
+        break;
+    case 'n':
+        m_literal = "null";
+        break;
+    default:
+        error("Invalid JSON value.");
+    }
+
+    m_literalPos = 1;
+    m_state = State::LITERAL;
+    return true;
+}
+
+bool NtJSONReader::endValue(bool isScalar)
+{
+    m_state = m_stack.empty() ? State::DONE : State::AFTER_VALUE;
+    m_needsSeparator = isScalar && m_stack.empty();
+    return true;
+}
+
+void NtJSONReader::checkTokenSize() const
+{
+    if (m_token.size() > m_maxTokenSize)
+        error("Maximum token size exceeded.");
+}
+
+bool NtJSONReader::endString()
+{
+    if (m_isKey) {
+        m_state = State::COLON;
+        return m_handler->key(m_token);
+    }
+
+    endValue(true);
+    return m_handler->string(m_token);
+}
+
+bool NtJSONReader::endNumber()
+{
+    size_t pos = 0;
+    NtJSONNumberValue num;
+
+    if (!NtScanJSONNumber(m_token, pos, num) || pos != m_token.size())
+        error("Invalid JSON number.");
+
+    endValue(true);
+
+    switch (num.kind) {
+    case NtJSONNumber::Kind::INTEGER:
+        return m_handler->integer(num.integer);
+    case NtJSONNumber::Kind::UNSIGNED:
+        return m_handler->uinteger(num.uinteger);
+    default:
+        return m_handler->number(num.number);
+    }
+}
+
+void NtJSONReader::escape(char c)
+{
+    if (m_escape >= 2) {
+        int digit = NtJSONHexDigit(c);
+
+        if (digit < 0)
+            error("Invalid hex sequence.");
+
+        m_hex = (m_hex << 4) | static_cast<uint32_t>(digit);
+
+        if (++m_escape == 6) {
+            m_escape = 0;
+            appendCodePoint(m_hex);
+        }
+
+        return;
+    }
+
+    m_escape = 0;
+
+    if (c == 'u') {
+        m_escape = 2;
+        m_hex = 0;
+        return;
+    }
+
+    flushSurrogate();
+
+    switch (c) {
+    case '"':
+        m_token += '"';
+        break;
+    case '\\':
+        m_token += '\\';
+        break;
+    case '/':
+        m_token += '/';
+        break;
+    case 'b':
+        m_token += '\b';
+        break;
+    case 'f':
+        m_token += '\f';
+        break;
+    case 'n':
+        m_token += '\n';
+        break;
+    case 'r':
+        m_token += '\r';
+        break;
+    case 't':
+        m_token += '\t';
+        break;
+    default:
+        error("Invalid escape sequence.");
+    }
+}
+
+void NtJSONReader::flushSurrogate()
+{
+    // A high surrogate without its pair has no UTF-8 encoding and becomes
+    // U+FFFD.
+    if (m_highSurrogate) {
+        char buf[4];
+        char* out = buf;
+        NtAppendUTF8(out, 0xFFFD);
+        m_token.append(buf, out - buf);
+        m_highSurrogate = 0;
+    }
+}
+
+void NtJSONReader::appendCodePoint(uint32_t cp)
+{
+    char buf[4];
+    char* out = buf;
+
+    if (m_highSurrogate && cp >= 0xDC00 && cp <= 0xDFFF) {
+        cp = 0x10000 + ((m_highSurrogate - 0xD800) << 10) + (cp - 0xDC00);
+        m_highSurrogate = 0;
+    } else {
+        flushSurrogate();
+
+        if (cp >= 0xD800 && cp <= 0xDBFF) {
+            m_highSurrogate = cp;
+            return;
+        }
+
+        if (cp >= 0xDC00 && cp <= 0xDFFF)
+            cp = 0xFFFD;
+    }
+
+    NtAppendUTF8(out, cp);
+    m_token.append(buf, out - buf);
+}
@@ -0,0 +1,354 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+using namespace newton;
+
+using Step = NtJSONSelector::Step;
+
+/**
+ * Parse an array index without sign or leading zeros.
+ */
+static size_t NtParseSelectorIndex(std::string_view str)
+{
+    if (str.empty() || str.size() > 19 || (str.size() > 1 && str[0] == '0'))
+        return NtJSONSelector::npos;
+
+    size_t ret = 0;
+
+    for (char c : str) {
+        if (c < '0' || c > '9')
+            return NtJSONSelector::npos;
+
+        ret = ret * 10 + static_cast<size_t>(c - '0');
+    }
+
+    return ret;
+}
+
+/**
+ * \struct NtSelectTree
+ * \brief Element tree access for selector evaluation
+ */
+struct NtSelectTree
+{
+    using Node = NtJSONElement*;
+
+    static bool isValid(Node node) { return node != nullptr; }
+    static bool isObject(Node node) { return node->type() == NtJSONElement::Type::OBJECT; }
+    static bool isArray(Node node) { return node->type() == NtJSONElement::Type::ARRAY; }
+
+    static Node member(Node node, std::string_view name)
+    {
+        return static_cast<NtJSONObject*>(node)->get(name);
+    }
+
+    static Node element(Node node, size_t idx)
+    {
+        NtJSONArray* arr = static_cast<NtJSONArray*>(node);
+        return idx < arr->count() ? arr->get(idx) : nullptr;
+    }
+
+    template <typename F>
+    static bool children(Node node, F&& fn)
+    {
+        if (isObject(node)) {
+            for (auto& member : *static_cast<NtJSONObject*>(node)) {
+                if (member.second && fn(member.second))
+                    return true;
+            }
+        } else if (isArray(node)) {
+            for (auto* child : *static_cast<NtJSONArray*>(node)) {
+                if (child && fn(child))
+                    return true;
+            }
+        }
+
+        return false;
+    }
+};
+
+/**
+ * \struct NtSelectHandle
+ * \brief Document value and cursor access for selector evaluation
+ */
+template <typename T>
+struct NtSelectHandle
+{
+    using Node = T;
+
+    static bool isValid(const Node& node) { return node.isValid(); }
+    static bool isObject(const Node& node) { return node.isObject(); }
+    static bool isArray(const Node& node) { return node.isArray(); }
+    static Node member(const Node& node, std::string_view name) { return node.get(name); }
+    static Node element(const Node& node, size_t idx) { return node.get(idx); }
+
+    template <typename F>
+    static bool children(const Node& node, F&& fn)
+    {
+        for (auto it = node.begin(); it != node.end(); ++it) {
+            if (fn(*it))
+                return true;
+        }
+
+        return false;
+    }
+};
+
+template <typename A>
+static bool NtSelectStep(const std::vector<Step>& steps, size_t i, const typename A::Node& node,
+    std::vector<typename A::Node>& out, bool isFirstOnly);
+
+/**
+ * Apply a recursive descent step to a value and everything below it.
+ */
+template <typename A>
+static bool NtSelectDescendants(const std::vector<Step>& steps, size_t i, const typename A::Node& node,
+    std::vector<typename A::Node>& out, bool isFirstOnly)
+{
+    if (A::isObject(node)) {
+        typename A::Node child = A::member(node, steps[i].name);
+
+        if (A::isValid(child) && NtSelectStep<A>(steps, i + 1, child, out, isFirstOnly))
+            return true;
+    }
+
+    return A::children(node, [&](const typename A::Node& child) {
+        return NtSelectDescendants<A>(steps, i, child, out, isFirstOnly);
+    });
+}
+
+/**
+ * Apply step i and the steps after it to a value. Returns true once the
+ * search can stop.
+ */
+template <typename A>
+static bool NtSelectStep(const std::vector<Step>& steps, size_t i, const typename A::Node& node,
+    std::vector<typename A::Node>& out, bool isFirstOnly)
+{
+    if (i == steps.size()) {
+        out.push_back(node);
+        return isFirstOnly;
+    }
+
+    const Step& step = steps[i];
+    typename A::Node child{};
+
+    switch (step.kind) {
+    case Step::Kind::MEMBER:
+        if (A::isObject(node))
+            child = A::member(node, step.name);
+        break;
+    case Step::Kind::INDEX:
+        if (A::isArray(node))
+            child = A::element(node, step.index);
+        break;
+    case Step::Kind::TOKEN:
+        if (A::isObject(node))
+            child = A::member(node, step.name);
+        else if (A::isArray(node) && step.index != NtJSONSelector::npos)
+            child = A::element(node, step.index);
+        break;
+    case Step::Kind::WILDCARD:
+        return A::children(node, [&](const typename A::Node& c) {
+            return NtSelectStep<A>(steps, i + 1, c, out, isFirstOnly);
+        });
+    case Step::Kind::DESCENDANT:
+        return NtSelectDescendants<A>(steps, i, node, out, isFirstOnly);
+    }
+
+    if (!A::isValid(child))
+        return false;
+
+    return NtSelectStep<A>(steps, i + 1, child, out, isFirstOnly);
+}
+
+template <typename A>
+static std::vector<typename A::Node> NtSelect(const std::vector<Step>& steps, const typename A::Node& root, bool isFirstOnly)
+{
+    std::vector<typename A::Node> ret;
+
+    if (A::isValid(root))
+        NtSelectStep<A>(steps, 0, root, ret, isFirstOnly);
+
+    return ret;
+}
+
+NtJSONSelector::NtJSONSelector(std::string_view expr)
+{
+    if (!expr.empty() && expr[0] == '$')
+        compilePath(expr);
+    else
+        compilePointer(expr);
+}
+
+void NtJSONSelector::compilePointer(std::string_view expr)
+{
+    if (expr.empty())
+        return;
+
+    if (expr[0] != '/')
+        throw NtSyntaxError("JSON pointer must start with '/'.");
+
+    size_t pos = 1;
+
+    while (true) {
+        size_t end = expr.find('/', pos);
+
+        if (end == std::string_view::npos)
+            end = expr.size();
+
+        Step step{ Step::Kind::TOKEN, std::string(), npos };
+
+        for (size_t i = pos; i < end; ++i) {
+            if (expr[i] != '~') {
+                step.name += expr[i];
+                continue;
+            }
+
+            if (i + 1 < end && expr[i + 1] == '0')
+                step.name += '~';
+            else if (i + 1 < end && expr[i + 1] == '1')
+                step.name += '/';
+            else
+                throw NtSyntaxError("Invalid escape in JSON pointer.");
+
+            ++i;
+        }
+
+        step.index = NtParseSelectorIndex(step.name);
+        m_steps.push_back(std::move(step));
+
+        if (end == expr.size())
+            break;
+
+        pos = end + 1;
+    }
+}
+
+void NtJSONSelector::compilePath(std::string_view expr)
+{
+    size_t pos = 1;
+
+    auto error = [&expr, &pos](const char* msg) {
+        throw NtSyntaxError(std::string(msg) + " in JSON path '" + std::string(expr) +
+            "' at position " + std::to_string(pos) + ".");
+    };
+
+    auto readName = [&expr, &pos]() {
+        size_t start = pos;
+
+        while (pos < expr.size() && expr[pos] != '.' && expr[pos] != '[')
+            ++pos;
+
+        return std::string(expr.substr(start, pos - start));
+    };
+
+    while (pos < expr.size()) {
+        if (expr[pos] == '.') {
+            ++pos;
+
+            if (pos < expr.size() && expr[pos] == '.') {
+                ++pos;
+                std::string name = readName();
+
+                if (name.empty() || name == "*")
+                    error("Expected member name after '..'");
+
+                m_steps.push_back({ Step::Kind::DESCENDANT, std::move(name), npos });
+            } else if (pos < expr.size() && expr[pos] == '*') {
+                ++pos;
+                m_steps.push_back({ Step::Kind::WILDCARD, std::string(), npos });
+            } else {
+                std::string name = readName();
+
+                if (name.empty())
+                    error("Expected member name after '.'");
+
+                m_steps.push_back({ Step::Kind::MEMBER, std::move(name), npos });
+            }
+        } else if (expr[pos] == '[') {
+            ++pos;
+
+            if (pos >= expr.size())
+                error("Unterminated bracket");
+
+            char c = expr[pos];
+
+            if (c == '*') {
+                ++pos;
+                m_steps.push_back({ Step::Kind::WILDCARD, std::string(), npos });
+            } else if (c == '\'' || c == '"') {
+                std::string name;
+                ++pos;
+
+                while (pos < expr.size() && expr[pos] != c) {
+                    if (expr[pos] == '\\' && pos + 1 < expr.size())
+                        ++pos;
+
+                    name += expr[pos++];
+                }
+
+                if (pos >= expr.size())
+                    error("Unterminated member name");
+
+                ++pos;
+                m_steps.push_back({ Step::Kind::MEMBER, std::move(name), npos });
+            } else {
+                size_t start = pos;
+
+                while (pos < expr.size() && expr[pos] != ']')
+                    ++pos;
+
+                size_t index = NtParseSelectorIndex(expr.substr(start, pos - start));
+
+                if (index == npos)
+                    error("Invalid array index");
+
+                m_steps.push_back({ Step::Kind::INDEX, std::string(), index });
+            }
+
+            if (pos >= expr.size() || expr[pos] != ']')
+                error("Expected ']'");
+
+            ++pos;
+        } else {
+            error("Unexpected character");
+        }
+    }
+}
+
+std::vector<NtJSONElement*> NtJSONSelector::select(NtJSONElement* root) const
+{
+    return NtSelect<NtSelectTree>(m_steps, root, false);
+}
+
+std::vector<NtJSONValue> NtJSONSelector::select(const NtJSONValue& root) const
+{
+    return NtSelect<NtSelectHandle<NtJSONValue>>(m_steps, root, false);
+}
+
+std::vector<NtJSONCursor> NtJSONSelector::select(const NtJSONCursor& root) const
+{
+    return NtSelect<NtSelectHandle<NtJSONCursor>>(m_steps, root, false);
+}
+
+NtJSONElement* NtJSONSelector::first(NtJSONElement* root) const
+{
+    auto ret = NtSelect<NtSelectTree>(m_steps, root, true);
+    return ret.empty() ? nullptr : ret.front();
+}
+
+NtJSONValue NtJSONSelector::first(const NtJSONValue& root) const
+{
+    auto ret = NtSelect<NtSelectHandle<NtJSONValue>>(m_steps, root, true);
+    return ret.empty() ? NtJSONValue() : ret.front();
+}
+
+NtJSONCursor NtJSONSelector::first(const NtJSONCursor& root) const
+{
+    auto ret = NtSelect<NtSelectHandle<NtJSONCursor>>(m_steps, root, true);
+    return ret.empty() ? NtJSONCursor() : ret.front();
+}
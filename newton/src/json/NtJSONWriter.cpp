@@ -0,0 +1,404 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+using namespace newton;
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#  define NT_JSON_SSE2
+#  include <emmintrin.h>
+#endif
+
+/**
+ * Length of the prefix of str that can be copied without escaping.
+ */
+static inline size_t NtJSONSafeLength(const char* str, size_t len)
+{
+    size_t pos = 0;
+
+#ifdef NT_JSON_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + pos));
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(v, control), control));
+        int mask = _mm_movemask_epi8(special);
+
+        if (mask) {
+#if defined(NT_COMPILER_GCC) || defined(NT_COMPILER_CLANG)
+            return pos + __builtin_ctz(mask);
+#else
+            break;
+#endif
+        }
+    }
+#endif
+
+    for (; pos < len; ++pos) {
+        unsigned char c = static_cast<unsigned char>(str[pos]);
+
+        if (c == '"' || c == '\\' || c < 0x20)
+            break;
+    }
+
+    return pos;
+}
+
+void NtJSONWriter::escape(std::string_view str)
+{
+    static const char* hex = "0123456789abcdef";
+
+    m_buffer += '"';
+
+    const char* data = str.data();
+    size_t len = str.size();
+
+    while (len) {
+        size_t safe = NtJSONSafeLength(data, len);
+        m_buffer.append(data, safe);
+        data += safe;
+        len -= safe;
+
+        if (!len)
+            break;
+
+        unsigned char c = static_cast<unsigned char>(*data++);
+        --len;
+
+        switch (c) {
+        case '"':
+            m_buffer += "\\\"";
+            break;
+        case '\\':
+            m_buffer += "\\\\";
+            break;
+        case '\b':
+            m_buffer += "\\b";
+            break;
+        case '\f':
+            m_buffer += "\\f";
+            break;
+        case '\n':
+            m_buffer += "\\n";
+            break;
+        case '\r':
+            m_buffer += "\\r";
+            break;
+        case '\t':
+            m_buffer += "\\t";
+            break;
+        default:
+            {
+                char buf[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+                m_buffer.append(buf, sizeof(buf));
+            }
+            break;
+        }
+    }
+
+    m_buffer += '"';
+}
+
+void NtJSONWriter::newline()
+{
+    m_buffer += '\n';
+    m_buffer.append(m_counts.size() * m_indent, ' ');
+}
+
+void NtJSONWriter::beginValue()
+{
+    if (m_isAfterKey) {
+        m_isAfterKey = false;
+        return;
+    }
+
+    if (m_counts.empty())
+        return;
+
+    if (m_counts.back()++)
+        m_buffer += ',';
+
+    if (m_isPretty)
+        newline();
+}
+
+bool NtJSONWriter::startObject()
+{
+    beginValue();
+    m_buffer += '{';
+    m_counts.push_back(0);
+    return true;
+}
+
+bool NtJSONWriter::endObject()
+{
+    size_t count = m_counts.back();
+    m_counts.pop_back();
+
+    if (m_isPretty && count)
+        newline();
+
+    m_buffer += '}';
+    checkFlush();
+    return true;
+}
+
+bool NtJSONWriter::startArray()
+{
+    beginValue();
+    m_buffer += '[';
+    m_counts.push_back(0);
+    return true;
+}
+
+bool NtJSONWriter::endArray()
+{
+    size_t count = m_counts.back();
+    m_counts.pop_back();
+
+    if (m_isPretty && count)
+        newline();
+
+    m_buffer += ']';
+    checkFlush();
+    return true;
+}
+
+bool NtJSONWriter::key(std::string_view name)
+{
+    beginValue();
+    escape(name);
+    m_buffer += m_isPretty ? ": " : ":";
+    m_isAfterKey = true;
+    return true;
+}
+
+bool NtJSONWriter::string(std::string_view value)
+{
+    beginValue();
+    escape(value);
+    checkFlush();
+    return true;
+}
+
+bool NtJSONWriter::number(double value)
+{
+    beginValue();
+
+    if (!std::isfinite(value)) {
+        m_buffer += "null";
+        return true;
+    }
+
+    char buf[32];
+
+#if defined(__cpp_lib_to_chars) || (defined(NT_COMPILER_GCC) && NT_COMPILER_VERSION_MAJOR >= 11)
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    m_buffer.append(buf, result.ptr - buf);
+#else
+    int len = snprintf(buf, sizeof(buf), "%.17g", value);
+    m_buffer.append(buf, len);
+#endif
+
+    checkFlush();
+    return true;
+}
+
+bool NtJSONWriter::integer(int64_t value)
+{
+    beginValue();
+
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    m_buffer.append(buf, result.ptr - buf);
+
+    checkFlush();
+    return true;
+}
+
+bool NtJSONWriter::uinteger(uint64_t value)
+{
+    beginValue();
+
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    m_buffer.append(buf, result.ptr - buf);
+
+    checkFlush();
+    return true;
+}
+
+bool NtJSONWriter::boolean(bool value)
+{
+    beginValue();
+    m_buffer += value ? "true" : "false";
+    return true;
+}
+
+bool NtJSONWriter::null()
+{
+    beginValue();
+    m_buffer += "null";
+    return true;
+}
+
+void NtJSONWriter::raw(std::string_view json)
+{
+    beginValue();
+    m_buffer.append(json.data(), json.size());
+    checkFlush();
+}
+
+void NtJSONWriter::write(const NtJSONElement* element)
+{
+    if (!element) {
+        null();
+        return;
+    }
+
+    switch (element->type()) {
+    case NtJSONElement::Type::OBJECT:
+        startObject();
+
+        for (auto& member : *static_cast<const NtJSONObject*>(element)) {
+            key(member.first);
+            write(member.second);
+        }
+
+        endObject();
+        break;
+    case NtJSONElement::Type::ARRAY:
+        startArray();
+
+        for (auto* child : *static_cast<const NtJSONArray*>(element))
+            write(child);
+
+        endArray();
+        break;
+    case NtJSONElement::Type::STRING:
+        string(static_cast<const NtJSONString*>(element)->value());
+        break;
+    case NtJSONElement::Type::NUMBER:
+        {
+            const NtJSONNumber* num = static_cast<const NtJSONNumber*>(element);
+
+            switch (num->kind()) {
+            case NtJSONNumber::Kind::INTEGER:
+                integer(num->toInt64());
+                break;
+            case NtJSONNumber::Kind::UNSIGNED:
+                uinteger(num->toUInt64());
+                break;
+            default:
+                number(num->value());
+                break;
+            }
+        }
+        break;
+    case NtJSONElement::Type::BOOLEAN:
+        boolean(static_cast<const NtJSONBoolean*>(element)->value());
+        break;
+    case NtJSONElement::Type::NUL:
+        null();
+        break;
+    }
+}
+
+void NtJSONWriter::write(const NtJSONValue& value)
+{
+    if (!value.isValid()) {
+        null();
+        return;
+    }
+
+    switch (value.type()) {
+    case NtJSONElement::Type::OBJECT:
+        startObject();
+
+        for (auto it = value.begin(); it != value.end(); ++it) {
+            key(it.key());
+            write(*it);
+        }
+
+        endObject();
+        break;
+    case NtJSONElement::Type::ARRAY:
+        startArray();
+
+        for (auto it = value.begin(); it != value.end(); ++it)
+            write(*it);
+
+        endArray();
+        break;
+    case NtJSONElement::Type::STRING:
+        string(value.asString());
+        break;
+    case NtJSONElement::Type::NUMBER:
+        switch (value.numberKind()) {
+        case NtJSONNumber::Kind::INTEGER:
+            integer(value.asInt64());
+            break;
+        case NtJSONNumber::Kind::UNSIGNED:
+            uinteger(value.asUInt64());
+            break;
+        default:
+            number(value.asNumber());
+            break;
+        }
+        break;
+    case NtJSONElement::Type::BOOLEAN:
+        boolean(value.asBoolean());
+        break;
+    case NtJSONElement::Type::NUL:
+        null();
+        break;
+    }
+}
+
+void NtJSONWriter::flush()
+{
+    if (m_sink && !m_buffer.empty()) {
+        m_sink(m_buffer.data(), m_buffer.size());
+        m_buffer.clear();
+    }
+}
+
+std::string NtJSONWriter::take()
+{
+    std::string ret = std::move(m_buffer);
+    reset();
+    return ret;
+}
+
+void NtJSONWriter::reset()
+{
+    m_buffer.clear();
+    m_counts.clear();
+    m_isAfterKey = false;
+}
+
+std::string newton::NtSerializeJSON(const NtJSONElement* element, bool isPretty)
+{
+    NtJSONWriter writer;
+    writer.setPretty(isPretty);
+    writer.write(element);
+    return writer.take();
+}
+
+std::string newton::NtSerializeJSON(const NtJSONValue& value, bool isPretty)
+{
+    NtJSONWriter writer;
+    writer.setPretty(isPretty);
+    writer.write(value);
+    return writer.take();
+}
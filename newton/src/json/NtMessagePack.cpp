@@ -0,0 +1,334 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+#include "NtJSONBinary.h"
+#include "NtUTF8.h"
+using namespace newton;
+
+/**
+ * \class NtMessagePackEncoder
+ * \brief MessagePack encoder
+ */
+class NtMessagePackEncoder
+{
+public:
+    void nil() { m_out += static_cast<char>(0xC0); }
+    void boolean(bool value) { m_out += static_cast<char>(value ? 0xC3 : 0xC2); }
+
+    void integer(int64_t value)
+    {
+        if (value >= 0) {
+            uinteger(static_cast<uint64_t>(value));
+        } else if (value >= -32) {
+            m_out += static_cast<char>(value);
+        } else if (value >= INT8_MIN) {
+            m_out += static_cast<char>(0xD0);
+            m_out += static_cast<char>(value);
+        } else if (value >= INT16_MIN) {
+            m_out += static_cast<char>(0xD1);
+            NtAppendBigEndian(m_out, static_cast<uint16_t>(value));
+        } else if (value >= INT32_MIN) {
+            m_out += static_cast<char>(0xD2);
+            NtAppendBigEndian(m_out, static_cast<uint32_t>(value));
+        } else {
+            m_out += static_cast<char>(0xD3);
+            NtAppendBigEndian(m_out, static_cast<uint64_t>(value));
+        }
+    }
+
+    void uinteger(uint64_t value)
+    {
+        if (value < 0x80) {
+            m_out += static_cast<char>(value);
+        } else if (value <= UINT8_MAX) {
+            m_out += static_cast<char>(0xCC);
+            m_out += static_cast<char>(value);
+        } else if (value <= UINT16_MAX) {
+            m_out += static_cast<char>(0xCD);
+            NtAppendBigEndian(m_out, static_cast<uint16_t>(value));
+        } else if (value <= UINT32_MAX) {
+            m_out += static_cast<char>(0xCE);
+            NtAppendBigEndian(m_out, static_cast<uint32_t>(value));
+        } else {
+            m_out += static_cast<char>(0xCF);
+            NtAppendBigEndian(m_out, value);
+        }
+    }
+
+    void number(double value)
+    {
+        m_out += static_cast<char>(0xCB);
+        NtAppendBigEndian(m_out, NtDoubleBits(value));
+    }
+
+    void string(std::string_view value)
+    {
+        size_t len = value.size();
+
+        if (len < 32) {
+            m_out += static_cast<char>(0xA0 | len);
+        } else if (len <= UINT8_MAX) {
+            m_out += static_cast<char>(0xD9);
+            m_out += static_cast<char>(len);
+        } else if (len <= UINT16_MAX) {
+            m_out += static_cast<char>(0xDA);
+            NtAppendBigEndian(m_out, static_cast<uint16_t>(len));
+        } else {
+            m_out += static_cast<char>(0xDB);
+            NtAppendBigEndian(m_out, static_cast<uint32_t>(len));
+        }
+
+        m_out.append(value.data(), len);
+    }
+
+    void array(size_t count) { header(count, 0x90, 0xDC); }
+    void map(size_t count) { header(count, 0x80, 0xDE); }
+
+    std::string take() { return std::move(m_out); }
+
+private:
+    void header(size_t count, unsigned char fix, unsigned char type16)
+    {
+        if (count < 16) {
+            m_out += static_cast<char>(fix | count);
+        } else if (count <= UINT16_MAX) {
+            m_out += static_cast<char>(type16);
+            NtAppendBigEndian(m_out, static_cast<uint16_t>(count));
+        } else {
+            m_out += static_cast<char>(type16 + 1);
+            NtAppendBigEndian(m_out, static_cast<uint32_t>(count));
+        }
+    }
+
+private:
+    std::string m_out;
+};
+
+/**
+ * \class NtMessagePackDecoder
+ * \brief MessagePack decoder
+ */
+class NtMessagePackDecoder
+{
+public:
+    NtMessagePackDecoder(const char* data, size_t len, NtJSONHandler* handler)
+        : m_data{ data }, m_len{ len }, m_handler{ handler }
+    {
+    }
+
+    bool decode()
+    {
+        if (!decodeValue(0, false))
+            return false;
+
+        if (m_pos != m_len)
+            error("Unexpected data after MessagePack value.");
+
+        return true;
+    }
+
+private:
+    [[noreturn]] void error(const char* msg)
+    {
+        throw NtSyntaxError("Offset " + std::to_string(m_pos) + ": " + msg);
+    }
+
+    const char* take(size_t n)
+    {
+        if (m_len - m_pos < n)
+            error("Truncated MessagePack data.");
+
+        const char* ret = m_data + m_pos;
+        m_pos += n;
+        return ret;
+    }
+
+    uint64_t load(size_t n) { return NtLoadBigEndian(take(n), n); }
+
+    bool text(size_t len, bool isKey, bool isBinary = false)
+    {
+        std::string_view str(take(len), len);
+        std::string encoded;
+
+        if (isBinary) {
+            encoded = NtEncodeBase64URL(str);
+            str = encoded;
+        } else if (!NtValidateUTF8(str.data(), str.size())) {
+            m_pos -= len;
+            error("Invalid UTF-8 in MessagePack string.");
+        }
+
+        return isKey ? m_handler->key(str) : m_handler->string(str);
+    }
+
+    bool array(size_t count, size_t depth)
+    {
+        if (depth >= NT_JSON_BINARY_MAX_DEPTH)
+            error("Maximum nesting depth exceeded.");
+
+        if (!m_handler->startArray())
+            return false;
+
+        for (size_t i = 0; i < count; ++i) {
+            if (!decodeValue(depth + 1, false))
+                return false;
+        }
+
+        return m_handler->endArray();
+    }
+
+    bool map(size_t count, size_t depth)
+    {
+        if (depth >= NT_JSON_BINARY_MAX_DEPTH)
+            error("Maximum nesting depth exceeded.");
+
+        if (!m_handler->startObject())
+            return false;
+
+        for (size_t i = 0; i < count; ++i) {
+            if (!decodeValue(depth + 1, true) || !decodeValue(depth + 1, false))
+                return false;
+        }
+
+        return m_handler->endObject();
+    }
+
+    bool decodeValue(size_t depth, bool isKey)
+    {
+        unsigned char type = static_cast<unsigned char>(*take(1));
+
+        if (type <= 0x7F || type >= 0xE0) {
+            if (isKey)
+                error("MessagePack map keys must be strings.");
+
+            if (type <= 0x7F)
+                return m_handler->integer(type);
+
+            return m_handler->integer(static_cast<int8_t>(type));
+        }
+
+        if ((type & 0xE0) == 0xA0)
+            return text(type & 0x1F, isKey);
+
+        switch (type) {
+        case 0xD9:
+            return text(load(1), isKey);
+        case 0xDA:
+            return text(load(2), isKey);
+        case 0xDB:
+            return text(load(4), isKey);
+        case 0xC4:
+            return text(load(1), isKey, true);
+        case 0xC5:
+            return text(load(2), isKey, true);
+        case 0xC6:
+            return text(load(4), isKey, true);
+        default:
+            break;
+        }
+
+        if (isKey)
+            error("MessagePack map keys must be strings.");
+
+        if ((type & 0xF0) == 0x90)
+            return array(type & 0x0F, depth);
+
+        if ((type & 0xF0) == 0x80)
+            return map(type & 0x0F, depth);
+
+        switch (type) {
+        case 0xC0:
+            return m_handler->null();
+        case 0xC2:
+            return m_handler->boolean(false);
+        case 0xC3:
+            return m_handler->boolean(true);
+        case 0xCA:
+            return m_handler->number(NtBitsFloat(static_cast<uint32_t>(load(4))));
+        case 0xCB:
+            return m_handler->number(NtBitsDouble(load(8)));
+        case 0xCC:
+            return m_handler->integer(static_cast<int64_t>(load(1)));
+        case 0xCD:
+            return m_handler->integer(static_cast<int64_t>(load(2)));
+        case 0xCE:
+            return m_handler->integer(static_cast<int64_t>(load(4)));
+        case 0xCF:
+            {
+                uint64_t value = load(8);
+
+                if (value > static_cast<uint64_t>(INT64_MAX))
+                    return m_handler->uinteger(value);
+
+                return m_handler->integer(static_cast<int64_t>(value));
+            }
+        case 0xD0:
+            return m_handler->integer(static_cast<int8_t>(load(1)));
+        case 0xD1:
+            return m_handler->integer(static_cast<int16_t>(load(2)));
+        case 0xD2:
+            return m_handler->integer(static_cast<int32_t>(load(4)));
+        case 0xD3:
+            return m_handler->integer(static_cast<int64_t>(load(8)));
+        case 0xDC:
+            return array(load(2), depth);
+        case 0xDD:
+            return array(load(4), depth);
+        case 0xDE:
+            return map(load(2), depth);
+        case 0xDF:
+            return map(load(4), depth);
+        default:
+            --m_pos;
+            error("Unsupported MessagePack type.");
+        }
+    }
+
+private:
+    const char* m_data;
+    size_t m_len;
+    size_t m_pos{ 0 };
+    NtJSONHandler* m_handler;
+};
+
+std::string newton::NtEncodeMessagePack(const NtJSONElement* element)
+{
+    NtMessagePackEncoder enc;
+    NtEncodeBinaryElement(enc, element);
+    return enc.take();
+}
+
+std::string newton::NtEncodeMessagePack(const NtJSONValue& value)
+{
+    NtMessagePackEncoder enc;
+    NtEncodeBinaryValue(enc, value);
+    return enc.take();
+}
+
+bool newton::NtDecodeMessagePack(const char* data, size_t len, NtJSONHandler* handler)
+{
+    NtMessagePackDecoder decoder(data, len, handler);
+    return decoder.decode();
+}
+
+NtJSONElement* newton::NtParseMessagePack(const char* data, size_t len)
+{
+    NtJSONTreeBuilder builder;
+    NtDecodeMessagePack(data, len, &builder);
+    return builder.take();
+}
+
+void newton::NtParseMessagePack(const char* data, size_t len, NtJSONDocument& doc)
+{
+    NtJSONDocumentBuilder builder(doc);
+
+    try {
+        NtDecodeMessagePack(data, len, &builder);
+    } catch (...) {
+        doc.clear();
+        throw;
+    }
+}
@@ -0,0 +1,154 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+using namespace newton;
+
+#include <cstring>
+
+static bool NtIsBlankLine(const char* data, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) {
+        if (data[i] != ' ' && data[i] != '\t' && data[i] != '\r')
+            return false;
+    }
+
+    return true;
+}
+
+NtNDJSONParser::NtNDJSONParser(NtThreadPool& pool, size_t batchSize)
+    : m_pool{ pool }, m_batchSize{ batchSize ? batchSize : 1 }
+{
+}
+
+NtNDJSONParser::~NtNDJSONParser()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_doneCond.wait(lock, [this]() { return m_running == 0; });
+}
+
+void NtNDJSONParser::feed(const char* data, size_t len)
+{
+    while (len) {
+        // Close the batch at the first line end once it holds batchSize
+        // bytes, so a large chunk is split into many batches.
+        size_t room = m_pending.size() < m_batchSize ? m_batchSize - m_pending.size() : 0;
+        const char* newline = len > room ?
+            static_cast<const char*>(memchr(data + room, '\n', len - room)) : nullptr;
+
+        if (!newline) {
+            m_pending.append(data, len);
+            return;
+        }
+
+        size_t take = static_cast<size_t>(newline - data) + 1;
+        m_pending.append(data, take);
+        submit(std::move(m_pending));
+        m_pending.clear();
+
+        data += take;
+        len -= take;
+    }
+}
+
+void NtNDJSONParser::finish()
+{
+    if (!m_pending.empty())
+        submit(std::move(m_pending));
+
+    m_pending.clear();
+}
+
+void NtNDJSONParser::submit(std::string text)
+{
+    auto batch = std::make_unique<NtNDJSONBatch>();
+    batch->text = std::move(text);
+    NtNDJSONBatch* ptr = batch.get();
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_batches.push_back(std::move(batch));
+        ++m_running;
+    }
+
+    m_pool.submit([this, ptr]() { parseBatch(ptr); });
+}
+
+void NtNDJSONParser::parseBatch(NtNDJSONBatch* batch)
+{
+    const char* data = batch->text.data();
+    size_t len = batch->text.size();
+    size_t pos = 0;
+
+    while (pos < len) {
+        const char* newline = static_cast<const char*>(memchr(data + pos, '\n', len - pos));
+        size_t end = newline ? static_cast<size_t>(newline - data) : len;
+
+        if (!NtIsBlankLine(data + pos, end - pos)) {
+            batch->records.emplace_back();
+            NtNDJSONRecord& record = batch->records.back();
+
+            try {
+                record.doc.parse(data + pos, end - pos);
+            } catch (...) {
+                record.error = std::current_exception();
+            }
+        }
+
+        pos = end + 1;
+    }
+
+    std::string().swap(batch->text);
+
+    // Notify with the lock held: once it is released the destructor may
+    // see no running batches and destroy the condition variable.
+    std::lock_guard<std::mutex> lock(m_lock);
+    batch->isDone = true;
+    --m_running;
+    m_doneCond.notify_all();
+}
+
+bool NtNDJSONParser::next(NtJSONDocument& doc)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    while (true) {
+        if (m_batches.empty())
+            return false;
+
+        NtNDJSONBatch* batch = m_batches.front().get();
+        m_doneCond.wait(lock, [batch]() { return batch->isDone; });
+
+        if (batch->position == batch->records.size()) {
+            m_batches.pop_front();
+            continue;
+        }
+
+        NtNDJSONRecord& record = batch->records[batch->position++];
+        ++m_recordCount;
+
+        if (record.error)
+            std::rethrow_exception(record.error);
+
+        doc = std::move(record.doc);
+        return true;
+    }
+}
+
+std::vector<NtJSONDocument> newton::NtParseNDJSON(const char* data, size_t len, NtThreadPool& pool)
+{
+    NtNDJSONParser parser(pool);
+    std::vector<NtJSONDocument> ret;
+
+    parser.feed(data, len);
+    parser.finish();
+
+    NtJSONDocument doc;
+
+    while (parser.next(doc))
+        ret.push_back(std::move(doc));
+
+    return ret;
+}
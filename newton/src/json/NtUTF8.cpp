@@ -0,0 +1,375 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "newton/newton.h"
+#include "NtUTF8.h"
+using namespace newton;
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#if (defined(NT_COMPILER_GCC) || defined(NT_COMPILER_CLANG)) && (defined(__x86_64__) || defined(__i386__))
+#  define NT_UTF8_X86_KERNELS
+#  include <immintrin.h>
+#endif
+
+struct NtUTF8Validator
+{
+    bool (*validate)(const char* data, size_t len);
+    const char* name;
+};
+
+/**
+ * Length of the prefix of data that is plain ASCII, checked eight bytes at
+ * a time.
+ */
+static inline size_t NtASCIILength(const unsigned char* data, size_t len)
+{
+    size_t pos = 0;
+
+    for (; pos + 8 <= len; pos += 8) {
+        uint64_t word;
+        memcpy(&word, data + pos, sizeof(word));
+
+        if (word & 0x8080808080808080ULL)
+            break;
+    }
+
+    while (pos < len && data[pos] < 0x80)
+        ++pos;
+
+    return pos;
+}
+
+static bool NtValidateUTF8Scalar(const char* data, size_t len)
+{
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(data);
+    size_t pos = 0;
+
+    while (pos < len) {
+        pos += NtASCIILength(s + pos, len - pos);
+
+        if (pos >= len)
+            break;
+
+        unsigned char c = s[pos];
+        size_t n;
+        unsigned char lo = 0x80;
+        unsigned char hi = 0xBF;
+
+        if (c >= 0xC2 && c <= 0xDF) {
+            n = 1;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            n = 2;
+
+            if (c == 0xE0)
+                lo = 0xA0;
+            else if (c == 0xED)
+                hi = 0x9F;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            n = 3;
+
+            if (c == 0xF0)
+                lo = 0x90;
+            else if (c == 0xF4)
+                hi = 0x8F;
+        } else {
+            return false;
+        }
+
+        if (len - pos <= n)
+            return false;
+
+        // Only the first continuation byte has a narrowed range.
+        if (s[pos + 1] < lo || s[pos + 1] > hi)
+            return false;
+
+        for (size_t i = 2; i <= n; ++i) {
+            if ((s[pos + i] & 0xC0) != 0x80)
+                return false;
+        }
+
+        pos += n + 1;
+    }
+
+    return true;
+}
+
+#ifdef NT_UTF8_X86_KERNELS
+
+// Lookup validation after Keiser and Lemire, "Validating UTF-8 in less
+// than one instruction per byte". Each error class is a bit. The high
+// nibble and low nibble of a byte and the high nibble of the byte after
+// it each select the classes they allow, and any class all three agree
+// on is an error. Third and fourth bytes are checked separately against
+// the lead bytes two and three positions back.
+
+static const uint8_t NT_UTF8_TOO_SHORT = 1 << 0;
+static const uint8_t NT_UTF8_TOO_LONG = 1 << 1;
+static const uint8_t NT_UTF8_OVERLONG_3 = 1 << 2;
+static const uint8_t NT_UTF8_TOO_LARGE = 1 << 3;
+static const uint8_t NT_UTF8_SURROGATE = 1 << 4;
+static const uint8_t NT_UTF8_OVERLONG_2 = 1 << 5;
+static const uint8_t NT_UTF8_TOO_LARGE_1000 = 1 << 6;
+static const uint8_t NT_UTF8_OVERLONG_4 = 1 << 6;
+static const uint8_t NT_UTF8_TWO_CONTS = 1 << 7;
+static const uint8_t NT_UTF8_CARRY = NT_UTF8_TOO_SHORT | NT_UTF8_TOO_LONG | NT_UTF8_TWO_CONTS;
+
+alignas(16) static const uint8_t NtUTF8Byte1High[16] = {
+    // 0xxx: ASCII
+    NT_UTF8_TOO_LONG, NT_UTF8_TOO_LONG, NT_UTF8_TOO_LONG, NT_UTF8_TOO_LONG,
+    NT_UTF8_TOO_LONG, NT_UTF8_TOO_LONG, NT_UTF8_TOO_LONG, NT_UTF8_TOO_LONG,
+    // 10xx: continuation
+    NT_UTF8_TWO_CONTS, NT_UTF8_TWO_CONTS, NT_UTF8_TWO_CONTS, NT_UTF8_TWO_CONTS,
+    // 1100, 1101: two byte lead
+    NT_UTF8_TOO_SHORT | NT_UTF8_OVERLONG_2,
+    NT_UTF8_TOO_SHORT,
+    // 1110: three byte lead
+    NT_UTF8_TOO_SHORT | NT_UTF8_OVERLONG_3 | NT_UTF8_SURROGATE,
+    // 1111: four byte lead
+    NT_UTF8_TOO_SHORT | NT_UTF8_TOO_LARGE | NT_UTF8_TOO_LARGE_1000 | NT_UTF8_OVERLONG_4
+};
+
+alignas(16) static const uint8_t NtUTF8Byte1Low[16] = {
+    NT_UTF8_CARRY | NT_UTF8_OVERLONG_3 | NT_UTF8_OVERLONG_2 | NT_UTF8_OVERLONG_4,
+    NT_UTF8_CARRY | NT_UTF8_OVERLONG_2,
+    NT_UTF8_CARRY,
+    NT_UTF8_CARRY,
+    NT_UTF8_CARRY | NT_UTF8_TOO_LARGE,
+    NT_UTF8_CARRY | NT_UTF8_TOO_LARGE | NT_UTF8_TOO_LARGE_1000,
+    NT_UTF8_CARRY | NT_UTF8_TOO_LARGE | NT_UTF8_TOO_LARGE_1000,
+    NT_UTF8_CARRY | NT_UTF8_TOO_LARGE | NT_UTF8_TOO_LARGE_1000,
+    NT_UTF8_CARRY | NT_UTF8_TOO_LARGE | NT_UTF8_TOO_LARGE_1000,
+    NT_UTF8_CARRY | NT_UTF8_TOO_LARGE | NT_UTF8_TOO_LARGE_1000,
+    NT_UTF8_CARRY | NT_UTF8_TOO_LARGE | NT_UTF8_TOO_LARGE_1000,
+    NT_UTF8_CARRY | NT_UTF8_TOO_LARGE | NT_UTF8_TOO_LARGE_1000,
+    NT_UTF8_CARRY | NT_UTF8_TOO_LARGE | NT_UTF8_TOO_LARGE_1000,
+    NT_UTF8_CARRY | NT_UTF8_TOO_LARGE | NT_UTF8_TOO_LARGE_1000 | NT_UTF8_SURROGATE,
+    NT_UTF8_CARRY | NT_UTF8_TOO_LARGE | NT_UTF8_TOO_LARGE_1000,
+    NT_UTF8_CARRY | NT_UTF8_TOO_LARGE | NT_UTF8_TOO_LARGE_1000
+};
+
+alignas(16) static const uint8_t NtUTF8Byte2High[16] = {
+    // 0xxx: ASCII
+    NT_UTF8_TOO_SHORT, NT_UTF8_TOO_SHORT, NT_UTF8_TOO_SHORT, NT_UTF8_TOO_SHORT,
+    NT_UTF8_TOO_SHORT, NT_UTF8_TOO_SHORT, NT_UTF8_TOO_SHORT, NT_UTF8_TOO_SHORT,
+    // 1000
+    NT_UTF8_TOO_LONG | NT_UTF8_OVERLONG_2 | NT_UTF8_TWO_CONTS | NT_UTF8_OVERLONG_3 |
+        NT_UTF8_TOO_LARGE_1000 | NT_UTF8_OVERLONG_4,
+    // 1001
+    NT_UTF8_TOO_LONG | NT_UTF8_OVERLONG_2 | NT_UTF8_TWO_CONTS | NT_UTF8_OVERLONG_3 | NT_UTF8_TOO_LARGE,
+    // 101x
+    NT_UTF8_TOO_LONG | NT_UTF8_OVERLONG_2 | NT_UTF8_TWO_CONTS | NT_UTF8_SURROGATE | NT_UTF8_TOO_LARGE,
+    NT_UTF8_TOO_LONG | NT_UTF8_OVERLONG_2 | NT_UTF8_TWO_CONTS | NT_UTF8_SURROGATE | NT_UTF8_TOO_LARGE,
+    // 11xx: lead
+    NT_UTF8_TOO_SHORT, NT_UTF8_TOO_SHORT, NT_UTF8_TOO_SHORT, NT_UTF8_TOO_SHORT
+};
+
+// The last three bytes of a block must not start a sequence that runs
+// past its end.
+alignas(16) static const uint8_t NtUTF8IncompleteMax[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1
+};
+
+__attribute__((target("ssse3")))
+static inline __m128i NtUTF8CheckSSSE3(__m128i input, __m128i prev)
+{
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+
+    __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+    __m128i byte1High = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(NtUTF8Byte1High)),
+        _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble));
+    __m128i byte1Low = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(NtUTF8Byte1Low)),
+        _mm_and_si128(prev1, nibble));
+    __m128i byte2High = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(NtUTF8Byte2High)),
+        _mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+    __m128i special = _mm_and_si128(_mm_and_si128(byte1High, byte1Low), byte2High);
+
+    __m128i prev2 = _mm_alignr_epi8(input, prev, 14);
+    __m128i prev3 = _mm_alignr_epi8(input, prev, 13);
+    __m128i isThird = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    __m128i isFourth = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+    __m128i must23 = _mm_and_si128(_mm_or_si128(isThird, isFourth), _mm_set1_epi8(static_cast<char>(0x80)));
+
+    return _mm_xor_si128(must23, special);
+}
+
+__attribute__((target("ssse3")))
+static bool NtValidateUTF8SSSE3(const char* data, size_t len)
+{
+    const __m128i incompleteMax = _mm_loadu_si128(reinterpret_cast<const __m128i*>(NtUTF8IncompleteMax + 16));
+    __m128i error = _mm_setzero_si128();
+    __m128i prev = _mm_setzero_si128();
+    __m128i incomplete = _mm_setzero_si128();
+    size_t pos = 0;
+
+    while (pos < len) {
+        __m128i input;
+
+        if (len - pos >= 16) {
+            input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        } else {
+            // Padding with zeros is padding with ASCII.
+            alignas(16) char tail[16] = { 0 };
+            memcpy(tail, data + pos, len - pos);
+            input = _mm_load_si128(reinterpret_cast<const __m128i*>(tail));
+        }
+
+        if (_mm_movemask_epi8(input) == 0) {
+            error = _mm_or_si128(error, incomplete);
+            incomplete = _mm_setzero_si128();
+        } else {
+            error = _mm_or_si128(error, NtUTF8CheckSSSE3(input, prev));
+            incomplete = _mm_subs_epu8(input, incompleteMax);
+        }
+
+        prev = input;
+        pos += 16;
+    }
+
+    error = _mm_or_si128(error, incomplete);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i NtUTF8CheckAVX2(__m256i input, __m256i prev)
+{
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i shifted = _mm256_permute2x128_si256(prev, input, 0x21);
+
+    __m256i prev1 = _mm256_alignr_epi8(input, shifted, 15);
+    __m256i byte1High = _mm256_shuffle_epi8(
+        _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(NtUTF8Byte1High))),
+        _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+    __m256i byte1Low = _mm256_shuffle_epi8(
+        _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(NtUTF8Byte1Low))),
+        _mm256_and_si256(prev1, nibble));
+    __m256i byte2High = _mm256_shuffle_epi8(
+        _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(NtUTF8Byte2High))),
+        _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble));
+    __m256i special = _mm256_and_si256(_mm256_and_si256(byte1High, byte1Low), byte2High);
+
+    __m256i prev2 = _mm256_alignr_epi8(input, shifted, 14);
+    __m256i prev3 = _mm256_alignr_epi8(input, shifted, 13);
+    __m256i isThird = _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    __m256i isFourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+    __m256i must23 = _mm256_and_si256(_mm256_or_si256(isThird, isFourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+
+    return _mm256_xor_si256(must23, special);
+}
+
+__attribute__((target("avx2")))
+static bool NtValidateUTF8AVX2(const char* data, size_t len)
+{
+    const __m256i incompleteMax = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(NtUTF8IncompleteMax));
+    __m256i error = _mm256_setzero_si256();
+    __m256i prev = _mm256_setzero_si256();
+    __m256i incomplete = _mm256_setzero_si256();
+    size_t pos = 0;
+
+    while (pos < len) {
+        __m256i input;
+
+        if (len - pos >= 32) {
+            input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        } else {
+            alignas(32) char tail[32] = { 0 };
+            memcpy(tail, data + pos, len - pos);
+            input = _mm256_load_si256(reinterpret_cast<const __m256i*>(tail));
+        }
+
+        if (_mm256_movemask_epi8(input) == 0) {
+            error = _mm256_or_si256(error, incomplete);
+            incomplete = _mm256_setzero_si256();
+        } else {
+            error = _mm256_or_si256(error, NtUTF8CheckAVX2(input, prev));
+            incomplete = _mm256_subs_epu8(input, incompleteMax);
+        }
+
+        prev = input;
+        pos += 32;
+    }
+
+    error = _mm256_or_si256(error, incomplete);
+    return _mm256_testz_si256(error, error) != 0;
+}
+
+#endif
+
+/**
+ * Validators this CPU supports, fastest first.
+ */
+static std::vector<NtUTF8Validator> NtSupportedUTF8Validators()
+{
+    std::vector<NtUTF8Validator> validators;
+
+#ifdef NT_UTF8_X86_KERNELS
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+        validators.push_back(NtUTF8Validator{ NtValidateUTF8AVX2, "avx2" });
+
+    if (__builtin_cpu_supports("ssse3"))
+        validators.push_back(NtUTF8Validator{ NtValidateUTF8SSSE3, "ssse3" });
+#endif
+
+    validators.push_back(NtUTF8Validator{ NtValidateUTF8Scalar, "scalar" });
+    return validators;
+}
+
+static const std::vector<NtUTF8Validator>& NtValidators()
+{
+    static const std::vector<NtUTF8Validator> validators = NtSupportedUTF8Validators();
+    return validators;
+}
+
+static std::atomic<const NtUTF8Validator*>& NtValidator()
+{
+    static std::atomic<const NtUTF8Validator*> validator{ &NtValidators().front() };
+    return validator;
+}
+
+bool newton::NtValidateUTF8(const char* data, size_t len)
+{
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(data);
+    size_t ascii = NtASCIILength(s, len);
+
+    // Short and plain ASCII strings, the common case, never reach a kernel.
+    if (ascii == len)
+        return true;
+
+    return NtValidator().load(std::memory_order_relaxed)->validate(data + ascii, len - ascii);
+}
+
+const char* newton::NtUTF8Kernel()
+{
+    return NtValidator().load(std::memory_order_relaxed)->name;
+}
+
+std::vector<const char*> newton::NtUTF8Kernels()
+{
+    std::vector<const char*> names;
+
+    for (const NtUTF8Validator& validator : NtValidators())
+        names.push_back(validator.name);
+
+    return names;
+}
+
+bool newton::NtSetUTF8Kernel(const char* name)
+{
+    for (const NtUTF8Validator& validator : NtValidators()) {
+        if (strcmp(validator.name, name) == 0) {
+            NtValidator().store(&validator, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtUTF8.h
+ * \brief UTF-8 validation
+ * \author Hákon Hjaltalín
+ *
+ * This file contains the UTF-8 validator used on untrusted string data. It
+ * is internal to the library.
+ */
+
+#include "newton/base/NtDefs.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace newton
+{
+
+/**
+ * \fn NtValidateUTF8
+ * \brief Validate UTF-8
+ *
+ * Check that data is well-formed UTF-8 as defined by RFC 3629: no overlong
+ * forms, no encoded surrogates and nothing above U+10FFFF. Uses AVX2 or
+ * SSSE3 when the CPU has them, which classify 16 or 32 bytes at a time
+ * with nibble lookup tables.
+ *
+ * \param data Data buffer
+ * \param len Length of data
+ * \return True if the data is valid
+ */
+bool NtValidateUTF8(const char* data, size_t len);
+
+/**
+ * \fn NtUTF8Kernel
+ * \brief Get validator kernel
+ *
+ * Get the name of the UTF-8 validator selected for this CPU.
+ *
+ * \return "avx2", "ssse3" or "scalar"
+ */
+NT_EXPORT const char* NtUTF8Kernel();
+
+/**
+ * \fn NtUTF8Kernels
+ * \brief Get supported validator kernels
+ *
+ * Get the names of the UTF-8 validators this CPU supports, fastest first.
+ *
+ * \return Kernel names
+ */
+NT_EXPORT std::vector<const char*> NtUTF8Kernels();
+
+/**
+ * \fn NtSetUTF8Kernel
+ * \brief Set validator kernel
+ *
+ * Use the named UTF-8 validator instead of the one selected for this CPU,
+ * so tests can cover every kernel.
+ *
+ * \param name Kernel name from NtUTF8Kernels()
+ * \return False if the CPU does not support the kernel
+ */
+NT_EXPORT bool NtSetUTF8Kernel(const char* name);
+
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "gtest/gtest.h"
+#include "newton/newton.h"
+using namespace newton;
+
+#include "NtTestSocket.h"
+
+#include <atomic>
+#include <coroutine>
+#include <thread>
+
+#ifndef NT_HAS_COROUTINES
+#error "NtCoroutineTest.cpp must be compiled with coroutine support"
+#endif
+
+/**
+ * \struct NtTestDelay
+ * \brief Awaitable resuming the coroutine on another thread
+ */
+struct NtTestDelay
+{
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) const
+    {
+        std::thread([handle]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            handle.resume();
+        }).detach();
+    }
+
+    void await_resume() const noexcept { }
+};
+
+/**
+ * \class NtTestCoroutineRoute
+ * \brief Route answering from a coroutine
+ */
+class NtTestCoroutineRoute : public NtCoroutineRoute
+{
+public:
+    NtTestCoroutineRoute(const std::string& path, bool isSuspending)
+        : NtCoroutineRoute(path), m_isSuspending{ isSuspending }
+    {
+    }
+
+    NtHTTPTask handleRequestCoroutine(NtHTTPRequest*) override
+    {
+        std::string body = std::to_string(++requests);
+
+        if (m_isSuspending)
+            co_await NtTestDelay{};
+
+        NtHTTPResponse* resp = new NtHTTPResponse("HTTP/1.1 200 OK");
+        resp->addHeader(new NtHTTPHeader("Content-Length", std::to_string(body.size())));
+        resp->setBody(body);
+        co_return resp;
+    }
+
+    std::atomic<int> requests{ 0 };
+
+private:
+    bool m_isSuspending;
+};
+
+TEST(NtCoroutineTest, NtCoroutineRoute)
+{
+    NtTestCoroutineRoute* suspending = new NtTestCoroutineRoute("/suspend", true);
+    NtVirtualHost* host = new NtVirtualHost("localhost");
+    host->addRoute(new NtTestCoroutineRoute("/", false));
+    host->addRoute(suspending);
+
+    NtHTTPServer* server = new NtHTTPServer();
+    server->addHost(host);
+
+    int port = NtFindFreePort();
+    ASSERT_TRUE(server->initTCPServer("127.0.0.1", port));
+
+    int fd = NtConnectLoopback(port);
+    ASSERT_GE(fd, 0);
+
+    // A coroutine resumed off the reactor completes through the posted
+    // callback, and one that never suspends completes inline.
+    ASSERT_TRUE(NtSendAll(fd,
+        "GET /suspend HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        "GET /suspend HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+
+    std::string buffer;
+    std::string first = NtRecvHTTPResponse(fd, buffer);
+    std::string second = NtRecvHTTPResponse(fd, buffer);
+    std::string third = NtRecvHTTPResponse(fd, buffer);
+
+    EXPECT_EQ(0u, first.find("HTTP/1.1 200 OK"));
+    EXPECT_EQ('1', first.back());
+    EXPECT_EQ(0u, second.find("HTTP/1.1 200 OK"));
+    EXPECT_EQ('1', second.back());
+    EXPECT_EQ('2', third.back());
+    EXPECT_EQ(2, suspending->requests);
+
+    close(fd);
+}
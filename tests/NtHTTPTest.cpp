@@ -0,0 +1,333 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "gtest/gtest.h"
+#include "newton/newton.h"
+using namespace newton;
+
+#include "NtTestSocket.h"
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+/**
+ * \class NtTestDeferredRoute
+ * \brief Route answering from another thread after a delay
+ */
+class NtTestDeferredRoute : public NtRoute
+{
+public:
+    explicit NtTestDeferredRoute(const std::string& path)
+        : NtRoute(path)
+    {
+    }
+
+    void handleRequestAsync(NtHTTPRequest*, NtResponseCallback done) override
+    {
+        std::string body = std::to_string(++requests);
+        maxInFlight = std::max(maxInFlight.load(), ++inFlight);
+
+        std::thread([this, body, done]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+            NtHTTPResponse* resp = new NtHTTPResponse("HTTP/1.1 200 OK");
+            resp->addHeader(new NtHTTPHeader("Content-Length", std::to_string(body.size())));
+            resp->setBody(body);
+
+            --inFlight;
+            done(resp);
+        }).detach();
+    }
+
+    std::atomic<int> requests{ 0 };
+    std::atomic<int> inFlight{ 0 };
+    std::atomic<int> maxInFlight{ 0 };
+};
+
+/**
+ * \class NtTestOffloadRoute
+ * \brief Offloaded route recording where it was handled
+ */
+class NtTestOffloadRoute : public NtRoute
+{
+public:
+    NtTestOffloadRoute(const std::string& path, NtServer* server)
+        : NtRoute(path), m_server{ server }
+    {
+        setOffload();
+    }
+
+    NtHTTPResponse* handleRequest(NtHTTPRequest*) override
+    {
+        if (m_server->isReactorThread())
+            ++onReactor;
+
+        std::string body = std::to_string(++requests);
+        NtHTTPResponse* resp = new NtHTTPResponse("HTTP/1.1 200 OK");
+        resp->addHeader(new NtHTTPHeader("Content-Length", std::to_string(body.size())));
+        resp->setBody(body);
+        return resp;
+    }
+
+    std::atomic<int> requests{ 0 };
+    std::atomic<int> onReactor{ 0 };
+
+private:
+    NtServer* m_server;
+};
+
+TEST(NtHTTPTest, NtHTTPMessageLength)
+{
+    std::string get = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    std::string post = "POST /echo HTTP/1.1\r\nHost: localhost\r\ncontent-length: 7\r\n\r\n{\"a\":1}";
+    std::string pipelined = get + post + get;
+
+    EXPECT_EQ(NtHTTPMessageLength(get.data(), get.size()), get.size());
+    EXPECT_EQ(NtHTTPMessageLength(post.data(), post.size()), post.size());
+    EXPECT_EQ(NtHTTPMessageLength(pipelined.data(), pipelined.size()), get.size());
+    EXPECT_EQ(NtHTTPMessageLength(pipelined.data() + get.size(), pipelined.size() - get.size()), post.size());
+
+    // Incomplete headers and bodies wait for more data.
+    EXPECT_EQ(NtHTTPMessageLength(get.data(), get.size() - 1), 0u);
+    EXPECT_EQ(NtHTTPMessageLength(post.data(), post.size() - 1), 0u);
+    EXPECT_EQ(NtHTTPMessageLength("", 0), 0u);
+
+    std::string text = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello";
+    EXPECT_EQ(NtHTTPMessageLength(text.data(), text.size()), text.size());
+
+    std::string repeated = "POST / HTTP/1.1\r\nContent-Length: 2\r\nContent-Length:  2 \r\n\r\nok";
+    EXPECT_EQ(NtHTTPMessageLength(repeated.data(), repeated.size()), repeated.size());
+
+    // Messages whose end cannot be found reliably are rejected, so a body
+    // is never taken for the next request.
+    for (const char* bad : {
+            "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n",
+            "POST / HTTP/1.1\r\ntransfer-encoding: chunked\r\nContent-Length: 5\r\n\r\n",
+            "POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\nab",
+            "POST / HTTP/1.1\r\nContent-Length: -1\r\n\r\n",
+            "POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n",
+            "POST / HTTP/1.1\r\nContent-Length: \r\n\r\n",
+            "POST / HTTP/1.1\r\nContent-Length: 99999999999999999999999\r\n\r\n" })
+        EXPECT_THROW(NtHTTPMessageLength(bad, strlen(bad)), NtSyntaxError);
+
+    std::unique_ptr<NtHTTPRequest> req(NtParseHTTPRequest(&pipelined[get.size()], post.size()));
+    EXPECT_EQ(req->method(), NtHTTPRequest::RequestMethod::POST);
+    EXPECT_EQ(req->requestURI(), "/echo");
+    EXPECT_EQ(req->headerCount(), 2u);
+    EXPECT_EQ(req->body(), "{\"a\":1}");
+}
+
+TEST(NtHTTPTest, NtHTTPHeaderCase)
+{
+    std::string text = "POST /echo HTTP/1.1\r\nhost: localhost\r\ncontent-type: application/msgpack\r\n"
+        "ACCEPT: application/cbor\r\ncontent-length: 7\r\n\r\n{\"a\":1}";
+
+    std::unique_ptr<NtHTTPRequest> req(NtParseHTTPRequest(&text[0], text.size()));
+    EXPECT_EQ(req->body(), "{\"a\":1}");
+    EXPECT_EQ(req->bodyFormat(), NtJSONFormat::MESSAGEPACK);
+    ASSERT_NE(req->getHeader("Accept"), nullptr);
+    EXPECT_EQ(req->getHeader("Accept")->value(), "application/cbor");
+    EXPECT_EQ(req->getHeader("HOST"), req->getHeader("host"));
+
+    req->removeHeader("Content-Type");
+    EXPECT_EQ(req->getHeader("content-type"), nullptr);
+    EXPECT_EQ(req->bodyFormat(), NtJSONFormat::JSON);
+}
+
+TEST(NtHTTPTest, NtHTTPMessageLengthAllocations)
+{
+    if (!NtIsAllocTrackingEnabled())
+        GTEST_SKIP() << "Configure with NT_BUILD_ALLOC_TRACKING to count allocations.";
+
+    std::string get = "GET / HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n";
+    std::string post = "POST /echo HTTP/1.1\r\nHost: localhost\r\nContent-Length: 7\r\n\r\n{\"a\":1}";
+    std::string pipelined = get + post + get;
+    size_t total = 0;
+
+    // Framing runs for every request read off a keep-alive connection and
+    // must not touch the heap.
+    NtAllocScope allocs;
+
+    for (size_t pos = 0; size_t len = NtHTTPMessageLength(pipelined.data() + pos, pipelined.size() - pos); pos += len)
+        total += len;
+
+    EXPECT_EQ(total, pipelined.size());
+    EXPECT_EQ(allocs.stats().count, 0u);
+}
+
+TEST(NtHTTPTest, NtServerMetrics)
+{
+    NtServerMetrics a;
+    a.counters[NT_COUNTER_REQUESTS] = 3;
+    a.connections = 2;
+    a.loopLagUs = 1500;
+
+    NtServerMetrics b;
+    b.counters[NT_COUNTER_REQUESTS] = 4;
+    b.counters[NT_COUNTER_SEND_EAGAIN] = 1;
+    b.connections = 1;
+    b.loopLagUs = 250;
+
+    a.merge(b);
+    EXPECT_EQ(a.counters[NT_COUNTER_REQUESTS], 7u);
+    EXPECT_EQ(a.counters[NT_COUNTER_SEND_EAGAIN], 1u);
+    EXPECT_EQ(a.connections, 3u);
+    EXPECT_EQ(a.loopLagUs, 1500u);
+
+    std::string text = a.toPrometheus();
+    EXPECT_NE(text.find("# TYPE newton_requests_total counter\nnewton_requests_total 7\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE newton_connections gauge\nnewton_connections 3\n"), std::string::npos);
+    EXPECT_NE(text.find("newton_loop_lag_seconds 0.001500\n"), std::string::npos);
+
+    NtMetricsRoute route;
+    EXPECT_TRUE(route.matchPath("/metrics"));
+
+    std::unique_ptr<NtHTTPResponse> resp(route.handleRequest(nullptr));
+    EXPECT_NE(resp->body().find("newton_accepts_total 0\n"), std::string::npos);
+}
+
+static uint64_t NtMetricValue(const std::string& text, const std::string& name)
+{
+    size_t pos = text.find("\n" + name + " ");
+
+    if (pos == std::string::npos)
+        return 0;
+
+    return strtoull(text.c_str() + pos + name.size() + 2, nullptr, 10);
+}
+
+TEST(NtHTTPTest, NtMetricsRouteScrape)
+{
+    NtHTTPServer* server = new NtHTTPServer();
+    NtMetricsRoute* metrics = new NtMetricsRoute();
+    metrics->addServer(server);
+
+    NtVirtualHost* host = new NtVirtualHost("localhost");
+    host->addRoute(new NtRoute("/"));
+    host->addRoute(metrics);
+    server->addHost(host);
+
+    int port = NtFindFreePort();
+    ASSERT_TRUE(server->initTCPServer("127.0.0.1", port));
+
+    int fd = NtConnectLoopback(port);
+    ASSERT_GE(fd, 0);
+
+    std::string buffer;
+    std::string request = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_TRUE(NtSendAll(fd, request));
+        EXPECT_NE(NtRecvHTTPResponse(fd, buffer).find("hello"), std::string::npos);
+    }
+
+    std::string scrape = "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    ASSERT_TRUE(NtSendAll(fd, scrape));
+    std::string text = NtRecvHTTPResponse(fd, buffer);
+    ASSERT_EQ(0u, text.find("HTTP/1.1 200 OK"));
+
+    // The scrape itself is counted as a request before it is answered.
+    EXPECT_EQ(1u, NtMetricValue(text, "newton_accepts_total"));
+    EXPECT_EQ(3u, NtMetricValue(text, "newton_requests_total"));
+    EXPECT_EQ(2 * request.size() + scrape.size(), NtMetricValue(text, "newton_bytes_in_total"));
+    EXPECT_GT(NtMetricValue(text, "newton_bytes_out_total"), 0u);
+    EXPECT_EQ(1u, NtMetricValue(text, "newton_connections"));
+
+    close(fd);
+}
+
+TEST(NtHTTPTest, NtHTTPServerAsync)
+{
+    NtTestDeferredRoute* deferred = new NtTestDeferredRoute("/deferred");
+    NtVirtualHost* host = new NtVirtualHost("localhost");
+    host->addRoute(new NtRoute("/"));
+    host->addRoute(deferred);
+
+    NtHTTPServer* server = new NtHTTPServer();
+    server->addHost(host);
+
+    int port = NtFindFreePort();
+    ASSERT_TRUE(server->initTCPServer("127.0.0.1", port));
+
+    int fd = NtConnectLoopback(port);
+    ASSERT_GE(fd, 0);
+
+    // Each deferred response is posted back to the reactor, which resumes
+    // the client and only then dispatches the next pipelined request.
+    ASSERT_TRUE(NtSendAll(fd,
+        "GET /deferred HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        "GET /deferred HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        "GET /deferred HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+
+    std::string buffer;
+    std::string first = NtRecvHTTPResponse(fd, buffer);
+    std::string second = NtRecvHTTPResponse(fd, buffer);
+    std::string third = NtRecvHTTPResponse(fd, buffer);
+    std::string fourth = NtRecvHTTPResponse(fd, buffer);
+
+    EXPECT_EQ(0u, first.find("HTTP/1.1 200 OK"));
+    EXPECT_EQ('1', first.back());
+    EXPECT_EQ('2', second.back());
+    EXPECT_NE(third.find("\r\n\r\nhello"), std::string::npos);
+    EXPECT_EQ('3', fourth.back());
+    EXPECT_EQ(1, deferred->maxInFlight);
+
+    close(fd);
+}
+
+TEST(NtHTTPTest, NtHTTPServerOffload)
+{
+    NtHTTPServer* server = new NtHTTPServer();
+    server->setOffloadThreads(2);
+
+    NtTestOffloadRoute* offloaded = new NtTestOffloadRoute("/offload", server);
+    NtVirtualHost* host = new NtVirtualHost("localhost");
+    host->addRoute(new NtRoute("/"));
+    host->addRoute(offloaded);
+    server->addHost(host);
+
+    int port = NtFindFreePort();
+    ASSERT_TRUE(server->initTCPServer("127.0.0.1", port));
+
+    int fd = NtConnectLoopback(port);
+    ASSERT_GE(fd, 0);
+
+    // Offloaded requests run on the pool and their responses come back in
+    // order with the inline request between them.
+    ASSERT_TRUE(NtSendAll(fd,
+        "GET /offload HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        "GET /offload HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+
+    std::string buffer;
+    std::string first = NtRecvHTTPResponse(fd, buffer);
+    std::string second = NtRecvHTTPResponse(fd, buffer);
+    std::string third = NtRecvHTTPResponse(fd, buffer);
+
+    EXPECT_EQ(0u, first.find("HTTP/1.1 200 OK"));
+    EXPECT_EQ('1', first.back());
+    EXPECT_NE(second.find("\r\n\r\nhello"), std::string::npos);
+    EXPECT_EQ('2', third.back());
+
+    // Later connections reuse the same pool.
+    int other = NtConnectLoopback(port);
+    ASSERT_GE(other, 0);
+    std::string otherBuffer;
+
+    for (int i = 3; i <= 20; ++i) {
+        ASSERT_TRUE(NtSendAll(other, "GET /offload HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+        std::string resp = NtRecvHTTPResponse(other, otherBuffer);
+        EXPECT_NE(resp.find("\r\n\r\n" + std::to_string(i)), std::string::npos);
+    }
+
+    EXPECT_EQ(20, offloaded->requests);
+    EXPECT_EQ(0, offloaded->onReactor);
+
+    close(other);
+    close(fd);
+}
@@ -0,0 +1,522 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "gtest/gtest.h"
+#include "newton/newton.h"
+using namespace newton;
+
+#include "json/NtJSONIndexer.h"
+
+#include <string>
+
+TEST(NtJSONDocumentTest, NtArena)
+{
+    NtArena arena(64);
+
+    void* a = arena.allocate(10, 8);
+    void* b = arena.allocate(10, 8);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(a) % 8);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(b) % 8);
+    EXPECT_NE(a, b);
+
+    void* big = arena.allocate(1000);
+    EXPECT_NE(nullptr, big);
+    EXPECT_GE(arena.reserved(), 1064);
+
+    const char* str = arena.copy("hello", 5);
+    EXPECT_EQ(0, memcmp(str, "hello", 5));
+
+    arena.clear();
+    EXPECT_EQ(0, arena.reserved());
+}
+
+TEST(NtJSONDocumentTest, NtJSONDocumentParse)
+{
+    NtJSONDocument doc;
+    doc.parse(R"({ "name": "newton", "version": 2, "tags": [ "a", "b", { "c": null } ], "enabled": true })");
+
+    NtJSONValue root = doc.root();
+    EXPECT_TRUE(root.isObject());
+    EXPECT_EQ(4, root.count());
+
+    EXPECT_EQ("newton", root["name"].asString());
+    EXPECT_EQ(2.0, root["version"].asNumber());
+    EXPECT_TRUE(root["enabled"].asBoolean());
+    EXPECT_FALSE(root["missing"].isValid());
+
+    NtJSONValue tags = root["tags"];
+    EXPECT_TRUE(tags.isArray());
+    EXPECT_EQ(3, tags.count());
+    EXPECT_EQ("a", tags[0].asString());
+    EXPECT_EQ("b", tags[1].asString());
+    EXPECT_TRUE(tags[2]["c"].isNull());
+    EXPECT_FALSE(tags[3].isValid());
+
+    std::string keys;
+
+    for (auto it = root.begin(); it != root.end(); ++it)
+        keys += std::string(it.key()) + ",";
+
+    EXPECT_EQ("name,version,tags,enabled,", keys);
+}
+
+TEST(NtJSONDocumentTest, NtJSONDocumentInternKeys)
+{
+    std::string json = "[";
+
+    for (int i = 0; i < 5000; ++i)
+        json += std::string(i ? "," : "") + R"({ "identifier": )" + std::to_string(i) + R"(, "description": "record", "id": "short" })";
+
+    json += "]";
+
+    NtJSONDocument plain;
+    plain.parse(json);
+
+    NtJSONDocument doc;
+    doc.setInternKeys(true);
+    doc.parse(json);
+
+    EXPECT_TRUE(doc.isInterningKeys());
+    EXPECT_LT(doc.memoryUsage(), plain.memoryUsage());
+    EXPECT_EQ(nullptr, doc.internedKey("missing_key"));
+
+    NtJSONValue root = doc.root();
+    EXPECT_EQ(5000, root.count());
+    EXPECT_EQ(42, root[42]["identifier"].asInt64());
+    EXPECT_EQ("record", root[42]["description"].asString());
+    EXPECT_EQ("short", root[42]["id"].asString());
+    EXPECT_FALSE(root[42]["missing_key"].isValid());
+    EXPECT_EQ(root[0].begin().key().data(), root[4999].begin().key().data());
+    EXPECT_EQ(doc.internedKey("identifier"), root[7].begin().key().data());
+    EXPECT_EQ(NtSerializeJSON(plain.root()), NtSerializeJSON(root));
+
+    // Lookups follow how the contents were parsed, not the current setting.
+    plain.setInternKeys(true);
+    EXPECT_FALSE(plain.hasInternedKeys());
+    EXPECT_EQ("record", plain.root()[42]["description"].asString());
+
+    doc.setInternKeys(false);
+    EXPECT_TRUE(doc.hasInternedKeys());
+    EXPECT_EQ("record", root[42]["description"].asString());
+    EXPECT_FALSE(root[42]["missing_key"].isValid());
+}
+
+TEST(NtJSONDocumentTest, NtJSONDocumentScalarRoot)
+{
+    NtJSONDocument doc;
+
+    doc.parse("\"line\\nbreak\"");
+    EXPECT_EQ("line\nbreak", doc.root().asString());
+
+    doc.parse("  -12.5 ");
+    EXPECT_EQ(-12.5, doc.root().asNumber());
+
+    doc.parse("[]");
+    EXPECT_EQ(0, doc.root().count());
+    EXPECT_TRUE(doc.root().begin() == doc.root().end());
+}
+
+TEST(NtJSONDocumentTest, NtJSONDocumentErrors)
+{
+    NtJSONDocument doc;
+
+    EXPECT_THROW(doc.parse("{ \"a\": 1 } x"), NtSyntaxError);
+    EXPECT_FALSE(doc.root().isValid());
+    EXPECT_THROW(doc.parse("[1, 2"), NtSyntaxError);
+    EXPECT_THROW(doc.parse("{ \"a\" 1 }"), NtSyntaxError);
+    EXPECT_THROW(doc.parse(std::string(2000, '[')), NtSyntaxError);
+}
+
+TEST(NtJSONDocumentTest, NtJSONDocumentBlockBoundaries)
+{
+    std::string selected = NtJSONIndexerKernel();
+
+    // Every kernel this CPU supports must index the same text, not just
+    // the one picked at startup.
+    for (const char* kernel : NtJSONIndexerKernels()) {
+        SCOPED_TRACE(kernel);
+        ASSERT_TRUE(NtSetJSONIndexerKernel(kernel));
+
+        // Place escapes, quotes and scalars on every offset around the
+        // 64-byte blocks used by the structural indexer.
+        for (size_t pad = 0; pad < 130; ++pad) {
+            std::string text = "[" + std::string(pad, ' ') +
+                "\"a\\\\\", \"b\\\"c\", \"\\\\\\\\\", \"d\\\\\\\"{,}\", 12, true, null, { \"k\": [ -3 ] } ]";
+
+            NtJSONDocument doc;
+            doc.parse(text);
+
+            NtJSONValue root = doc.root();
+            EXPECT_EQ(8, root.count());
+            EXPECT_EQ("a\\", root[0].asString());
+            EXPECT_EQ("b\"c", root[1].asString());
+            EXPECT_EQ("\\\\", root[2].asString());
+            EXPECT_EQ("d\\\"{,}", root[3].asString());
+            EXPECT_EQ(12.0, root[4].asNumber());
+            EXPECT_TRUE(root[5].asBoolean());
+            EXPECT_TRUE(root[6].isNull());
+            EXPECT_EQ(-3.0, root[7]["k"][0].asNumber());
+        }
+    }
+
+    EXPECT_FALSE(NtSetJSONIndexerKernel("none"));
+    EXPECT_TRUE(NtSetJSONIndexerKernel(selected.c_str()));
+}
+
+TEST(NtJSONDocumentTest, NtJSONDocumentInvalidScalars)
+{
+    NtJSONDocument doc;
+
+    EXPECT_THROW(doc.parse("[truex]"), NtSyntaxError);
+    EXPECT_THROW(doc.parse("[1 2]"), NtSyntaxError);
+    EXPECT_THROW(doc.parse("[\"a\" \"b\"]"), NtSyntaxError);
+    EXPECT_THROW(doc.parse("[\"abc"), NtSyntaxError);
+    EXPECT_THROW(doc.parse("[\"\\x\"]"), NtSyntaxError);
+    EXPECT_THROW(doc.parse(""), NtSyntaxError);
+
+    doc.parse("{\"u\":\"\\u00e9\\u20AC\"}");
+    EXPECT_EQ("\xC3\xA9\xE2\x82\xAC", doc.root()["u"].asString());
+}
+
+TEST(NtJSONDocumentTest, NtJSONCursor)
+{
+    std::string text = R"(  {
+        "skip": { "nested": [ 1, "}", "\"]", { "deep": [] } ] },
+        "id": 42,
+        "name": "ne\"wton",
+        "escaped": true,
+        "list": [ 10, [ 20, 21 ], 30 ],
+        "none": null
+    } )";
+
+    NtJSONCursor root(text);
+    EXPECT_TRUE(root.isObject());
+    EXPECT_EQ(6, root.count());
+
+    EXPECT_EQ(42.0, root["id"].asNumber());
+    EXPECT_EQ("ne\"wton", root["name"].asString());
+    EXPECT_TRUE(root["escaped"].asBoolean());
+    EXPECT_TRUE(root["none"].isNull());
+    EXPECT_FALSE(root["missing"].isValid());
+
+    NtJSONCursor list = root["list"];
+    EXPECT_EQ(3, list.count());
+    EXPECT_EQ(30.0, list[2].asNumber());
+    EXPECT_EQ(21.0, list[1][1].asNumber());
+    EXPECT_FALSE(list[3].isValid());
+    EXPECT_EQ("[ 20, 21 ]", list[1].raw());
+
+    std::string keys;
+
+    for (auto it = root.begin(); it != root.end(); ++it)
+        keys += it.key() + ",";
+
+    EXPECT_EQ("skip,id,name,escaped,list,none,", keys);
+
+    EXPECT_FALSE(NtJSONCursor("   ").isValid());
+    EXPECT_THROW(NtJSONCursor("{ \"a\" 1 }")["a"], NtSyntaxError);
+    EXPECT_THROW(NtJSONCursor("{ \"a\": \"1 }")["b"], NtSyntaxError);
+}
+
+class NtJSONRecorder : public NtJSONHandler
+{
+public:
+    bool startObject() override { events += "{"; return true; }
+    bool endObject() override { events += "}"; return true; }
+    bool startArray() override { events += "["; return true; }
+    bool endArray() override { events += "]"; return true; }
+    bool key(std::string_view name) override { events += "k:" + std::string(name) + ";"; return true; }
+    bool string(std::string_view value) override { events += "s:" + std::string(value) + ";"; return true; }
+    bool number(double value) override { events += "n:" + std::to_string(static_cast<int>(value)) + ";"; return true; }
+    bool boolean(bool value) override { events += value ? "true;" : "false;"; return true; }
+    bool null() override { events += "null;"; return ++nulls < stopAfterNulls; }
+
+    std::string events;
+    int nulls{ 0 };
+    int stopAfterNulls{ 100 };
+};
+
+TEST(NtJSONDocumentTest, NtJSONReader)
+{
+    std::string text = R"({ "a": [ 1, -20, { "b\n": "x\"y" } ], "c": true, "d": null, "e": "\ud83d\ude00", "f": [] })";
+    std::string expected = "{k:a;[n:1;n:-20;{k:b\n;s:x\"y;}]k:c;true;k:d;null;k:e;s:\xF0\x9F\x98\x80;k:f;[]}";
+
+    for (size_t chunk = 1; chunk <= text.size(); ++chunk) {
+        NtJSONRecorder recorder;
+        NtJSONReader reader(&recorder);
+
+        for (size_t pos = 0; pos < text.size(); pos += chunk)
+            EXPECT_TRUE(reader.feed(text.data() + pos, std::min(chunk, text.size() - pos)));
+
+        EXPECT_TRUE(reader.finish());
+        EXPECT_EQ(expected, recorder.events);
+    }
+}
+
+TEST(NtJSONDocumentTest, NtJSONReaderLimits)
+{
+    NtJSONRecorder recorder;
+    NtJSONReader reader(&recorder);
+
+    reader.setMaxDepth(3);
+    EXPECT_TRUE(reader.feed("[[[]]]"));
+    EXPECT_TRUE(reader.finish());
+    EXPECT_THROW(reader.feed("[[[["), NtSyntaxError);
+
+    reader.reset();
+    reader.feed("[1, 2");
+    EXPECT_THROW(reader.finish(), NtSyntaxError);
+
+    reader.reset();
+    EXPECT_THROW(reader.feed("[1] 2"), NtSyntaxError);
+
+    reader.reset();
+    EXPECT_THROW(reader.feed("[1e400]"), NtSyntaxError);
+
+    reader.reset();
+    recorder.events.clear();
+    reader.setMultipleValues(true);
+    EXPECT_TRUE(reader.feed("{\"a\":1}\n{\"a\":2}\n3"));
+    EXPECT_TRUE(reader.finish());
+    EXPECT_EQ("{k:a;n:1;}{k:a;n:2;}n:3;", recorder.events);
+
+    // Adjacent root scalars need whitespace between them, as in single
+    // value mode.
+    for (const char* bad : { "true1", "1\"a\"", "\"a\"\"b\"", "null{}" }) {
+        reader.reset();
+        EXPECT_THROW(reader.feed(bad), NtSyntaxError);
+    }
+
+    reader.reset();
+    EXPECT_TRUE(reader.feed("true 1\t\"a\"\n\"b\" {}[]"));
+    EXPECT_TRUE(reader.finish());
+
+    // A single token may not grow past the limit, whether it arrives in
+    // one chunk, split across feeds or as escapes.
+    reader.setMaxTokenSize(8);
+    EXPECT_TRUE(reader.feed("[\"12345678\", 12345678]"));
+    EXPECT_TRUE(reader.finish());
+    EXPECT_THROW(reader.feed("[\"123456789\"]"), NtSyntaxError);
+
+    reader.reset();
+    EXPECT_TRUE(reader.feed("[\"12345"));
+    EXPECT_THROW(reader.feed("6789"), NtSyntaxError);
+
+    reader.reset();
+    EXPECT_THROW(reader.feed("[\"\\n\\n\\n\\n\\n\\n\\n\\n\\n\"]"), NtSyntaxError);
+
+    reader.reset();
+    EXPECT_THROW(reader.feed("[123456789]"), NtSyntaxError);
+
+    reader.reset();
+    reader.setMaxTokenSize(16 * 1024 * 1024);
+    reader.setMultipleValues(false);
+    recorder.events.clear();
+
+    recorder.stopAfterNulls = 1;
+    EXPECT_FALSE(reader.feed("[null, null]"));
+    EXPECT_FALSE(reader.finish());
+}
+
+TEST(NtJSONDocumentTest, NtNDJSONParser)
+{
+    NtThreadPool pool(4);
+    std::string text;
+
+    for (int i = 0; i < 2000; ++i)
+        text += "{ \"id\": " + std::to_string(i) + ", \"name\": \"record\" }\n" + (i % 100 ? "" : "\r\n");
+
+    std::vector<NtJSONDocument> docs = NtParseNDJSON(text.data(), text.size(), pool);
+    ASSERT_EQ(2000, docs.size());
+
+    size_t memory = 0;
+
+    for (int i = 0; i < 2000; ++i) {
+        EXPECT_EQ(i, docs[i].root()["id"].asInt64());
+        memory += docs[i].memoryUsage();
+    }
+
+    // Records hold memory in proportion to their size, not an arena block
+    // each.
+    EXPECT_LT(memory, 8 * text.size());
+
+    NtNDJSONParser parser(pool, 100);
+    int expected = 0;
+
+    for (size_t pos = 0; pos < text.size(); pos += 37) {
+        parser.feed(std::string_view(text).substr(pos, 37));
+
+        for (auto& doc : parser)
+            EXPECT_EQ(expected++, doc.root()["id"].asInt64());
+    }
+
+    parser.feed("[1, 2]");
+    parser.finish();
+
+    for (auto& doc : parser) {
+        if (doc.root().isArray())
+            EXPECT_EQ(2, doc.root().count());
+        else
+            EXPECT_EQ(expected++, doc.root()["id"].asInt64());
+    }
+
+    EXPECT_EQ(2000, expected);
+    EXPECT_EQ(2001, parser.recordCount());
+
+    parser.feed("{}\n{ bad }\n[]");
+    parser.finish();
+
+    NtJSONDocument doc;
+    EXPECT_TRUE(parser.next(doc));
+    EXPECT_THROW(parser.next(doc), NtSyntaxError);
+    EXPECT_EQ(2003, parser.recordCount());
+    EXPECT_TRUE(parser.next(doc));
+    EXPECT_TRUE(doc.root().isArray());
+    EXPECT_FALSE(parser.next(doc));
+}
+
+static void NtDeleteTestTree(NtJSONElement* element)
+{
+    if (element->type() == NtJSONElement::Type::OBJECT) {
+        for (auto& member : *static_cast<NtJSONObject*>(element))
+            NtDeleteTestTree(member.second);
+    } else if (element->type() == NtJSONElement::Type::ARRAY) {
+        for (auto* child : *static_cast<NtJSONArray*>(element))
+            NtDeleteTestTree(child);
+    }
+
+    delete element;
+}
+
+TEST(NtJSONDocumentTest, NtMessagePack)
+{
+    std::string text = R"({"a":1,"b":[true,null,-1,300,"x"],"c":1.5})";
+    NtJSONDocument doc;
+    doc.parse(text);
+
+    std::string expected("\x83\xa1" "a\x01\xa1" "b\x95\xc3\xc0\xff\xcd\x01\x2c\xa1" "x\xa1" "c"
+        "\xcb\x3f\xf8\x00\x00\x00\x00\x00\x00", 26);
+    std::string data = NtEncodeMessagePack(doc.root());
+    EXPECT_EQ(expected, data);
+
+    NtJSONDocument decoded;
+    NtParseMessagePack(data.data(), data.size(), decoded);
+    EXPECT_EQ(text, NtSerializeJSON(decoded.root()));
+
+    NtJSONElement* tree = NtParseMessagePack(data.data(), data.size());
+    ASSERT_EQ(NtJSONElement::Type::OBJECT, tree->type());
+    EXPECT_EQ(text, NtSerializeJSON(tree));
+    EXPECT_EQ(expected, NtEncodeMessagePack(tree));
+    NtDeleteTestTree(tree);
+
+    NtJSONNumber big(UINT64_MAX);
+    data = NtEncodeMessagePack(&big);
+    EXPECT_EQ(std::string("\xcf\xff\xff\xff\xff\xff\xff\xff\xff", 9), data);
+    NtParseMessagePack(data.data(), data.size(), decoded);
+    EXPECT_EQ(NtJSONNumber::Kind::UNSIGNED, decoded.root().numberKind());
+
+    std::string longText(300, 'z');
+    NtJSONString str(longText);
+    data = NtEncodeMessagePack(&str);
+    EXPECT_EQ(std::string("\xda\x01\x2c", 3), data.substr(0, 3));
+    NtParseMessagePack(data.data(), data.size(), decoded);
+    EXPECT_EQ(longText, decoded.root().asString());
+
+    // Binary values are not UTF-8, so they arrive as base64url text that
+    // serializes to valid JSON.
+    std::string bin("\x82\xa1" "b\xc4\x04\xff\xfe\x00\x80\xa1" "c\xc5\x00\x01\xfb", 15);
+    NtParseMessagePack(bin.data(), bin.size(), decoded);
+    EXPECT_EQ(R"({"b":"__4AgA","c":"-w"})", NtSerializeJSON(decoded.root()));
+
+    for (std::string bad : { std::string("\x92\x01", 2), std::string("\x01\x02", 2),
+            std::string("\xd4\x01\x00", 3), std::string("\x81\x01\x01", 3), std::string("\xa3" "ab", 3) })
+        EXPECT_THROW(NtParseMessagePack(bad.data(), bad.size(), decoded), NtSyntaxError);
+
+    EXPECT_FALSE(decoded.root().isValid());
+}
+
+TEST(NtJSONDocumentTest, NtCBOR)
+{
+    std::string text = R"({"a":1,"b":[true,null,-1,300,"x"],"c":1.5})";
+    NtJSONDocument doc;
+    doc.parse(text);
+
+    std::string expected("\xa3\x61" "a\x01\x61" "b\x85\xf5\xf6\x20\x19\x01\x2c\x61" "x\x61" "c"
+        "\xfb\x3f\xf8\x00\x00\x00\x00\x00\x00", 26);
+    std::string data = NtEncodeCBOR(doc.root());
+    EXPECT_EQ(expected, data);
+
+    NtJSONDocument decoded;
+    NtParseCBOR(data.data(), data.size(), decoded);
+    EXPECT_EQ(text, NtSerializeJSON(decoded.root()));
+
+    NtJSONElement* tree = NtParseCBOR(data.data(), data.size());
+    EXPECT_EQ(expected, NtEncodeCBOR(tree));
+    NtDeleteTestTree(tree);
+
+    // Indefinite lengths, half floats and tags
+    std::string extra("\xbf\x61" "a\x9f\x01\x82\x02\x03\xff\x61" "h\xf9\xc4\x00\x7f\x62" "ab\x61" "c\xff"
+        "\xc1\x1a\x00\x00\x00\x01\x61" "u\xf7\xff", 31);
+    NtParseCBOR(extra.data(), extra.size(), decoded);
+    EXPECT_EQ(R"({"a":[1,[2,3]],"h":-4,"abc":1,"u":null})", NtSerializeJSON(decoded.root()));
+
+    std::string negative("\x3b\xff\xff\xff\xff\xff\xff\xff\xff", 9);
+    NtParseCBOR(negative.data(), negative.size(), decoded);
+    EXPECT_EQ(NtJSONNumber::Kind::DOUBLE, decoded.root().numberKind());
+    EXPECT_EQ(-18446744073709551616.0, decoded.root().asNumber());
+
+    NtJSONNumber min(INT64_MIN);
+    data = NtEncodeCBOR(&min);
+    EXPECT_EQ(std::string("\x3b\x7f\xff\xff\xff\xff\xff\xff\xff", 9), data);
+    NtParseCBOR(data.data(), data.size(), decoded);
+    EXPECT_EQ(INT64_MIN, decoded.root().asInt64());
+
+    std::string bin("\xa2\x61" "b\x44\xff\xfe\x00\x80\x61" "c\x5f\x41\xfb\x42\xef\xbe\xff", 17);
+    NtParseCBOR(bin.data(), bin.size(), decoded);
+    EXPECT_EQ(R"({"b":"__4AgA","c":"----"})", NtSerializeJSON(decoded.root()));
+
+    for (std::string bad : { std::string("\x82\x01", 2), std::string("\x01\x02", 2), std::string("\xa1\x01\x01", 3),
+            std::string("\x1f", 1), std::string("\xff", 1), std::string("\x7f\x01\xff", 3) })
+        EXPECT_THROW(NtParseCBOR(bad.data(), bad.size(), decoded), NtSyntaxError);
+}
+
+TEST(NtJSONDocumentTest, NtJSONFormat)
+{
+    EXPECT_EQ(NtJSONFormat::JSON, NtNegotiateJSONFormat(""));
+    EXPECT_EQ(NtJSONFormat::JSON, NtNegotiateJSONFormat("*/*"));
+    EXPECT_EQ(NtJSONFormat::CBOR, NtNegotiateJSONFormat("application/cbor"));
+    EXPECT_EQ(NtJSONFormat::MESSAGEPACK, NtNegotiateJSONFormat("application/json;q=0.5, application/x-msgpack"));
+    EXPECT_EQ(NtJSONFormat::JSON, NtNegotiateJSONFormat("application/msgpack;q=0, text/html"));
+    EXPECT_EQ(NtJSONFormat::JSON, NtNegotiateJSONFormat("application/cbor; q=0.8, application/json; q=0.8"));
+    EXPECT_EQ(NtJSONFormat::CBOR, NtNegotiateJSONFormat("text/html, application/CBOR;q=0.9, */*;q=0.1"));
+    EXPECT_EQ(NtJSONFormat::MESSAGEPACK, NtJSONFormatFromContentType("application/vnd.msgpack; charset=binary"));
+
+    NtJSONDocument doc;
+    doc.parse(R"({"id":7,"tags":["a","b"]})");
+    std::string body = NtEncodeJSON(doc.root(), NtJSONFormat::CBOR);
+
+    std::string message = "POST /items HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/cbor\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    NtHTTPRequest* req = NtParseHTTPRequest(message.data(), message.size());
+    EXPECT_EQ(body, req->body());
+    EXPECT_EQ(NtJSONFormat::CBOR, req->bodyFormat());
+
+    NtJSONDocument received;
+    req->parseBody(received);
+    EXPECT_EQ(7, received.root()["id"].asInt64());
+    delete req;
+
+    NtHTTPResponse resp("HTTP/1.1 200 OK");
+    resp.setJSONBody(received.root(), NtJSONFormat::MESSAGEPACK);
+    EXPECT_EQ("application/msgpack", resp.getHeader("Content-Type")->value());
+    EXPECT_EQ(std::to_string(resp.body().size()), resp.getHeader("Content-Length")->value());
+
+    NtDecodeJSON(resp.body().data(), resp.body().size(), NtJSONFormat::MESSAGEPACK, received);
+    EXPECT_EQ(R"({"id":7,"tags":["a","b"]})", NtSerializeJSON(received.root()));
+
+    resp.setJSONBody(received.root());
+    EXPECT_EQ(2, resp.headerCount());
+    EXPECT_EQ(R"({"id":7,"tags":["a","b"]})", resp.body());
+}
@@ -7,8 +7,50 @@
 #include "newton/newton.h"
 using namespace newton;
 
+#include "json/NtUTF8.h"
+
+#include <cmath>
+#include <cstdio>
 #include <fstream>
 
+struct NtTestPoint
+{
+    double x{ 0.0 };
+    double y{ 0.0 };
+};
+
+NT_JSON_BIND(NtTestPoint,
+    NT_JSON_FIELD(x),
+    NT_JSON_FIELD(y))
+
+struct NtTestShape
+{
+    int64_t id{ 0 };
+    uint32_t flags{ 0 };
+    bool isClosed{ false };
+    std::string name;
+    std::vector<NtTestPoint> points;
+    std::optional<std::string> label;
+    std::optional<int> layer;
+};
+
+NT_JSON_BIND(NtTestShape,
+    NT_JSON_FIELD(id),
+    NT_JSON_FIELD(flags),
+    NT_JSON_NAMED_FIELD("closed", isClosed),
+    NT_JSON_FIELD(name),
+    NT_JSON_FIELD(points),
+    NT_JSON_FIELD(label),
+    NT_JSON_FIELD(layer))
+
+struct NtTestFlags
+{
+    std::vector<bool> bits;
+};
+
+NT_JSON_BIND(NtTestFlags,
+    NT_JSON_FIELD(bits))
+
 TEST(NtJSONTest, NtJSONObject)
 {
     NtJSONObject* obj = new NtJSONObject();
@@ -27,6 +69,36 @@ TEST(NtJSONTest, NtJSONObject)
     obj = nullptr;
 }
 
+TEST(NtJSONTest, NtJSONObjectMembers)
+{
+    NtJSONObject* obj = new NtJSONObject();
+    NtJSONNull* null = new NtJSONNull();
+
+    for (int i = 40; i > 0; --i)
+        obj->add("k" + std::to_string(i), null);
+
+    obj->add("k1", nullptr);
+
+    EXPECT_EQ(40, obj->count());
+    EXPECT_EQ("k40", obj->begin()->first);
+    EXPECT_EQ("k1", (obj->end() - 1)->first);
+    EXPECT_EQ(null, obj->get("k1"));
+    EXPECT_EQ(null, (*obj)["k23"]);
+    EXPECT_EQ(nullptr, obj->get("k41"));
+    EXPECT_EQ(40, obj->count());
+
+    for (int i = 40; i > 5; --i)
+        obj->remove("k" + std::to_string(i));
+
+    EXPECT_EQ(5, obj->count());
+    EXPECT_EQ(nullptr, obj->get("k6"));
+    EXPECT_EQ(null, obj->get("k5"));
+    EXPECT_EQ("{\"k5\":null,\"k4\":null,\"k3\":null,\"k2\":null,\"k1\":null}", NtSerializeJSON(obj));
+
+    delete null;
+    delete obj;
+}
+
 TEST(NtJSONTest, NtJSONArray)
 {
     NtJSONArray* arr = new NtJSONArray();
@@ -131,3 +203,452 @@ TEST(NtJSONTest, NtJSONParse)
     delete buf;
     buf = nullptr;
 }
+
+TEST(NtJSONTest, NtJSONParseFile)
+{
+    NtJSONObject* obj = NtParseJSONFile("test.json");
+    EXPECT_EQ(1, obj->count());
+    EXPECT_EQ(NtJSONElement::Type::OBJECT, obj->get("quiz")->type());
+
+    NtMappedFile file("test.json");
+    EXPECT_TRUE(file.isOpen());
+    EXPECT_EQ('{', file.data()[0]);
+
+    NtJSONDocument doc;
+    doc.parseFile("test.json");
+    EXPECT_EQ("Los Angeles Kings", doc.root()["quiz"]["sport"]["q1"]["options"][1].asString());
+    EXPECT_EQ(NtSerializeJSON(obj), NtSerializeJSON(doc.root()));
+
+    NtJSONDocument copy;
+    copy.parse(file.view());
+    EXPECT_EQ(NtSerializeJSON(copy.root()), NtSerializeJSON(doc.root()));
+    EXPECT_LT(doc.memoryUsage(), copy.memoryUsage());
+
+    EXPECT_THROW(NtParseJSONFile("missing.json"), NtRuntimeException);
+    EXPECT_THROW(doc.parseFile("missing.json"), NtRuntimeException);
+    EXPECT_FALSE(doc.root().isValid());
+
+    delete obj;
+}
+
+TEST(NtJSONTest, NtJSONParseBuffer)
+{
+    const char data[] = "{ \"a\": \"x\\u0000y\", \"b\": [1, 2] }garbage";
+    size_t len = strlen("{ \"a\": \"x\\u0000y\", \"b\": [1, 2] }");
+
+    NtJSONObject* obj = NtParseJSON(data, len);
+    EXPECT_EQ(2, obj->count());
+
+    NtJSONArray* arr = static_cast<NtJSONArray*>(obj->get("b"));
+    EXPECT_EQ(2, arr->count());
+
+    NtJSONObject* obj2 = NtParseJSON(std::string_view("{\"k\":\"a\\u0000b\"}"));
+    EXPECT_EQ(3, static_cast<NtJSONString*>(obj2->get("k"))->value().size());
+
+    // A raw NUL is a control character and must be escaped.
+    std::string withNul("{\"k\":\"a\0b\"}", 11);
+    EXPECT_THROW(NtParseJSON(std::string_view(withNul)), NtSyntaxError);
+
+    EXPECT_THROW(NtParseJSON(data, len - 1), NtSyntaxError);
+    EXPECT_THROW(NtParseJSON("{\"k\": \"unterminated"), NtSyntaxError);
+}
+
+/**
+ * Unicode cases run once per UTF-8 validator kernel.
+ */
+static void NtCheckJSONUnicode()
+{
+    std::string text = "{ \"a\": \"\\u00e9\\u20ac\\ud83d\\ude00\", \"b\": \"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 "
+        "and a long tail after the escapes\\n\", \"c\": \"\\ud83d\" }";
+    std::string a = "\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80";
+    std::string b = "caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 and a long tail after the escapes\n";
+
+    NtJSONObject* obj = NtParseJSON(text);
+    EXPECT_EQ(a, static_cast<NtJSONString*>(obj->get("a"))->value());
+    EXPECT_EQ(b, static_cast<NtJSONString*>(obj->get("b"))->value());
+    EXPECT_EQ("\xef\xbf\xbd", static_cast<NtJSONString*>(obj->get("c"))->value());
+
+    for (const char* key : { "a", "b", "c" })
+        delete obj->get(key);
+
+    delete obj;
+
+    NtJSONDocument doc;
+    doc.parse(text);
+    EXPECT_EQ(a, doc.root()["a"].asString());
+    EXPECT_EQ(b, doc.root()["b"].asString());
+    EXPECT_EQ(b, NtJSONCursor(text)["b"].asString());
+
+    for (const char* bad : { "{\"k\": \"\xc3\"}", "{\"k\": \"\xc0\xaf\"}", "{\"k\": \"\xed\xa0\x80\"}",
+            "{\"k\": \"a long run of text before a stray \x80 byte\"}", "{\"k\": \"\xf4\x90\x80\x80\"}" }) {
+        EXPECT_THROW(NtParseJSON(bad), NtSyntaxError);
+        EXPECT_THROW(doc.parse(bad), NtSyntaxError);
+        EXPECT_THROW(NtJSONCursor(bad)["k"].asString(), NtSyntaxError);
+
+        NtJSONTreeBuilder builder;
+        NtJSONReader reader(&builder);
+        EXPECT_THROW(reader.feed(bad), NtSyntaxError);
+    }
+
+    EXPECT_THROW(NtParseJSON("{\"k\": \"\\u12g4\"}"), NtSyntaxError);
+
+    // Control characters must be escaped, in short strings and in runs
+    // long enough for the vector scan.
+    for (std::string bad : { std::string("{\"k\":\"a\x01" "b\\n\"}"), std::string("{\"k\":\"line\nbreak\"}"),
+            std::string("{\"k\":\"a tab\tafter\"}"), std::string("{\"k\":\"a long run of text with a nul \0 inside\"}", 46) }) {
+        EXPECT_THROW(NtParseJSON(bad), NtSyntaxError);
+        EXPECT_THROW(doc.parse(bad), NtSyntaxError);
+        EXPECT_THROW(NtJSONCursor(bad)["k"].asString(), NtSyntaxError);
+
+        NtJSONTreeBuilder builder;
+        NtJSONReader reader(&builder);
+        EXPECT_THROW(reader.feed(bad.data(), bad.size()), NtSyntaxError);
+
+        std::ofstream("control.json", std::ios::binary) << bad;
+        EXPECT_THROW(doc.parseFile("control.json"), NtSyntaxError);
+    }
+
+    std::remove("control.json");
+
+    // A sequence split between two feeds is still valid.
+    NtJSONTreeBuilder builder;
+    NtJSONReader reader(&builder);
+    EXPECT_TRUE(reader.feed("[\"\xe2\x82"));
+    EXPECT_TRUE(reader.feed("\xac\"]"));
+    EXPECT_TRUE(reader.finish());
+
+    NtJSONElement* root = builder.take();
+    NtJSONElement* str = static_cast<NtJSONArray*>(root)->get(0);
+    EXPECT_EQ("\xe2\x82\xac", static_cast<NtJSONString*>(str)->value());
+    delete str;
+    delete root;
+}
+
+TEST(NtJSONTest, NtJSONUnicode)
+{
+    std::string selected = NtUTF8Kernel();
+
+    for (const char* kernel : NtUTF8Kernels()) {
+        SCOPED_TRACE(kernel);
+        ASSERT_TRUE(NtSetUTF8Kernel(kernel));
+        NtCheckJSONUnicode();
+    }
+
+    EXPECT_TRUE(NtSetUTF8Kernel(selected.c_str()));
+}
+
+TEST(NtJSONTest, NtUTF8Kernels)
+{
+    std::string selected = NtUTF8Kernel();
+
+    struct NtTestSequence
+    {
+        const char* bytes;
+        bool isValid;
+    };
+
+    const NtTestSequence sequences[] = {
+        { "\xc3\xa9", true }, { "\xe2\x82\xac", true }, { "\xf0\x9f\x98\x80", true }, { "\xf4\x8f\xbf\xbf", true },
+        { "\xc3", false }, { "\x80", false }, { "\xc0\xaf", false }, { "\xe0\x80\xaf", false },
+        { "\xed\xa0\x80", false }, { "\xf4\x90\x80\x80", false }, { "\xf8\x88\x80\x80\x80", false },
+        { "\xe2\x82", false }, { "\xc3\xa9\xa9", false },
+    };
+
+    // Move each sequence across the 16 and 32-byte chunks of the vector
+    // kernels. The leading two-byte character keeps the text off the ASCII
+    // fast path.
+    for (const char* kernel : NtUTF8Kernels()) {
+        SCOPED_TRACE(kernel);
+        ASSERT_TRUE(NtSetUTF8Kernel(kernel));
+
+        for (const NtTestSequence& seq : sequences) {
+            for (size_t pad = 0; pad < 70; ++pad) {
+                std::string text = "\xc3\xa9" + std::string(pad, 'a') + seq.bytes;
+                EXPECT_EQ(seq.isValid, NtValidateUTF8(text.data(), text.size())) << pad;
+
+                text += std::string(40, 'b');
+                EXPECT_EQ(seq.isValid, NtValidateUTF8(text.data(), text.size())) << pad;
+            }
+        }
+    }
+
+    EXPECT_FALSE(NtSetUTF8Kernel("none"));
+    EXPECT_TRUE(NtSetUTF8Kernel(selected.c_str()));
+}
+
+TEST(NtJSONTest, NtJSONUnpairedSurrogates)
+{
+    // Surrogates without their pair have no UTF-8 encoding and become
+    // U+FFFD, so documents that are accepted can be written and read again.
+    std::string text = R"(["\ud800", "\udc00x", "\ud83d\u0041", "\ud83d\ud83d\ude00", "\ude00\ud83d"])";
+    const char* expected[] = { "\xef\xbf\xbd", "\xef\xbf\xbdx", "\xef\xbf\xbd" "A", "\xef\xbf\xbd\xf0\x9f\x98\x80",
+        "\xef\xbf\xbd\xef\xbf\xbd" };
+
+    NtJSONDocument doc;
+    doc.parse(text);
+
+    for (size_t i = 0; i < 5; ++i) {
+        EXPECT_EQ(expected[i], doc.root()[i].asString());
+        EXPECT_EQ(expected[i], NtJSONCursor(text)[i].asString());
+    }
+
+    NtJSONTreeBuilder builder;
+    NtJSONReader reader(&builder);
+    EXPECT_TRUE(reader.feed(text));
+    EXPECT_TRUE(reader.finish());
+
+    NtJSONArray* root = static_cast<NtJSONArray*>(builder.take());
+
+    for (size_t i = 0; i < 5; ++i)
+        EXPECT_EQ(expected[i], static_cast<NtJSONString*>(root->get(i))->value());
+
+    std::string written = NtSerializeJSON(root);
+    NtJSONDocument reparsed;
+    reparsed.parse(written);
+    EXPECT_EQ(written, NtSerializeJSON(reparsed.root()));
+    EXPECT_EQ(NtSerializeJSON(doc.root()), written);
+
+    for (size_t i = 0; i < 5; ++i)
+        delete root->get(i);
+
+    delete root;
+}
+
+TEST(NtJSONTest, NtJSONWriter)
+{
+    NtJSONObject* root = new NtJSONObject();
+    NtJSONArray* list = new NtJSONArray();
+    list->add(new NtJSONNumber(1.5));
+    list->add(new NtJSONNumber(-3));
+    list->add(new NtJSONBoolean(true));
+    list->add(new NtJSONNull());
+    root->add("list", list);
+    root->add("name", new NtJSONString(std::string("a \"quoted\"\tline\n with a long tail \\ and \x01")));
+
+    EXPECT_EQ("{\"list\":[1.5,-3,true,null],\"name\":\"a \\\"quoted\\\"\\tline\\n with a long tail \\\\ and \\u0001\"}",
+        NtSerializeJSON(root));
+
+    EXPECT_EQ("{\n    \"list\": [\n        1.5,\n        -3,\n        true,\n        null\n    ],\n    \"name\": \"a \\\"quoted\\\"\\tline\\n with a long tail \\\\ and \\u0001\"\n}",
+        NtSerializeJSON(root, true));
+
+    for (size_t i = 0; i < list->count(); ++i)
+        delete list->get(i);
+
+    delete list;
+    delete root->get("name");
+    delete root;
+
+    NtJSONWriter writer;
+    writer.startObject();
+    writer.key("empty");
+    writer.startArray();
+    writer.endArray();
+    writer.key("big");
+    writer.integer(9007199254740993LL);
+    writer.key("third");
+    writer.number(1.0 / 3.0);
+    writer.endObject();
+    EXPECT_EQ("{\"empty\":[],\"big\":9007199254740993,\"third\":0.3333333333333333}", writer.take());
+}
+
+TEST(NtJSONTest, NtJSONWriterStreaming)
+{
+    std::string text = R"({ "a": [ 1, 2.25, "x\u00e9" ], "b": { "c": null, "d": false } })";
+    std::string compact = "{\"a\":[1,2.25,\"x\xC3\xA9\"],\"b\":{\"c\":null,\"d\":false}}";
+
+    NtJSONDocument doc;
+    doc.parse(text);
+    EXPECT_EQ(compact, NtSerializeJSON(doc.root()));
+
+    std::string out;
+    NtJSONWriter writer;
+    writer.setSink([&out](const char* data, size_t len) { out.append(data, len); }, 4);
+
+    NtJSONReader reader(&writer);
+    EXPECT_TRUE(reader.feed(text));
+    EXPECT_TRUE(reader.finish());
+    writer.flush();
+
+    EXPECT_EQ(compact, out);
+    EXPECT_TRUE(writer.buffer().empty());
+}
+
+TEST(NtJSONTest, NtJSONNumberKinds)
+{
+    NtJSONObject* root = NtParseJSON(R"({ "id": 9007199254740993, "max": 18446744073709551615,
+        "min": -9223372036854775808, "pi": 3.14159, "exp": 1e300, "huge": 123456789012345678901234567890 })");
+
+    NtJSONNumber* id = static_cast<NtJSONNumber*>(root->get("id"));
+    EXPECT_EQ(NtJSONNumber::Kind::INTEGER, id->kind());
+    EXPECT_EQ(9007199254740993LL, id->toInt64());
+    EXPECT_EQ("9007199254740993", id->toString());
+
+    NtJSONNumber* max = static_cast<NtJSONNumber*>(root->get("max"));
+    EXPECT_EQ(NtJSONNumber::Kind::UNSIGNED, max->kind());
+    EXPECT_EQ(18446744073709551615ULL, max->toUInt64());
+
+    NtJSONNumber* min = static_cast<NtJSONNumber*>(root->get("min"));
+    EXPECT_EQ(INT64_MIN, min->toInt64());
+
+    NtJSONNumber* pi = static_cast<NtJSONNumber*>(root->get("pi"));
+    EXPECT_EQ(NtJSONNumber::Kind::DOUBLE, pi->kind());
+    EXPECT_EQ(3.14159, pi->value());
+    EXPECT_EQ("3.14159", pi->toString());
+
+    EXPECT_EQ(1e300, static_cast<NtJSONNumber*>(root->get("exp"))->value());
+    EXPECT_EQ(NtJSONNumber::Kind::DOUBLE, static_cast<NtJSONNumber*>(root->get("huge"))->kind());
+
+    for (const char* key : { "id", "max", "min", "pi", "exp", "huge" })
+        delete root->get(key);
+
+    delete root;
+
+    for (const char* bad : { "{\"a\": 01}", "{\"a\": -}", "{\"a\": 1.}", "{\"a\": 1e}", "{\"a\": .5}", "{\"a\": +1}" })
+        EXPECT_THROW(NtParseJSON(bad), NtSyntaxError);
+
+    std::string text = "[9007199254740993,18446744073709551615,-5,0.1,2.5e-08]";
+    NtJSONDocument doc;
+    doc.parse(text);
+    EXPECT_EQ(9007199254740993LL, doc.root()[0].asInt64());
+    EXPECT_EQ(NtJSONNumber::Kind::UNSIGNED, doc.root()[1].numberKind());
+    EXPECT_EQ(text, NtSerializeJSON(doc.root()));
+    EXPECT_EQ(18446744073709551615ULL, NtJSONCursor(text)[1].asUInt64());
+
+    NtJSONNumber fromString("-42");
+    EXPECT_EQ(-42, fromString.toInt64());
+    EXPECT_TRUE(fromString.isInteger());
+}
+
+TEST(NtJSONTest, NtJSONNumberRange)
+{
+    // Numbers too small for a double are zero, too large ones are invalid.
+    std::string text = "[1e-400,-1e-400,0.0000001e-320,1.7976931348623157e308,10000e-4]";
+    NtJSONDocument doc;
+    doc.parse(text);
+    EXPECT_EQ(0.0, doc.root()[0].asNumber());
+    EXPECT_TRUE(std::signbit(doc.root()[1].asNumber()));
+    EXPECT_EQ(0.0, doc.root()[2].asNumber());
+    EXPECT_EQ(1.7976931348623157e308, doc.root()[3].asNumber());
+    EXPECT_EQ(1.0, doc.root()[4].asNumber());
+    EXPECT_EQ(0.0, NtJSONCursor(text)[0].asNumber());
+
+    NtJSONObject* root = NtParseJSON("{\"a\": -1e-400}");
+    EXPECT_EQ(0.0, static_cast<NtJSONNumber*>(root->get("a"))->value());
+    delete root->get("a");
+    delete root;
+
+    for (const char* bad : { "1e400", "-1e400", "0.01e311", "123456789e301" }) {
+        std::string array = std::string("[") + bad + "]";
+        EXPECT_THROW(NtParseJSON(std::string("{\"a\": ") + bad + "}"), NtSyntaxError);
+        EXPECT_THROW(doc.parse(array), NtSyntaxError);
+        EXPECT_THROW(NtJSONCursor(array)[0].asNumber(), NtSyntaxError);
+    }
+}
+
+TEST(NtJSONTest, NtJSONBinding)
+{
+    NtTestShape shape;
+    NtDeserializeJSON(R"({ "id": 9007199254740993, "unknown": { "deep": [1, 2] }, "flags": 7,
+        "closed": true, "n\u0061me": "tri\nangle", "points": [ { "x": 1, "y": 2.5 }, { "y": -1 } ], "label": null })", shape);
+
+    EXPECT_EQ(9007199254740993LL, shape.id);
+    EXPECT_EQ(7, shape.flags);
+    EXPECT_TRUE(shape.isClosed);
+    EXPECT_EQ("tri\nangle", shape.name);
+    EXPECT_EQ(2, shape.points.size());
+    EXPECT_EQ(2.5, shape.points[0].y);
+    EXPECT_EQ(0.0, shape.points[1].x);
+    EXPECT_FALSE(shape.label.has_value());
+    EXPECT_FALSE(shape.layer.has_value());
+
+    EXPECT_EQ(R"({"id":9007199254740993,"flags":7,"closed":true,"name":"tri\nangle","points":[{"x":1,"y":2.5},{"x":0,"y":-1}]})",
+        NtSerializeJSON(shape));
+
+    shape.label = "a";
+    shape.layer = 3;
+
+    NtTestShape copy;
+    NtDeserializeJSON(NtSerializeJSON(shape, true), copy);
+    EXPECT_EQ("a", *copy.label);
+    EXPECT_EQ(3, *copy.layer);
+    EXPECT_EQ(NtSerializeJSON(shape), NtSerializeJSON(copy));
+
+    EXPECT_THROW(NtDeserializeJSON(R"({ "id": "1" })", copy), NtSyntaxError);
+    EXPECT_THROW(NtDeserializeJSON(R"({ "points": {} })", copy), NtSyntaxError);
+    EXPECT_THROW(NtDeserializeJSON("[]", copy), NtSyntaxError);
+
+    NtDeserializeJSON(R"({ "flags": 1e2, "layer": -2147483648 } )" "\n", copy);
+    EXPECT_EQ(100, copy.flags);
+    EXPECT_EQ(-2147483647 - 1, *copy.layer);
+
+    EXPECT_THROW(NtDeserializeJSON(R"({ "flags": -1 })", copy), NtSyntaxError);
+    EXPECT_THROW(NtDeserializeJSON(R"({ "flags": 4294967296 })", copy), NtSyntaxError);
+    EXPECT_THROW(NtDeserializeJSON(R"({ "layer": 2147483648 })", copy), NtSyntaxError);
+    EXPECT_THROW(NtDeserializeJSON(R"({ "id": 3.7 })", copy), NtSyntaxError);
+    EXPECT_THROW(NtDeserializeJSON(R"({ "id": 1e30 })", copy), NtSyntaxError);
+    EXPECT_THROW(NtDeserializeJSON(R"({ "id": 18446744073709551615 })", copy), NtSyntaxError);
+    EXPECT_THROW(NtDeserializeJSON(R"({ "id": 1 } garbage)", copy), NtSyntaxError);
+    EXPECT_THROW(NtDeserializeJSON(R"({ "id": 1 }{})", copy), NtSyntaxError);
+
+    NtTestFlags flags;
+    NtDeserializeJSON(R"({ "bits": [true, false, true] })", flags);
+    EXPECT_EQ(std::vector<bool>({ true, false, true }), flags.bits);
+    EXPECT_EQ(R"({"bits":[true,false,true]})", NtSerializeJSON(flags));
+    EXPECT_THROW(NtDeserializeJSON(R"({ "bits": [true, 1] })", flags), NtSyntaxError);
+}
+
+TEST(NtJSONTest, NtJSONSelector)
+{
+    std::string text = R"({ "store": { "book": [ { "title": "A", "price": 8 }, { "title": "B", "price": 12 } ],
+        "bicycle": { "price": 20 } }, "a/b": 1, "m~n": 2, "": 3, "0": 4 })";
+
+    NtJSONObject* root = NtParseJSON(text);
+    NtJSONDocument doc;
+    doc.parse(text);
+    NtJSONCursor cursor(text);
+
+    NtJSONSelector title("/store/book/1/title");
+    EXPECT_EQ("B", static_cast<NtJSONString*>(title.first(root))->value());
+    EXPECT_EQ("B", title.first(doc.root()).asString());
+    EXPECT_EQ("B", title.first(cursor).asString());
+
+    EXPECT_EQ(1, NtJSONSelector("/a~1b").first(doc.root()).asInt64());
+    EXPECT_EQ(2, NtJSONSelector("/m~0n").first(cursor).asInt64());
+    EXPECT_EQ(3, NtJSONSelector("/").first(doc.root()).asInt64());
+    EXPECT_EQ(4, NtJSONSelector("/0").first(doc.root()).asInt64());
+    EXPECT_TRUE(NtJSONSelector("").first(doc.root()).isObject());
+    EXPECT_FALSE(NtJSONSelector("/store/book/2").first(cursor).isValid());
+    EXPECT_FALSE(NtJSONSelector("/store/book/-").first(doc.root()).isValid());
+    EXPECT_EQ(nullptr, NtJSONSelector("/store/missing").first(root));
+
+    NtJSONSelector prices("$..price");
+    EXPECT_EQ(3, prices.select(root).size());
+    EXPECT_EQ(3, prices.select(doc.root()).size());
+
+    auto found = prices.select(cursor);
+    ASSERT_EQ(3, found.size());
+
+    int64_t sum = 0;
+
+    for (auto& price : found)
+        sum += price.asInt64();
+
+    EXPECT_EQ(40, sum);
+
+    auto titles = NtJSONSelector("$.store.book[*].title").select(doc.root());
+    ASSERT_EQ(2, titles.size());
+    EXPECT_EQ("A", titles[0].asString());
+    EXPECT_EQ("B", titles[1].asString());
+
+    EXPECT_EQ(12, NtJSONSelector("$['store'][\"book\"][1].price").first(cursor).asInt64());
+    EXPECT_EQ(2, NtJSONSelector("$.store.*").select(cursor).size());
+    EXPECT_EQ(1, NtJSONSelector("$.a/b").first(doc.root()).asInt64());
+
+    EXPECT_THROW(NtJSONSelector("store"), NtSyntaxError);
+    EXPECT_THROW(NtJSONSelector("/a~2"), NtSyntaxError);
+    EXPECT_THROW(NtJSONSelector("$.store[01]"), NtSyntaxError);
+    EXPECT_THROW(NtJSONSelector("$.store['book'"), NtSyntaxError);
+    EXPECT_THROW(NtJSONSelector("$..*"), NtSyntaxError);
+
+    delete root;
+}
@@ -0,0 +1,300 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "gtest/gtest.h"
+#include "newton/newton.h"
+using namespace newton;
+
+#include "NtTestSocket.h"
+
+#include <atomic>
+#include <string>
+
+/**
+ * \class NtTestFloodServer
+ * \brief Server that answers every read with a large reply
+ */
+class NtTestFloodServer : public NtServer
+{
+public:
+    bool onRequest(NtContext* ctxPtr) override
+    {
+        std::string reply(ms_replySize, 'x');
+
+        if (!sendData(ctxPtr, reply.data(), reply.size()))
+            return false;
+
+        isBlocked = isSendBlocked(ctxPtr);
+        ++requests;
+        return true;
+    }
+
+    void onWritable(NtContext*) override { ++writables; }
+
+    static constexpr size_t ms_replySize = 8 * 1024 * 1024;
+
+    std::atomic<int> requests{ 0 };
+    std::atomic<int> writables{ 0 };
+    std::atomic<bool> isBlocked{ false };
+};
+
+/**
+ * \class NtTestLoadServer
+ * \brief HTTP server whose load level can be raised by tests
+ */
+class NtTestLoadServer : public NtHTTPServer
+{
+public:
+    NtTestLoadServer()
+    {
+        NtVirtualHost* host = new NtVirtualHost("localhost");
+        host->addRoute(new NtRoute("/"));
+        addHost(host);
+    }
+
+    void overload() { recordQueueDelay(std::chrono::seconds(1000)); }
+
+    /**
+     * Post empty tasks until the load level is no longer over the
+     * thresholds. Every wakeup after an idle millisecond halves it.
+     */
+    bool recover()
+    {
+        return NtWaitFor([this] {
+            post([]() { });
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            return !isShedding() && !isRejecting();
+        });
+    }
+};
+
+static const char NtTestRequest[] = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+static NtTestFloodServer* NtStartFloodServer(int& port)
+{
+    NtTestFloodServer* server = new NtTestFloodServer();
+    port = NtFindFreePort();
+
+    if (!server->initTCPServer("127.0.0.1", port))
+        return nullptr;
+
+    return server;
+}
+
+TEST(NtServerTest, NtSendWaterMarks)
+{
+    int port = 0;
+    NtTestFloodServer* server = NtStartFloodServer(port);
+    ASSERT_NE(nullptr, server);
+    server->setSendWaterMarks(64 * 1024, 16 * 1024);
+
+    int fd = NtConnectLoopback(port, 4096);
+    ASSERT_GE(fd, 0);
+
+    ASSERT_TRUE(NtSendAll(fd, "a"));
+    ASSERT_TRUE(NtWaitFor([&] { return server->requests == 1; }));
+    EXPECT_TRUE(server->isBlocked);
+    EXPECT_GT(server->pendingSendBytes(), 64 * 1024);
+
+    // Paused: the second request stays in the socket.
+    ASSERT_TRUE(NtSendAll(fd, "b"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(1, server->requests);
+    EXPECT_EQ(0, server->writables);
+
+    // Draining the reply resumes the client and reads the request.
+    EXPECT_EQ(NtTestFloodServer::ms_replySize, NtRecvBytes(fd, NtTestFloodServer::ms_replySize));
+    EXPECT_TRUE(NtWaitFor([&] { return server->requests == 2; }));
+    EXPECT_LE(1, server->writables);
+
+    close(fd);
+    EXPECT_TRUE(NtWaitFor([&] { return server->pendingSendBytes() == 0; }));
+}
+
+TEST(NtServerTest, NtGlobalSendWaterMarks)
+{
+    int port = 0;
+    NtTestFloodServer* server = NtStartFloodServer(port);
+    ASSERT_NE(nullptr, server);
+    server->setSendWaterMarks(SIZE_MAX, SIZE_MAX);
+    server->setGlobalSendWaterMarks(64 * 1024, 16 * 1024);
+
+    int first = NtConnectLoopback(port, 4096);
+    int second = NtConnectLoopback(port, 4096);
+    ASSERT_GE(first, 0);
+    ASSERT_GE(second, 0);
+
+    ASSERT_TRUE(NtSendAll(first, "a"));
+    ASSERT_TRUE(NtWaitFor([&] { return server->requests == 1; }));
+    EXPECT_TRUE(server->isBlocked);
+
+    // Over the global mark a client that has queued nothing is paused too.
+    ASSERT_TRUE(NtSendAll(second, "b"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(1, server->requests);
+
+    EXPECT_EQ(NtTestFloodServer::ms_replySize, NtRecvBytes(first, NtTestFloodServer::ms_replySize));
+    EXPECT_TRUE(NtWaitFor([&] { return server->requests == 2; }));
+    EXPECT_LE(2, server->writables);
+
+    EXPECT_EQ(NtTestFloodServer::ms_replySize, NtRecvBytes(second, NtTestFloodServer::ms_replySize));
+
+    close(first);
+    close(second);
+}
+
+TEST(NtServerTest, NtServerPost)
+{
+    NtServer* server = new NtServer();
+    EXPECT_FALSE(server->post([]() { }));
+
+    int port = NtFindFreePort();
+    ASSERT_TRUE(server->initTCPServer("127.0.0.1", port));
+
+    std::atomic<int> runs{ 0 };
+    std::atomic<bool> isOnReactor{ false };
+
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(server->post([&]() {
+            isOnReactor = server->isReactorThread();
+            ++runs;
+        }));
+    }
+
+    EXPECT_TRUE(NtWaitFor([&] { return runs == 100; }));
+    EXPECT_TRUE(isOnReactor);
+    EXPECT_FALSE(server->isReactorThread());
+}
+
+TEST(NtServerTest, NtAdmissionShedding)
+{
+    NtTestLoadServer* server = new NtTestLoadServer();
+    server->setAdmissionThresholds(std::chrono::milliseconds(1), std::chrono::microseconds(0));
+
+    int port = NtFindFreePort();
+    ASSERT_TRUE(server->initTCPServer("127.0.0.1", port));
+
+    int fd = NtConnectLoopback(port);
+    ASSERT_GE(fd, 0);
+
+    std::string buffer;
+    server->overload();
+    EXPECT_TRUE(server->isShedding());
+    EXPECT_FALSE(server->isRejecting());
+
+    // A pipelined pair gets one 503, after which the connection closes
+    // instead of leaving the client waiting for a second response.
+    ASSERT_TRUE(NtSendAll(fd, std::string(NtTestRequest) + NtTestRequest));
+    std::string resp = NtRecvHTTPResponse(fd, buffer);
+    EXPECT_EQ(0u, resp.find("HTTP/1.1 503 Service Unavailable\r\nRetry-After: 1\r\nConnection: close\r\n"));
+    EXPECT_TRUE(buffer.empty());
+    char c = 0;
+    EXPECT_EQ(0, recv(fd, &c, 1, 0));
+    EXPECT_EQ(1u, server->metrics().counters[NT_COUNTER_SHED_REQUESTS]);
+    close(fd);
+
+    ASSERT_TRUE(server->recover());
+    fd = NtConnectLoopback(port);
+    ASSERT_GE(fd, 0);
+    ASSERT_TRUE(NtSendAll(fd, NtTestRequest));
+    EXPECT_EQ(0u, NtRecvHTTPResponse(fd, buffer).find("HTTP/1.1 200 OK"));
+    EXPECT_EQ(1u, server->metrics().counters[NT_COUNTER_SHED_REQUESTS]);
+
+    close(fd);
+}
+
+TEST(NtServerTest, NtAdmissionRejecting)
+{
+    NtTestLoadServer* server = new NtTestLoadServer();
+    server->setAdmissionThresholds(std::chrono::microseconds(0), std::chrono::milliseconds(1));
+
+    int port = NtFindFreePort();
+    ASSERT_TRUE(server->initTCPServer("127.0.0.1", port));
+
+    server->overload();
+    EXPECT_FALSE(server->isShedding());
+    EXPECT_TRUE(server->isRejecting());
+
+    // The connection is reset as soon as it is accepted.
+    int fd = NtConnectLoopback(port);
+    ASSERT_GE(fd, 0);
+    char c = 0;
+    EXPECT_GE(0, recv(fd, &c, 1, 0));
+    close(fd);
+
+    EXPECT_TRUE(NtWaitFor([&] { return server->metrics().counters[NT_COUNTER_REJECTS] == 1; }));
+    EXPECT_EQ(0u, server->metrics().counters[NT_COUNTER_ACCEPTS]);
+
+    ASSERT_TRUE(server->recover());
+    fd = NtConnectLoopback(port);
+    ASSERT_GE(fd, 0);
+
+    std::string buffer;
+    ASSERT_TRUE(NtSendAll(fd, NtTestRequest));
+    EXPECT_EQ(0u, NtRecvHTTPResponse(fd, buffer).find("HTTP/1.1 200 OK"));
+    EXPECT_EQ(1u, server->metrics().counters[NT_COUNTER_ACCEPTS]);
+
+    close(fd);
+}
+
+TEST(NtServerTest, NtMaxClients)
+{
+    NtTestLoadServer* server = new NtTestLoadServer();
+
+    int port = NtFindFreePort();
+    ASSERT_TRUE(server->initTCPServer("127.0.0.1", port, 1));
+
+    std::string firstBuffer;
+    int first = NtConnectLoopback(port);
+    ASSERT_GE(first, 0);
+    ASSERT_TRUE(NtSendAll(first, NtTestRequest));
+    EXPECT_EQ(0u, NtRecvHTTPResponse(first, firstBuffer).find("HTTP/1.1 200 OK"));
+
+    // At the limit the listen socket is paused, so the second connection
+    // waits in the backlog instead of being served.
+    int second = NtConnectLoopback(port);
+    ASSERT_GE(second, 0);
+    ASSERT_TRUE(NtSendAll(second, NtTestRequest));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    char c = 0;
+    EXPECT_EQ(-1, recv(second, &c, 1, MSG_DONTWAIT));
+    EXPECT_EQ(1u, server->metrics().counters[NT_COUNTER_ACCEPTS]);
+    EXPECT_EQ(0u, server->metrics().counters[NT_COUNTER_REJECTS]);
+
+    // Closing the first client makes room and the listen socket resumes.
+    close(first);
+
+    std::string secondBuffer;
+    EXPECT_EQ(0u, NtRecvHTTPResponse(second, secondBuffer).find("HTTP/1.1 200 OK"));
+
+    NtServerMetrics metrics = server->metrics();
+    EXPECT_EQ(2u, metrics.counters[NT_COUNTER_ACCEPTS]);
+    EXPECT_EQ(1u, metrics.connections);
+
+    close(second);
+    ASSERT_TRUE(NtWaitFor([&] { return server->metrics().connections == 0; }));
+
+    // A connection rejected under load never takes the free slot.
+    server->setAdmissionThresholds(std::chrono::microseconds(0), std::chrono::milliseconds(1));
+    server->overload();
+
+    int rejected = NtConnectLoopback(port);
+    ASSERT_GE(rejected, 0);
+    EXPECT_GE(0, recv(rejected, &c, 1, 0));
+    close(rejected);
+    EXPECT_TRUE(NtWaitFor([&] { return server->metrics().counters[NT_COUNTER_REJECTS] == 1; }));
+
+    ASSERT_TRUE(server->recover());
+
+    std::string thirdBuffer;
+    int third = NtConnectLoopback(port);
+    ASSERT_GE(third, 0);
+    ASSERT_TRUE(NtSendAll(third, NtTestRequest));
+    EXPECT_EQ(0u, NtRecvHTTPResponse(third, thirdBuffer).find("HTTP/1.1 200 OK"));
+    EXPECT_EQ(3u, server->metrics().counters[NT_COUNTER_ACCEPTS]);
+
+    close(third);
+}
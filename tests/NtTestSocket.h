@@ -0,0 +1,211 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#pragma once
+
+/**
+ * \file NtTestSocket.h
+ * \brief Loopback socket helpers for tests
+ * \author Hákon Hjaltalín
+ *
+ * This file contains helpers for tests that talk to a server over the
+ * loopback interface. Servers run on a detached reactor thread that never
+ * stops, so tests allocate them and leave them running until exit.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+
+/**
+ * \brief Find free port
+ *
+ * Ask the kernel for a loopback port that is free right now.
+ *
+ * \return Port number, or -1 on failure
+ */
+static inline int NtFindFreePort()
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (fd < 0)
+        return -1;
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t addrLen = sizeof(addr);
+
+    int port = -1;
+
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) == 0 && getsockname(fd, (sockaddr*)&addr, &addrLen) == 0)
+        port = ntohs(addr.sin_port);
+
+    close(fd);
+    return port;
+}
+
+/**
+ * \brief Connect over loopback
+ *
+ * Open a blocking connection to a loopback port. Receives time out after
+ * five seconds so a broken server fails the test instead of hanging it.
+ *
+ * \param port Port number
+ * \param recvBufferSize Receive buffer size, or zero for the default
+ * \return Socket, or -1 on failure
+ */
+static inline int NtConnectLoopback(int port, int recvBufferSize = 0)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (fd < 0)
+        return -1;
+
+    if (recvBufferSize)
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &recvBufferSize, sizeof(recvBufferSize));
+
+    timeval timeout{ 5, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * \brief Send string
+ *
+ * \param fd Socket
+ * \param data Data to send
+ * \return True if all of the data was sent
+ */
+static inline bool NtSendAll(int fd, const std::string& data)
+{
+    size_t sent = 0;
+
+    while (sent < data.size()) {
+        ssize_t len = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+
+        if (len <= 0)
+            return false;
+
+        sent += len;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Receive bytes
+ *
+ * Receive until the given number of bytes has arrived, the peer closes or
+ * the receive times out.
+ *
+ * \param fd Socket
+ * \param len Number of bytes to receive
+ * \return Number of bytes received
+ */
+static inline size_t NtRecvBytes(int fd, size_t len)
+{
+    char buf[65536];
+    size_t total = 0;
+
+    while (total < len) {
+        ssize_t recvd = recv(fd, buf, std::min(sizeof(buf), len - total), 0);
+
+        if (recvd <= 0)
+            break;
+
+        total += recvd;
+    }
+
+    return total;
+}
+
+/**
+ * \brief Receive HTTP response
+ *
+ * Receive one response framed by Content-Length. Bytes received past the
+ * response are kept in the buffer for the next call.
+ *
+ * \param fd Socket
+ * \param buffer Bytes received but not returned yet
+ * \return Response head and body, or an empty string on failure
+ */
+static inline std::string NtRecvHTTPResponse(int fd, std::string& buffer)
+{
+    char buf[4096];
+
+    while (1) {
+        size_t headEnd = buffer.find("\r\n\r\n");
+
+        if (headEnd != std::string::npos) {
+            size_t contentLength = 0;
+            size_t pos = buffer.find("Content-Length:");
+
+            if (pos != std::string::npos && pos < headEnd)
+                contentLength = strtoul(buffer.c_str() + pos + 15, nullptr, 10);
+
+            size_t len = headEnd + 4 + contentLength;
+
+            if (buffer.size() >= len) {
+                std::string ret = buffer.substr(0, len);
+                buffer.erase(0, len);
+                return ret;
+            }
+        }
+
+        ssize_t recvd = recv(fd, buf, sizeof(buf), 0);
+
+        if (recvd <= 0)
+            return std::string();
+
+        buffer.append(buf, recvd);
+    }
+}
+
+/**
+ * \brief Wait for condition
+ *
+ * \param condition Condition to poll
+ * \param timeout Time to wait
+ * \return True if the condition became true in time
+ */
+static inline bool NtWaitFor(const std::function<bool()>& condition,
+        std::chrono::milliseconds timeout = std::chrono::milliseconds(5000))
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return true;
+}
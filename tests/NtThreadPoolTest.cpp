@@ -0,0 +1,73 @@
+// Copyright (c) 2022 Hákon Hjaltalín.
+//
+// This project is licensed under the MIT license. Please see LICENSE
+// or go to https://opensource.org/licenses/MIT for more information.
+
+#include "gtest/gtest.h"
+#include "newton/newton.h"
+using namespace newton;
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(NtThreadPoolTest, NtMPSCQueue)
+{
+    NtMPSCQueue<int> queue;
+    std::vector<std::thread> producers;
+
+    for (int p = 0; p < 4; ++p) {
+        producers.emplace_back([&queue, p]() {
+            for (int i = 0; i < 1000; ++i)
+                queue.push(p * 1000 + i);
+        });
+    }
+
+    for (auto& t : producers)
+        t.join();
+
+    int last[4] = { -1, -1, -1, -1 };
+    int value = 0;
+    int count = 0;
+
+    while (queue.pop(value)) {
+        EXPECT_LT(last[value / 1000], value % 1000);
+        last[value / 1000] = value % 1000;
+        ++count;
+    }
+
+    EXPECT_EQ(4000, count);
+}
+
+TEST(NtThreadPoolTest, NtThreadPoolSubmit)
+{
+    std::atomic<int> count{ 0 };
+
+    {
+        NtThreadPool pool(4);
+        EXPECT_EQ(4, pool.threadCount());
+
+        for (int i = 0; i < 1000; ++i)
+            pool.submit([&count]() { ++count; });
+    }
+
+    EXPECT_EQ(1000, count);
+}
+
+TEST(NtThreadPoolTest, NtThreadPoolNestedSubmit)
+{
+    std::atomic<int> count{ 0 };
+
+    {
+        NtThreadPool pool(4);
+
+        for (int i = 0; i < 10; ++i) {
+            pool.submit([&pool, &count]() {
+                for (int j = 0; j < 100; ++j)
+                    pool.submit([&count]() { ++count; });
+            });
+        }
+    }
+
+    EXPECT_EQ(1000, count);
+}
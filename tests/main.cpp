@@ -12,11 +12,43 @@
  */
 
 #include "gtest/gtest.h"
+#include "newton/newton.h"
+
+#include <cstdio>
 
 using ::testing::InitGoogleTest;
 using ::testing::Test;
 
+/**
+ * \class NtAllocListener
+ * \brief Allocations per test case
+ *
+ * Prints the allocations made by each test case when allocation tracking
+ * is built in.
+ */
+class NtAllocListener : public ::testing::EmptyTestEventListener
+{
+public:
+    void OnTestStart(const ::testing::TestInfo&) override { m_scope.reset(); }
+
+    void OnTestEnd(const ::testing::TestInfo& info) override
+    {
+        newton::NtAllocStats stats = m_scope.stats();
+
+        printf("[  ALLOCS  ] %s.%s: %llu allocations, %llu bytes, peak %llu bytes\n", info.test_suite_name(),
+            info.name(), static_cast<unsigned long long>(stats.count), static_cast<unsigned long long>(stats.bytes),
+            static_cast<unsigned long long>(stats.peak));
+    }
+
+private:
+    newton::NtAllocScope m_scope;
+};
+
 int main(int argc, char** argv) {
     InitGoogleTest(&argc, argv);
+
+    if (newton::NtIsAllocTrackingEnabled())
+        ::testing::UnitTest::GetInstance()->listeners().Append(new NtAllocListener());
+
     return RUN_ALL_TESTS();
 }